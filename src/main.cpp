@@ -23,25 +23,33 @@
 #include "modules/camera.h"
 #include "modules/frameProcessor.h"
 #include "modules/sleepDetect.h"
+#include "modules/sequentialSleepDetect.h"
 #include "modules/actionStateMachine.h"
 #include <mutex>
 #include <condition_variable>
 #include "modules/logging.h"
+#include "modules/threadPlacement.h"
+#include "modules/deadline.h"
+#include "modules/blackBoxRecorder.h"
+#include "modules/telemetry.h"
+#include "modules/frameExport.h"
+#include "modules/metricsServer.h"
+#include "modules/startup.h"
+#include "modules/fatigueAnalytics.h"
+#include <atomic>
+#include <optional>
 
 using namespace std;
 using namespace cv;
 
 // ✅ Queue, mutex, and CV for raw frames
-std::queue<Mat> frame_queue;
+std::queue<TimedFrame> frame_queue;
 std::mutex frame_mutex;
 std::condition_variable frame_cv;
 bool processed = true;
 
-// ✅ Queue, mutex, and CV for eye status
-std::queue<int> status_queue;
-std::mutex status_mutex;
-std::condition_variable status_cv;
-bool loading = false;
+// ✅ Lock-free channel for eye status
+StatusChannel status_channel;
 
 // ✅ Mutex and CV for action state machine
 std::mutex action_mutex;
@@ -50,85 +58,186 @@ std::condition_variable action_cv;
 // ✅ Sleep status (-1 no face, 0 asleep, 1 awake)
 int sleepStatus = NOFACE;
 
-// ✅ Limits
-const int MAX_QUEUE_SIZE = 10;
-
-// 🚀 Callback structure for camera
-struct MyCallback : Camera::SceneCallback {
-    void nextScene(const cv::Mat& frame) override {
-        std::unique_lock<std::mutex> lock(frame_mutex);
-        frame_cv.wait(lock, [] { return processed; });  
-        
-        if (frame_queue.size() > MAX_QUEUE_SIZE) {
-            std::cerr << "⚠️ WARNING: Frame queue is full, dropping oldest frame." << std::endl;
-            frame_queue.pop();  // Drop the oldest frame
+int main() {
+    // ✅ Startup is timed from here; steps that don't depend on each other run concurrently
+    StartupOrchestrator startup;
+
+    std::optional<Logger> MainLogger;
+    startup.run("logging", [&] {
+        MainLogger.emplace();
+        Logger::logMessage(Logger::custom_severity_level::info, "✅ Logging Started");
+        return true;
+    });
+
+    // ✅ Place pipeline threads on their cores before any of them starts.
+    // OpenCV/OpenMP pools are capped to the two detector cores; their workers are spawned lazily by the
+    // detector thread and inherit its affinity, so they don't compete with capture and action.
+    ThreadPlacement::configureDefaults();
+    ThreadPlacement::limitLibraryThreads(2);
+    ThreadPlacement::Scope mainPlacement(ThreadPlacement::MAIN);
+
+    // ✅ Print per-thread CPU time at exit, after all pipeline threads have been joined
+    std::atexit([] { ThreadPlacement::report(std::cout); Deadline::report(std::cout); });
+
+    // ✅ Detection parameters tuned by wake-o-matic-sweep, the built-in defaults if there is no file
+    DetectionParams detectionParams;
+    startup.run("configuration", [&] {
+        if (detectionParams.load("wake-o-matic.conf")) {
+            std::cout << "✅ Detection parameters loaded from wake-o-matic.conf" << std::endl;
         }
+        return true;
+    });
 
-        frame_queue.push(frame);
-        processed = false;
-        lock.unlock();
-        frame_cv.notify_one();
+    // ✅ Create objects (the cascades and audio are set up by their startup phases)
+    Camera camera;
+    FrameQueueCallback cb;
+    BlackBoxRecorder recorder;
+    FrameExporter exporter;
+    TelemetryWriter telemetry;
+    MetricsServer metricsServer;
+    std::optional<FrameProcessor> frameProcessor;
+    // ✅ Blink rate and PERCLOS trends over the shift
+    FatigueAnalytics fatigue;
+    SequentialSleepDetect sleepDetector;
+    std::optional<ActionStateMachine> action;
+    bool telemetryOpen = false;
+
+    // ✅ Concurrent phases, each on the cores of the pipeline thread it prepares for.
+    // Shared-memory export and black-box recorder are registered first, they pass every frame on.
+    // The exporter stamps each frame once; the recorder, the queue and the published results keep that capture time.
+    startup.launch("camera", ThreadPlacement::CAPTURE, [&] {
+        exporter.open(FrameExporter::Config());
+        exporter.chain(&recorder);
+        recorder.open(BlackBoxRecorder::Config());
+        recorder.chain(&cb);
+        camera.registerSceneCallback(&exporter);
+        // Grey frames straight from the driver buffers where V4L2 is there, cv::VideoCapture otherwise
+        camera.startV4l2(std::make_unique<V4l2KernelDevice>("/dev/video0"));
+        if (!camera.isOpened()) {
+            camera.start(0, cv::CAP_ANY);
+        }
+        return camera.isOpened();
+    });
+    startup.launch("classifiers", ThreadPlacement::DETECTOR, [&] {
+        frameProcessor.emplace(detectionParams);
+        return true;
+    });
+    startup.launch("audio", ThreadPlacement::ACTION, [&] {
+        action.emplace();
+        return ActionStateMachine::soundsAvailable();
+    });
+    startup.launch("outputs", ThreadPlacement::METRICS, [&] {
+        telemetryOpen = telemetry.open("telemetry.womt");
+        // Metrics for the fleet agent (Prometheus text format on a Unix socket, low-priority thread)
+        if (metricsServer.start(MetricsServer::Config())) {
+            std::cout << "✅ Metrics served on " << MetricsServer::Config().unixPath << std::endl;
+        }
+        return true;
+    });
+    if (!startup.wait()) {
+        std::cerr << "⚠️ WARNING: Some startup phases failed, see the report below." << std::endl;
     }
-};
-
-int main() {
-    Logger MainLogger;
-    Logger::logMessage(Logger::custom_severity_level::info, "✅ Logging Started");
+    if (!frameProcessor || !action) {
+        startup.report(std::cerr);
+        std::cerr << "❌ ERROR: Cannot protect the driver without the detector and the action state machine!" << std::endl;
+        camera.stop();
+        metricsServer.stop();
+        return 1;
+    }
+    std::cout << (camera.isOpened() ? "✅ Camera started" : "❌ ERROR: Camera not started") << std::endl;
+
+    // ✅ Flag the safety state as degraded (warning sound) when no fresh decision arrives for 1 second.
+    // A stall never downgrades an alarm: the warning only replaces AWAKE or NOFACE
+    std::atomic<bool> degraded{false};
+    std::mutex actionStateMutex;  // The watchdog and the decision loop both change the action state
+    auto actOn = [&](int decided) {
+        std::lock_guard<std::mutex> lock(actionStateMutex);
+        if (degraded) {
+            decided = (SLEEPING == decided || SLEEPING == action->getState()) ? SLEEPING : NOFACE;
+        }
+        action->changeState(decided);
+    };
+    StallWatchdog watchdog(std::chrono::milliseconds(1000), [&](bool isDegraded) {
+        degraded = isDegraded;
+        if (isDegraded) {
+            actOn(NOFACE);
+        }
+    });
 
-    // ✅ Create objects
-    Camera camera;
-    MyCallback cb;
-    FrameProcessor frameProcessor;
-    SleepDetect sleepDetector;
-    ActionStateMachine action;
-
-    // ✅ Register callback and start camera
-    camera.registerSceneCallback(&cb);
-    camera.start(0, cv::CAP_ANY);
-    std::cout << "✅ Camera started" << std::endl;
-
-    // ✅ Start frame processing thread
-    frameProcessor.start();
+    // ✅ Start frame processing thread, logging per-frame telemetry; it runs the detection on a bundled
+    // face first, so the first camera frame doesn't pay for OpenCV's lazy initialisation and cold caches
+    if (telemetryOpen) {
+        frameProcessor->setTelemetry(&telemetry);
+    }
+    frameProcessor->setFrameExport(&exporter);
+    startup.run("warm-up", [&] {
+        cv::Mat warmUpImage;
+        #ifdef WARMUP_IMAGE_PATH
+        warmUpImage = cv::imread(WARMUP_IMAGE_PATH);
+        #endif
+        frameProcessor->start(warmUpImage);
+        return !warmUpImage.empty() && frameProcessor->waitUntilWarm(std::chrono::seconds(10));
+    });
     std::cout << "✅ Frame processing started" << std::endl;
     std::cout << "✅ Action state machine started" << std::endl;
-
-    for (int i = 0; i < 10; i++) {
-        std::unique_lock<std::mutex> lock_buffer(status_mutex);
-
-        if (!status_cv.wait_for(lock_buffer, std::chrono::seconds(5), [] { return !status_queue.empty(); })) {
-            std::cerr << "⚠️ WARNING: Timed out waiting for status_queue updates." << std::endl;
+    watchdog.start();
+
+    std::vector<EyeSample> batch;
+    batch.reserve(status_channel.capacity());
+    int frameCount = 0;
+    while (frameProcessor->isRunning()) {
+        // ✅ Everything the processing thread published since the last pass, in one batch; it never waits for us
+        if (0 == status_channel.waitAndDrain(batch, std::chrono::seconds(5))) {
+            std::cerr << "⚠️ WARNING: Timed out waiting for status_channel updates." << std::endl;
             continue;
         }
 
-        loading = true;
-
-        while (!status_queue.empty()) {
-            sleepDetector.load(status_queue.front());
-            status_queue.pop();
+        for (const EyeSample& sample : batch) {
+            int previousStatus = sleepStatus;
+            sleepStatus = sleepDetector.update(sample);
+            fatigue.update(sample);
+            // Keep the frames leading up to every alarm
+            if (SLEEPING == sleepStatus && SLEEPING != previousStatus) {
+                recorder.freezeAndSnapshot("blackbox_alarm_" + std::to_string(sleepDetector.events().size()) + ".ring");
+            }
+            // Late results still count as evidence, but only fresh ones keep the watchdog happy
+            if (!Deadline::expired(Deadline::DECISION, sample.timestamp)) {
+                watchdog.feed();
+                // The driver is protected from here on
+                if (startup.firstDecisionMs() < 0) {
+                    startup.markFirstDecision();
+                    startup.report(std::cout);
+                }
+            }
+
+            // ✅ Print every 30 frames (counted per sample, however the samples were batched)
+            if (++frameCount % 30 == 0) {
+                std::cout << "🔵 Sleep status: " << sleepStatus << std::endl;
+            }
+            // ✅ Fatigue trends every ~10 s
+            if (frameCount % 300 == 0) {
+                fatigue.report(std::cout);
+            }
         }
 
-        loading = false;
-        lock_buffer.unlock();
-        status_cv.notify_one();
-
-        // ✅ Print every 30 frames
-        static int frameCount = 0;
-        if (++frameCount % 30 == 0) {
-            std::cout << "🔵 Sleep status: " << sleepStatus << std::endl;
-        }
-
-        // ✅ Perform corresponding action
-        action.changeState(sleepStatus);
+        // ✅ Perform corresponding action (no extra sleep here, the decision is acted on as soon as it is made)
+        actOn(sleepStatus);
+    }
 
-        // ✅ Sleep for 1 second
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+    // ✅ Report how quickly each alarm was raised after the eyes closed
+    for (const auto& event : sleepDetector.events()) {
+        std::cout << "⏱️ Microsleep alarm after " << event.latencyMs << " ms (" << event.frames << " frames)" << std::endl;
     }
 
+    fatigue.report(std::cout);
+
     // ✅ Stop camera and frame processor
     std::cout << "🛑 Stopping camera and frame processor..." << std::endl;
-    action.changeState(AWAKE);
+    watchdog.stop();
+    metricsServer.stop();
+    action->changeState(AWAKE);
     camera.stop();
-    frameProcessor.stop();
+    frameProcessor->stop();
     std::this_thread::sleep_for(std::chrono::seconds(1));  // ✅ Ensure cleanup
 
     return 0;
@@ -1,73 +1,207 @@
-#include "actionStateMachine.h"
-
-void ActionStateMachine::doAction(int sleepStatus) {
-	if (SLEEPING == sleepStatus) {
-		std::cout << "Play alarm " << std::endl;
-		outputAlarm();
-	}
-
-	else if (NOFACE == sleepStatus) {
-		std::cout << "Play Warning" << std::endl;
-		outputWarning();
-	}
-	std::this_thread::sleep_for(std::chrono::milliseconds(500));
-	return;
-}
- 
-//changes current state and takes appropriate action
-void ActionStateMachine::changeState(int state) {
-
-	//Returns if there is no change is state.
-	if (state != currentState) {
-		
-		//update current state
-		currentState = state;
-
-		//Starts the thread if no thread is createdand current state requires action(SLEEPING or NOFACE).
-		if (!isOn && AWAKE != currentState) {
-			start();
-			return;
-		}
-
-		//stops thread if thread is active and driver is AWAKE
-		if (isOn && AWAKE == currentState) {
-			stop();
-		}
-	}
-	return;
-}
-
-
-void ActionStateMachine::threadLoop() {
-	while (isOn) {
-		doAction(currentState);
-	}
-}
-
-//starts a separate thread for the action state machine
-void ActionStateMachine::start() {
-	isOn = true;
-	actionThread = std::thread(&ActionStateMachine::threadLoop, this);
-}
-
-//signals the cv wait to stop waiting and joins the thread
-void ActionStateMachine::stop() {
-	isOn = false;
-	actionThread.join();
-}
-
-void ActionStateMachine::outputAlarm(){
-    std::system("amixer set PCM unmute");
-    // std::system("amixer set PCM 100%");
-    if(0 != std::system("aplay ../wav/alarm.wav")){
-        throw std::runtime_error("error");
-    };
-}
-
-void ActionStateMachine::outputWarning(){
-    std::system("amixer set PCM unmute");
-    // std::system("amixer set PCM 100%");
-    if(0 != std::system("aplay ../wav/warning.wav")){
-        throw std::runtime_error("error");
-    };
-}
\ No newline at end of file
+#include "actionStateMachine.h"
+#include "threadPlacement.h"
+#include "metrics.h"
+#include <algorithm>
+#include <fstream>
+
+#ifdef _WIN32
+	#include <windows.h>
+	#include <mmsystem.h>
+	#pragma comment(lib, "winmm.lib")
+#else
+	#include <spawn.h>
+	#include <signal.h>
+	#include <sys/wait.h>
+	#include <cerrno>
+	extern char** environ;
+#endif
+
+//gap between two repetitions of the same sound
+static const std::chrono::milliseconds REPEAT_GAP(500);
+
+//sound files, relative to the build directory
+static const char* ALARM_SOUND = "../wav/alarm.wav";
+static const char* WARNING_SOUND = "../wav/warning.wav";
+
+static Counter& alarms = Metrics::counter("wakeomatic_alarms_total", "Changes into the asleep state (alarm sound)");
+static Counter& warnings = Metrics::counter("wakeomatic_warnings_total", "Changes into the no face state (warning sound)");
+static Gauge& driverState = Metrics::gauge("wakeomatic_driver_state", "Acted on state: -1 no face, 0 asleep, 1 awake");
+static Histogram& actionLatencyMs = Metrics::histogram("wakeomatic_action_latency_ms", "Time from a state change to its sound starting or stopping", Metrics::latencyBucketsMs());
+
+void ActionStateMachine::doAction(int sleepStatus) {
+	if (SLEEPING == sleepStatus) {
+		std::cout << "Play alarm " << std::endl;
+		outputAlarm();
+	}
+
+	else if (NOFACE == sleepStatus) {
+		std::cout << "Play Warning" << std::endl;
+		outputWarning();
+	}
+	return;
+}
+
+//changes current state and wakes the action thread
+void ActionStateMachine::changeState(int state) {
+
+	//Returns if there is no change is state.
+	if (state == currentState) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(action_mutex);
+		currentState = state;
+		pendingChange = true;
+		changeTime = std::chrono::steady_clock::now();
+	}
+	action_cv.notify_all();
+
+	driverState.set(state);
+	if (SLEEPING == state) alarms.inc();
+	else if (NOFACE == state) warnings.inc();
+}
+
+ActionStateMachine::Latency ActionStateMachine::getLatency() {
+	std::lock_guard<std::mutex> lock(action_mutex);
+	return latency;
+}
+
+void ActionStateMachine::recordLatency(std::chrono::steady_clock::time_point requested) {
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - requested).count();
+	actionLatencyMs.observe(ms);
+	std::lock_guard<std::mutex> lock(action_mutex);
+	latency.lastMs = ms;
+	latency.maxMs = std::max(latency.maxMs, ms);
+	latency.meanMs += (ms - latency.meanMs) / (latency.count + 1);
+	latency.count++;
+}
+
+void ActionStateMachine::threadLoop() {
+	ThreadPlacement::Scope placement(ThreadPlacement::ACTION);
+	std::unique_lock<std::mutex> lock(action_mutex);
+	auto woken = [this] { return !isOn || pendingChange; };
+
+	while (isOn) {
+		//sleep until the state changes
+		action_cv.wait(lock, woken);
+		if (!isOn) break;
+
+		pendingChange = false;
+		int state = currentState;
+		auto requested = changeTime;
+		lock.unlock();
+
+		//cancel whatever is playing and start the action of the new state
+		stopSound();
+		doAction(state);
+		recordLatency(requested);
+
+		lock.lock();
+
+		//repeat the sound until the state changes again; the sound's reaper wakes us when it ends
+		while (isOn && !pendingChange && AWAKE != state) {
+			action_cv.wait(lock, [this] { return !isOn || pendingChange || !soundRunning; });
+			if (!isOn || pendingChange) break;
+			if (action_cv.wait_for(lock, REPEAT_GAP, woken)) break;
+
+			lock.unlock();
+			doAction(state);
+			lock.lock();
+		}
+	}
+
+	lock.unlock();
+	stopSound();
+}
+
+//starts a separate thread for the action state machine
+void ActionStateMachine::start() {
+	isOn = true;
+	std::system("amixer set PCM unmute");
+	actionThread = std::thread(&ActionStateMachine::threadLoop, this);
+}
+
+bool ActionStateMachine::soundsAvailable() {
+	bool available = true;
+	for (const char* file : { ALARM_SOUND, WARNING_SOUND }) {
+		if (!std::ifstream(file)) {
+			std::cerr << "ERROR: Could not open " << file << std::endl;
+			available = false;
+		}
+	}
+	return available;
+}
+
+//signals the cv wait to stop waiting and joins the thread
+void ActionStateMachine::stop() {
+	{
+		std::lock_guard<std::mutex> lock(action_mutex);
+		isOn = false;
+	}
+	action_cv.notify_all();
+	if (actionThread.joinable()) {
+		actionThread.join();
+	}
+}
+
+void ActionStateMachine::outputAlarm(){
+	playSound(ALARM_SOUND);
+}
+
+void ActionStateMachine::outputWarning(){
+	playSound(WARNING_SOUND);
+}
+
+//plays the sound without blocking, so that it can be cancelled by stopSound()
+void ActionStateMachine::playSound(const char* file){
+#ifdef _WIN32
+	if (!PlaySoundA(file, NULL, SND_FILENAME | SND_ASYNC | SND_LOOP)) {
+		std::cerr << "ERROR: Could not play " << file << std::endl;
+		return;
+	}
+	std::lock_guard<std::mutex> lock(action_mutex);
+	soundRunning = true;  // PlaySound loops the sound (SND_LOOP) until stopSound() is called
+#else
+	stopSound();  // Reaps the sound that ended before this repetition
+	pid_t pid;
+	char* argv[] = { (char*)"aplay", (char*)"-q", (char*)file, nullptr };
+	if (0 != posix_spawnp(&pid, "aplay", nullptr, nullptr, argv, environ)) {
+		std::cerr << "ERROR: Could not start aplay for " << file << std::endl;
+		return;
+	}
+	soundPid = pid;
+	{
+		std::lock_guard<std::mutex> lock(action_mutex);
+		soundRunning = true;
+	}
+
+	//blocks until aplay exits and wakes the action thread; WNOWAIT leaves the child to stopSound() to reap,
+	//so its pid can't be reused before then
+	soundReaper = std::thread([this, pid] {
+		siginfo_t info;
+		while (0 != waitid(P_PID, (id_t)pid, &info, WEXITED | WNOWAIT) && EINTR == errno) {}
+		{
+			std::lock_guard<std::mutex> lock(action_mutex);
+			soundRunning = false;
+		}
+		action_cv.notify_all();
+	});
+#endif
+}
+
+void ActionStateMachine::stopSound(){
+#ifdef _WIN32
+	PlaySoundA(NULL, NULL, 0);
+	std::lock_guard<std::mutex> lock(action_mutex);
+	soundRunning = false;
+#else
+	if (soundPid < 0) return;
+	kill((pid_t)soundPid, SIGTERM);  // Harmless if it already ended, it stays a zombie until reaped here
+	if (soundReaper.joinable()) {
+		soundReaper.join();
+	}
+	waitpid((pid_t)soundPid, nullptr, 0);
+	soundPid = -1;
+#endif
+}
@@ -1,59 +1,95 @@
-#pragma once
-
-#include <thread>
-#include "sleepDetect.h"  // ✅ Ensure AWAKE, SLEEPING, NOFACE are properly defined
-#include <iostream>
-#include <mutex>
-#include <condition_variable>
-
-// 🚀 Global mutex and condition variable for action state machine
-extern std::mutex action_mutex;
-extern std::condition_variable action_cv;
-
-/** 
- * @brief Class that handles the appropriate action depending on sleep status.
- * 
- * - Plays **warning** when the driver is not detected.
- * - Plays **alarm** when the driver is asleep.
- * 
- * ### USAGE:
- * - Call `changeState(int state)` to update the state.
- * - The class will automatically handle the appropriate actions.
- */
-class ActionStateMachine
-{
-public:
-
-    /** 
-     * @brief Changes the current state of the state machine and performs the appropriate action.
-     * @param state The new state to change to.
-     */
-    void changeState(int state);
-
-    /** 
-     * @brief Get the current state.
-     * @return int The current state.
-     */
-    int getState() {
-        return currentState;
-    }
-
-    /** Constructor */
-    ActionStateMachine() = default;
-
-    /** Destructor (Ensures thread stops when object is destroyed) */
-    ~ActionStateMachine() { stop(); }  
-
-private:
-    void start();
-    void stop();
-    void doAction(int sleepStatus);
-    void outputAlarm();
-    void outputWarning();
-    void threadLoop();
-
-    bool isOn = false;
-    int currentState = AWAKE;  // ✅ Ensure AWAKE is defined in `sleepDetect.h`
-    std::thread actionThread;
-};
-
+#pragma once
+
+#include <thread>
+#include "sleepDetect.h"  // ✅ Ensure AWAKE, SLEEPING, NOFACE are properly defined
+#include <iostream>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+// 🚀 Global mutex and condition variable for action state machine
+extern std::mutex action_mutex;
+extern std::condition_variable action_cv;
+
+/**
+ * @brief Class that handles the appropriate action depending on sleep status.
+ *
+ * - Plays **warning** when the driver is not detected.
+ * - Plays **alarm** when the driver is asleep.
+ *
+ * The action thread is started by the constructor and sleeps on `action_cv` until the state changes,
+ * so there is no polling. Sounds are played by a child process which is killed as soon as the state
+ * returns to AWAKE, instead of waiting for the whole sound file to finish. A reaper thread blocks until the
+ * sound process exits and wakes the action thread to repeat the sound.
+ *
+ * ### USAGE:
+ * - Call `changeState(int state)` to update the state.
+ * - The class will automatically handle the appropriate actions.
+ * - Call `getLatency()` to see how long it took from a state change to the start/cancel of the sound.
+ */
+class ActionStateMachine
+{
+public:
+
+    /// @brief Time from `changeState()` to the corresponding action being taken, in milliseconds.
+    struct Latency {
+        double lastMs = 0.0;
+        double maxMs = 0.0;
+        double meanMs = 0.0;
+        int count = 0;
+    };
+
+    /**
+     * @brief Changes the current state of the state machine and wakes the action thread.
+     * @param state The new state to change to.
+     */
+    void changeState(int state);
+
+    /**
+     * @brief Get the current state.
+     * @return int The current state.
+     */
+    int getState() {
+        return currentState;
+    }
+
+    /**
+     * @brief Get the state change to action latency statistics.
+     * @return Latency Statistics of all actions taken so far.
+     */
+    Latency getLatency();
+
+    /**
+     * @brief Checks that the alarm and warning sounds can be read, so a missing file shows at startup rather than at the first alarm.
+     * @return True if both files are there.
+     */
+    static bool soundsAvailable();
+
+    /** Constructor (Starts the action thread) */
+    ActionStateMachine() { start(); }
+
+    /** Destructor (Ensures thread stops when object is destroyed) */
+    ~ActionStateMachine() { stop(); }
+
+private:
+    void start();
+    void stop();
+    void doAction(int sleepStatus);
+    void outputAlarm();
+    void outputWarning();
+    void playSound(const char* file);
+    void stopSound();
+    void recordLatency(std::chrono::steady_clock::time_point requested);
+    void threadLoop();
+
+    std::atomic<bool> isOn{false};
+    std::atomic<int> currentState{AWAKE};  // ✅ Ensure AWAKE is defined in `sleepDetect.h`
+    bool pendingChange = false;  // Guarded by action_mutex
+    std::chrono::steady_clock::time_point changeTime;  // Guarded by action_mutex
+    Latency latency;  // Guarded by action_mutex
+    long soundPid = -1;  // Only used by the action thread
+    bool soundRunning = false;  // Guarded by action_mutex, cleared by the reaper when the sound ends
+    std::thread soundReaper;  // Waits for the sound process to exit, only started and joined by the action thread
+    std::thread actionThread;
+};
@@ -0,0 +1,249 @@
+#include "blackBoxRecorder.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifndef _WIN32
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+using namespace std::chrono;
+
+static const char RING_MAGIC[8] = { 'W', 'O', 'M', 'B', 'B', 'O', 'X', '\0' };
+static const uint32_t RING_VERSION = 1;
+
+//slots are cache line aligned so that two slots never share a line
+static uint64_t slotBytesFor(int width, int height) {
+	uint64_t bytes = sizeof(BlackBoxRecorder::SlotHeader) + static_cast<uint64_t>(width) * height;
+	return (bytes + 63) & ~uint64_t(63);
+}
+
+//the slots start on the first cache line after the ring header
+static size_t ringHeaderBytes() {
+	return (sizeof(BlackBoxRecorder::RingHeader) + 63) & ~size_t(63);
+}
+
+bool BlackBoxRecorder::open(const Config& config) {
+	close();
+
+	#ifdef _WIN32
+	std::cerr << "⚠️ WARNING: Black-box recorder is not available on this system." << std::endl;
+	return false;
+	#else
+	uint32_t slotCount = static_cast<uint32_t>(std::max(1, config.seconds * config.fps));
+	uint64_t slotBytes = slotBytesFor(config.width, config.height);
+	mappingBytes = ringHeaderBytes() + slotCount * slotBytes;
+
+	fd = ::open(config.path.c_str(), O_RDWR | O_CREAT, 0644);
+	if (fd < 0) {
+		std::cerr << "❌ ERROR: Could not open black-box file " << config.path << std::endl;
+		return false;
+	}
+
+	// Truncating first gives zeroed (empty) slots, allocating up front avoids SIGBUS when the disk is full
+	if (0 != ftruncate(fd, 0) || 0 != posix_fallocate(fd, 0, mappingBytes)) {
+		std::cerr << "❌ ERROR: Could not allocate " << mappingBytes << " bytes for black-box file " << config.path << std::endl;
+		::close(fd);
+		fd = -1;
+		return false;
+	}
+
+	void* addr = mmap(nullptr, mappingBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (MAP_FAILED == addr) {
+		std::cerr << "❌ ERROR: Could not map black-box file " << config.path << std::endl;
+		::close(fd);
+		fd = -1;
+		return false;
+	}
+
+	mapping = static_cast<uint8_t*>(addr);
+	header = reinterpret_cast<RingHeader*>(mapping);
+	std::memcpy(header->magic, RING_MAGIC, sizeof(RING_MAGIC));
+	header->version = RING_VERSION;
+	header->width = config.width;
+	header->height = config.height;
+	header->slotCount = slotCount;
+	header->slotBytes = slotBytes;
+	header->writeCount = 0;
+
+	frozen = false;
+	std::cout << "✅ Black-box recorder: " << config.seconds << " s window in " << config.path << std::endl;
+	return true;
+	#endif
+}
+
+void BlackBoxRecorder::close() {
+	if (snapshotThread.joinable()) {
+		snapshotThread.join();
+	}
+
+	#ifndef _WIN32
+	if (nullptr != mapping) {
+		freeze();
+		munmap(mapping, mappingBytes);
+	}
+	if (fd >= 0) {
+		::close(fd);
+	}
+	#endif
+
+	mapping = nullptr;
+	header = nullptr;
+	fd = -1;
+}
+
+uint8_t* BlackBoxRecorder::slot(uint64_t index) const {
+	return mapping + ringHeaderBytes() + (index % header->slotCount) * header->slotBytes;
+}
+
+void BlackBoxRecorder::nextScene(const cv::Mat& frame) {
+	nextStampedScene(frame, clock->now(), 0);
+}
+
+void BlackBoxRecorder::nextStampedScene(const cv::Mat& frame, steady_clock::time_point captured, uint64_t exportNumber) {
+	record(frame, captured);
+	if (nullptr != nextCallback) {
+		nextCallback->nextStampedScene(frame, captured, exportNumber);
+	}
+}
+
+void BlackBoxRecorder::record(const cv::Mat& frame, steady_clock::time_point captured) {
+	if (nullptr == header || frame.empty()) return;
+
+	// Announce the write before checking the freeze flag, freeze() does the opposite
+	writing = true;
+	if (frozen) {
+		writing = false;
+		return;
+	}
+
+	uint64_t index = header->writeCount;
+	uint8_t* target = slot(index);
+	SlotHeader* slotHeader = reinterpret_cast<SlotHeader*>(target);
+	slotHeader->sequence = 0;  // Slot is invalid while it is being overwritten
+
+	// Convert straight into the mapped slot, OpenCV reuses the memory since size and type match
+	cv::Mat grey(header->height, header->width, CV_8UC1, target + sizeof(SlotHeader));
+	cv::Size size(header->width, header->height);
+
+	if (frame.size() == size) {
+		if (frame.channels() == 1) {
+			frame.copyTo(grey);
+		}
+		else {
+			cv::cvtColor(frame, grey, cv::COLOR_BGR2GRAY);
+		}
+	}
+	else {
+		const cv::Mat* source = &frame;
+		if (frame.channels() != 1) {
+			cv::cvtColor(frame, greyScratch, cv::COLOR_BGR2GRAY);
+			source = &greyScratch;
+		}
+		cv::resize(*source, grey, size, 0, 0, cv::INTER_AREA);
+	}
+
+	slotHeader->timestampNs = duration_cast<nanoseconds>(captured.time_since_epoch()).count();
+	std::atomic_thread_fence(std::memory_order_release);
+	slotHeader->sequence = index + 1;
+	header->writeCount = index + 1;
+
+	writing = false;
+}
+
+void BlackBoxRecorder::freeze() {
+	frozen = true;
+	// At most one frame is in flight, wait for it to land in the ring
+	while (writing) {
+		std::this_thread::yield();
+	}
+}
+
+uint64_t BlackBoxRecorder::framesRecorded() const {
+	return nullptr == header ? 0 : header->writeCount;
+}
+
+void BlackBoxRecorder::freezeAndSnapshot(const std::string& path) {
+	if (nullptr == header || snapshotRunning.exchange(true)) return;
+
+	if (snapshotThread.joinable()) {
+		snapshotThread.join();  // Previous snapshot has finished
+	}
+
+	freeze();
+	snapshotThread = std::thread([this, path] {
+		if (snapshot(path)) {
+			std::cout << "📼 Black-box window saved to " << path << std::endl;
+		}
+		resume();
+		snapshotRunning = false;
+	});
+}
+
+bool BlackBoxRecorder::snapshot(const std::string& path) const {
+	if (nullptr == header) return false;
+
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	if (!out) {
+		std::cerr << "❌ ERROR: Could not write black-box snapshot " << path << std::endl;
+		return false;
+	}
+
+	uint64_t writeCount = header->writeCount;
+	uint64_t count = std::min<uint64_t>(writeCount, header->slotCount);
+	uint64_t first = writeCount - count;
+
+	RingHeader copy = *header;
+	copy.slotCount = static_cast<uint32_t>(count);
+	std::vector<char> padding(ringHeaderBytes() - sizeof(RingHeader), 0);
+	out.write(reinterpret_cast<const char*>(&copy), sizeof(copy));
+	out.write(padding.data(), padding.size());
+
+	for (uint64_t i = first; i < writeCount; i++) {
+		out.write(reinterpret_cast<const char*>(slot(i)), header->slotBytes);
+	}
+	return static_cast<bool>(out);
+}
+
+bool BlackBoxRecorder::readFrames(const std::string& path, std::vector<cv::Mat>& frames, std::vector<int64_t>& timestampsNs) {
+	std::ifstream in(path, std::ios::binary);
+	if (!in) return false;
+
+	RingHeader fileHeader;
+	in.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader));
+	if (!in || 0 != std::memcmp(fileHeader.magic, RING_MAGIC, sizeof(RING_MAGIC)) || RING_VERSION != fileHeader.version) {
+		return false;
+	}
+
+	std::vector<uint8_t> slotData(fileHeader.slotBytes);
+	std::vector<std::pair<uint64_t, cv::Mat>> ordered;
+	std::vector<int64_t> times;
+
+	in.seekg(ringHeaderBytes());
+	for (uint32_t i = 0; i < fileHeader.slotCount; i++) {
+		if (!in.read(reinterpret_cast<char*>(slotData.data()), slotData.size())) break;
+		const SlotHeader* slotHeader = reinterpret_cast<const SlotHeader*>(slotData.data());
+		if (0 == slotHeader->sequence) continue;
+
+		cv::Mat grey(fileHeader.height, fileHeader.width, CV_8UC1, slotData.data() + sizeof(SlotHeader));
+		ordered.emplace_back(slotHeader->sequence, grey.clone());
+		times.push_back(slotHeader->timestampNs);
+	}
+
+	// Ring files are in slot order, put the frames back in capture order
+	std::vector<size_t> order(ordered.size());
+	for (size_t i = 0; i < order.size(); i++) order[i] = i;
+	std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return ordered[a].first < ordered[b].first; });
+
+	frames.clear();
+	timestampsNs.clear();
+	for (size_t i : order) {
+		frames.push_back(ordered[i].second);
+		timestampsNs.push_back(times[i]);
+	}
+	return true;
+}
@@ -0,0 +1,157 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "camera.h"
+
+/**
+ * @brief Black-box recorder keeping the last N seconds of grey frames in a memory-mapped ring file.
+ *
+ * The recorder sits in the camera callback chain: it stores every frame and passes it on to the next callback.
+ * Frames are converted to grey (and downscaled to the configured size) straight into a slot of a fixed-size
+ * ring file mapped into memory, so recording a frame costs no allocation and no system call, only dirtying
+ * the pages of one slot. The kernel writes the pages back to disk in its own time.
+ *
+ * When an alarm is raised, @see freezeAndSnapshot() stops the recording and copies the window, oldest frame
+ * first, into a separate file from a background thread; recording resumes once the copy is done.
+ * Recording never waits on anything: frames arriving while frozen are simply not recorded.
+ *
+ * File layout (ring and snapshot): a @see RingHeader followed by `slotCount` slots of `slotBytes` each,
+ * every slot being a @see SlotHeader followed by `width * height` grey pixels.
+ *
+ * ### USAGE:
+ *      BlackBoxRecorder recorder;
+ *      recorder.open(BlackBoxRecorder::Config());
+ *      recorder.chain(&cb);
+ *      camera.registerSceneCallback(&recorder);
+ *      ...
+ *      recorder.freezeAndSnapshot("blackbox_alarm.ring");
+ *
+ * Only available on POSIX systems, on other systems @see open() returns false and frames are only passed on.
+ */
+class BlackBoxRecorder : public Camera::SceneCallback
+{
+public:
+	/// @brief Size of the recorded window
+	struct Config {
+		/// Path of the ring file
+		std::string path = "blackbox.ring";
+		/// Length of the recorded window in seconds
+		int seconds = 20;
+		/// Expected camera frame rate, used to size the ring
+		int fps = 30;
+		/// Size the frames are stored at (downscaled from the camera resolution)
+		int width = 320;
+		int height = 240;
+	};
+
+	/// @brief Header at the start of the ring and snapshot files
+	struct RingHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t width;
+		uint32_t height;
+		uint32_t slotCount;
+		uint64_t slotBytes;
+		uint64_t writeCount;
+	};
+
+	/// @brief Header of every slot
+	struct SlotHeader {
+		/// Sequence number of the frame, starting at 1, 0 for an empty slot
+		uint64_t sequence;
+		/// Capture time in nanoseconds of the steady clock
+		int64_t timestampNs;
+	};
+
+	BlackBoxRecorder() = default;
+	~BlackBoxRecorder() { close(); }
+	BlackBoxRecorder(const BlackBoxRecorder&) = delete;
+	BlackBoxRecorder& operator=(const BlackBoxRecorder&) = delete;
+
+	/**
+	 * @brief Creates (or reuses) the ring file and maps it into memory.
+	 * @param config Size of the recorded window.
+	 * @return True if the ring file is ready for recording.
+	 */
+	bool open(const Config& config);
+
+	/// @brief Waits for a running snapshot, then unmaps and closes the ring file.
+	void close();
+
+	/// @brief Sets the callback the frames are passed on to.
+	void chain(Camera::SceneCallback* next) { nextCallback = next; }
+
+	/// @brief Sets the clock that timestamps frames arriving through @see nextScene (the steady clock by default).
+	void setClock(Clock* newClock) { clock = newClock; }
+
+	/// @brief Records the frame, then passes it on to the chained callback.
+	void nextScene(const cv::Mat& frame) override;
+
+	/// @brief Records a frame stamped earlier in the chain under its capture time, then passes it on with its stamp.
+	void nextStampedScene(const cv::Mat& frame, std::chrono::steady_clock::time_point captured, uint64_t exportNumber) override;
+
+	/**
+	 * @brief Stores a frame in the next slot of the ring.
+	 * @param frame Camera frame (BGR or grey).
+	 * @param captured Capture time of the frame.
+	 */
+	void record(const cv::Mat& frame, std::chrono::steady_clock::time_point captured);
+
+	/// @brief Stops recording, waiting at most for the frame currently being stored.
+	void freeze();
+
+	/// @brief Resumes recording after @see freeze().
+	void resume() { frozen = false; }
+
+	/// @brief True while recording is stopped.
+	bool isFrozen() const { return frozen; }
+
+	/**
+	 * @brief Freezes the recorder and writes the window to a file from a background thread, then resumes.
+	 * Does nothing if a snapshot is already being written.
+	 * @param path File the window is written to.
+	 */
+	void freezeAndSnapshot(const std::string& path);
+
+	/**
+	 * @brief Writes the recorded window, oldest frame first, to a file. The recorder should be frozen.
+	 * @param path File the window is written to.
+	 * @return True if the file was written.
+	 */
+	bool snapshot(const std::string& path) const;
+
+	/// @brief Number of frames recorded since the ring was created.
+	uint64_t framesRecorded() const;
+
+	/**
+	 * @brief Reads all frames of a ring or snapshot file in chronological order.
+	 * @param path Ring or snapshot file.
+	 * @param frames Grey frames, in chronological order.
+	 * @param timestampsNs Capture times of the frames.
+	 * @return True if the file could be read.
+	 */
+	static bool readFrames(const std::string& path, std::vector<cv::Mat>& frames, std::vector<int64_t>& timestampsNs);
+
+private:
+	uint8_t* slot(uint64_t index) const;
+
+	Camera::SceneCallback* nextCallback = nullptr;
+	Clock* clock = &Clock::steady();
+	int fd = -1;
+	uint8_t* mapping = nullptr;
+	size_t mappingBytes = 0;
+	RingHeader* header = nullptr;
+
+	std::atomic<bool> frozen{false};
+	std::atomic<bool> writing{false};
+	std::atomic<bool> snapshotRunning{false};
+	std::thread snapshotThread;
+
+	// Persistent scratch for the grey conversion before downscaling, allocated on the first frame
+	cv::Mat greyScratch;
+};
@@ -1,80 +1,128 @@
-#include "camera.h"
-#include <opencv2/highgui.hpp>  // ✅ REQUIRED for OpenCV window management
-
-/*!
- * Loops while camera is on to add frames to the pipeline
- */
-void Camera::threadLoop() {
-    while (isOn) {
-        postFrame();
-        std::this_thread::sleep_for(std::chrono::milliseconds(30));  // ✅ Reduce CPU usage
-    }
-}
-
-/*!
- * Gets the next available frame and passes it on to the registered callback.
- */
-void Camera::postFrame() {
-    if (nullptr == sceneCallback) return;
-
-    cv::Mat cap;
-    videoCapture.read(cap);
-
-    if (cap.empty()) {
-        std::cerr << "ERROR: Empty frame grabbed. Retrying in 500ms..." << std::endl;
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));  
-        return;
-    }
-
-    std::cout << "Frame captured successfully." << std::endl;
-
-    // ✅ DO NOT SHOW CAMERA FEED HERE (Handled in FrameProcessor)
-    // cv::imshow("Camera Feed", cap);  // ❌ REMOVE THIS LINE
-
-    sceneCallback->nextScene(cap);
-}
-
-/*!
- * Starts the worker thread recording
- */
-void Camera::start(int deviceID, int apiID) {
-    if (isOn) return;  // Prevent multiple starts
-    isOn = true;
-
-    std::cout << "Attempting to open camera " << deviceID << " with API " << apiID << std::endl;
-
-    videoCapture.open(deviceID, apiID);
-    if (!videoCapture.isOpened()) {
-        std::cerr << "ERROR: Could not open camera with API " << apiID << "!" << std::endl;
-
-        std::cerr << "Trying CAP_ANY..." << std::endl;
-        videoCapture.open(deviceID, cv::CAP_ANY);
-        if (!videoCapture.isOpened()) {
-            std::cerr << "ERROR: Camera could not be opened with default settings!" << std::endl;
-            isOn = false;  // Prevent loop execution if the camera fails
-            return;
-        }
-    }
-
-    // Set camera properties (optional)
-    videoCapture.set(cv::CAP_PROP_FRAME_WIDTH, 640);
-    videoCapture.set(cv::CAP_PROP_FRAME_HEIGHT, 480);
-    videoCapture.set(cv::CAP_PROP_FPS, 30);
-
-    std::cout << "Camera successfully opened with deviceID " << deviceID << std::endl;
-    cameraThread = std::thread(&Camera::threadLoop, this);
-}
-
-/*!
- * Frees thread resources and stops recording, must be called prior to program exit.
- */
-void Camera::stop() {
-    isOn = false;
-    if (cameraThread.joinable()) {
-        cameraThread.join();
-    }
-
-    // ✅ Ensure the camera is released properly
-    videoCapture.release();
-    cv::destroyAllWindows();  // ✅ Close all OpenCV windows when stopping
-}
+#include "camera.h"
+#include "threadPlacement.h"
+#include "metrics.h"
+#include <opencv2/highgui.hpp>  // ✅ REQUIRED for OpenCV window management
+
+static Counter& framesCaptured = Metrics::counter("wakeomatic_camera_frames_total", "Frames read from the camera");
+static Counter& readFailures = Metrics::counter("wakeomatic_camera_read_failures_total", "Empty frames returned by the camera");
+static Gauge& captureFps = Metrics::gauge("wakeomatic_camera_fps", "Frames read from the camera per second, over the last second");
+
+/*!
+ * Loops while camera is on to add frames to the pipeline
+ */
+void Camera::threadLoop() {
+    ThreadPlacement::Scope placement(ThreadPlacement::CAPTURE);
+    while (isOn) {
+        postFrame();
+        if (!v4l2Capture) {
+            clock->sleepFor(std::chrono::milliseconds(30));  // ✅ Reduce CPU usage (a V4L2 read waits for the next frame)
+        }
+    }
+}
+
+/*!
+ * Gets the next available frame and passes it on to the registered callback.
+ */
+void Camera::postFrame() {
+    if (nullptr == sceneCallback) return;
+
+    cv::Mat cap;
+    if (v4l2Capture) {
+        v4l2Capture->read(cap);
+    }
+    else {
+        videoCapture.read(cap);
+    }
+
+    if (cap.empty()) {
+        readFailures.inc();
+        std::cerr << "ERROR: Empty frame grabbed. Retrying in 500ms..." << std::endl;
+        clock->sleepFor(std::chrono::milliseconds(500));  
+        return;
+    }
+
+    std::cout << "Frame captured successfully." << std::endl;
+
+    // ✅ Frame rate over one-second windows
+    framesCaptured.inc();
+    auto now = clock->now();
+    fpsWindowFrames++;
+    if (now - fpsWindowStart >= std::chrono::seconds(1)) {
+        captureFps.set(fpsWindowFrames / std::chrono::duration<double>(now - fpsWindowStart).count());
+        fpsWindowStart = now;
+        fpsWindowFrames = 0;
+    }
+
+    // ✅ DO NOT SHOW CAMERA FEED HERE (Handled in FrameProcessor)
+    // cv::imshow("Camera Feed", cap);  // ❌ REMOVE THIS LINE
+
+    sceneCallback->nextScene(cap);
+}
+
+/*!
+ * Starts the worker thread recording
+ */
+void Camera::start(int deviceID, int apiID) {
+    if (isOn) return;  // Prevent multiple starts
+    isOn = true;
+
+    std::cout << "Attempting to open camera " << deviceID << " with API " << apiID << std::endl;
+
+    videoCapture.open(deviceID, apiID);
+    if (!videoCapture.isOpened()) {
+        std::cerr << "ERROR: Could not open camera with API " << apiID << "!" << std::endl;
+
+        std::cerr << "Trying CAP_ANY..." << std::endl;
+        videoCapture.open(deviceID, cv::CAP_ANY);
+        if (!videoCapture.isOpened()) {
+            std::cerr << "ERROR: Camera could not be opened with default settings!" << std::endl;
+            isOn = false;  // Prevent loop execution if the camera fails
+            return;
+        }
+    }
+
+    // Set camera properties (optional)
+    videoCapture.set(cv::CAP_PROP_FRAME_WIDTH, 640);
+    videoCapture.set(cv::CAP_PROP_FRAME_HEIGHT, 480);
+    videoCapture.set(cv::CAP_PROP_FPS, 30);
+
+    std::cout << "Camera successfully opened with deviceID " << deviceID << std::endl;
+    fpsWindowStart = clock->now();
+    fpsWindowFrames = 0;
+    cameraThread = std::thread(&Camera::threadLoop, this);
+}
+
+/*!
+ * Starts the worker thread recording from a V4L2 device
+ */
+void Camera::startV4l2(std::unique_ptr<V4l2Device> device) {
+    if (isOn) return;  // Prevent multiple starts
+
+    auto capture = std::make_unique<V4l2Capture>(std::move(device));
+    // Frames waiting in frame_queue (FrameQueueCallback::MAX_QUEUE_SIZE) and the one in detection hold buffers, plus two
+    if (!capture->open(640, 480, 30, 6)) {
+        std::cerr << "ERROR: V4L2 capture could not be started!" << std::endl;
+        return;
+    }
+    v4l2Capture = std::move(capture);
+    isOn = true;
+
+    fpsWindowStart = clock->now();
+    fpsWindowFrames = 0;
+    cameraThread = std::thread(&Camera::threadLoop, this);
+}
+
+/*!
+ * Frees thread resources and stops recording, must be called prior to program exit.
+ */
+void Camera::stop() {
+    isOn = false;
+    if (cameraThread.joinable()) {
+        cameraThread.join();
+    }
+
+    // ✅ Ensure the camera is released properly (frames still in the pipeline keep their V4L2 buffers)
+    videoCapture.release();
+    v4l2Capture.reset();
+    cv::destroyAllWindows();  // ✅ Close all OpenCV windows when stopping
+}
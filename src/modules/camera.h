@@ -1,60 +1,105 @@
-#pragma once
-#include <opencv2/core.hpp>
-#include <opencv2/videoio.hpp>
-
-#include <iostream>
-#include <stdlib.h>
-#include <thread>
-
-/*!
- * Camera class with callback
- * GNU GPL v3.0
- * (C) 2022
- * [Ross Gardiner](https://github.com/rossGardiner)
- * [Adam Frew](https://github.com/Saweenbarra)
- * [Alban Joseph](https://github.com/albanjoseph)
- * [Lewis Russell](https://github.com/charger4241)
- * Bernd Porr
- */
-class Camera {
-public:
-	/**
-	 * Callback which needs to be implemented by the client
-	 **/
-	struct SceneCallback {
-		virtual void nextScene(const cv::Mat& mat) = 0;
-	};
-
-	/**
-	 * Default constructor
-	 **/
-	Camera() = default;
-
-
-	/**
-	 * Starts the acquisition from the camera
-	 * and then the callback is called at the framerate.
-	 **/
-	void start(int deviceID = 0, int apiID = 0);
-
-	/**
-	 * Stops the data aqusisition
-	 **/
-	void stop();
-
-	/**
-	 * Registers the callback which receives the
-	 * frames.
-	 **/
-	void registerSceneCallback(SceneCallback* sc) {
-		sceneCallback = sc;
-	}
-
-private:
-	void postFrame();
-	void threadLoop();
-	cv::VideoCapture videoCapture;
-	std::thread cameraThread;
-	bool isOn = false;
-	SceneCallback* sceneCallback = nullptr;
-};
+#pragma once
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <stdlib.h>
+#include <thread>
+#include "clock.h"
+#include "v4l2Capture.h"
+
+/*!
+ * Camera class with callback
+ * GNU GPL v3.0
+ * (C) 2022
+ * [Ross Gardiner](https://github.com/rossGardiner)
+ * [Adam Frew](https://github.com/Saweenbarra)
+ * [Alban Joseph](https://github.com/albanjoseph)
+ * [Lewis Russell](https://github.com/charger4241)
+ * Bernd Porr
+ */
+class Camera {
+public:
+	/**
+	 * Callback which needs to be implemented by the client
+	 **/
+	struct SceneCallback {
+		virtual void nextScene(const cv::Mat& mat) = 0;
+
+		/**
+		 * Frame passed on by an earlier callback of a chain, which already stamped it
+		 * with its capture time and its frame export number (0 if it was not exported).
+		 * Callbacks that don't care about the stamp get it through nextScene().
+		 **/
+		virtual void nextStampedScene(const cv::Mat& mat, std::chrono::steady_clock::time_point captured, uint64_t exportNumber) {
+			(void)captured;
+			(void)exportNumber;
+			nextScene(mat);
+		}
+	};
+
+	/**
+	 * Default constructor
+	 **/
+	Camera() = default;
+
+
+	/**
+	 * Starts the acquisition from the camera
+	 * and then the callback is called at the framerate.
+	 **/
+	void start(int deviceID = 0, int apiID = 0);
+
+	/**
+	 * Starts the acquisition from a V4L2 device instead
+	 * of cv::VideoCapture: grey frames straight from the
+	 * mmap'd driver buffers, paced by the device
+	 * (see V4l2Capture). Not started if the device
+	 * can't be opened.
+	 **/
+	void startV4l2(std::unique_ptr<V4l2Device> device);
+
+	/**
+	 * True once the camera was opened by start()
+	 * and until stop() is called.
+	 **/
+	bool isOpened() const {
+		return isOn;
+	}
+
+	/**
+	 * Stops the data aqusisition
+	 **/
+	void stop();
+
+	/**
+	 * Registers the callback which receives the
+	 * frames.
+	 **/
+	void registerSceneCallback(SceneCallback* sc) {
+		sceneCallback = sc;
+	}
+
+	/**
+	 * Sets the clock that paces the acquisition loop
+	 * (the steady clock by default, a simulated clock runs it flat out).
+	 **/
+	void setClock(Clock* newClock) {
+		clock = newClock;
+	}
+
+private:
+	void postFrame();
+	void threadLoop();
+	cv::VideoCapture videoCapture;
+	std::unique_ptr<V4l2Capture> v4l2Capture;
+	std::thread cameraThread;
+	bool isOn = false;
+	SceneCallback* sceneCallback = nullptr;
+	Clock* clock = &Clock::steady();
+	std::chrono::steady_clock::time_point fpsWindowStart;
+	int fpsWindowFrames = 0;
+};
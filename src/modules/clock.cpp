@@ -0,0 +1,6 @@
+#include "clock.h"
+
+Clock& Clock::steady() {
+	static SteadyClock clock;
+	return clock;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <thread>
+
+/**
+ * @brief Source of time for everything that reads the time or paces itself.
+ *
+ * Modules take a `Clock*` instead of calling `steady_clock::now()` / `sleep_for` directly, so that a replay
+ * can substitute a @see SimulatedClock and push recorded frames through as fast as the CPU allows while the
+ * time-based decisions (microsleep gate, sample timestamps) come out exactly as in a real-time run.
+ *
+ * Time points are `steady_clock::time_point`s in both cases, so the rest of the pipeline doesn't change.
+ *
+ * ### USAGE:
+ *      processor.setClock(&Clock::steady());   // live (the default)
+ *
+ *      SimulatedClock clock;
+ *      processor.setClock(&clock);
+ *      clock.set(frameTime);                   // before each recorded frame
+ */
+class Clock
+{
+public:
+	using time_point = std::chrono::steady_clock::time_point;
+	using duration = std::chrono::steady_clock::duration;
+
+	virtual ~Clock() = default;
+
+	/// @brief Current time.
+	virtual time_point now() const = 0;
+
+	/// @brief Waits for (real clock) or skips (simulated clock) the given time.
+	virtual void sleepFor(duration d) = 0;
+
+	/// @brief The real steady clock, shared by all modules that are not given another clock.
+	static Clock& steady();
+};
+
+/// @brief Wall-clock time from `std::chrono::steady_clock`
+class SteadyClock : public Clock
+{
+public:
+	time_point now() const override { return std::chrono::steady_clock::now(); }
+	void sleepFor(duration d) override { std::this_thread::sleep_for(d); }
+};
+
+/**
+ * @brief Clock that only moves when told to.
+ *
+ * `sleepFor` returns immediately and advances the clock instead, so paced loops run at full speed.
+ * Safe to read from several threads while one thread drives it.
+ */
+class SimulatedClock : public Clock
+{
+public:
+	/// @param start Initial time (the steady clock epoch by default, so replayed timestamps start at 0)
+	explicit SimulatedClock(time_point start = time_point()) : nowNs(toNs(start)) {}
+
+	time_point now() const override { return time_point(std::chrono::duration_cast<duration>(std::chrono::nanoseconds(nowNs.load()))); }
+	void sleepFor(duration d) override { advance(d); }
+
+	/// @brief Moves the clock to the given time (e.g. the timestamp of the next recorded frame).
+	void set(time_point t) { nowNs = toNs(t); }
+
+	/// @brief Moves the clock forward.
+	void advance(duration d) { nowNs += std::chrono::duration_cast<std::chrono::nanoseconds>(d).count(); }
+
+private:
+	static int64_t toNs(time_point t) { return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count(); }
+
+	std::atomic<int64_t> nowNs;
+};
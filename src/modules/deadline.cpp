@@ -0,0 +1,106 @@
+#include "deadline.h"
+
+using namespace std::chrono;
+
+// Default budgets for a 30 fps camera: a frame should leave the queue within ~3 frame periods,
+// start detection within ~6 and contribute to the decision within half a second.
+std::atomic<int64_t> Deadline::budgetsMs[Deadline::STAGE_COUNT] = { {100}, {200}, {500} };
+std::atomic<uint64_t> Deadline::missCounts[Deadline::STAGE_COUNT] = {};
+std::atomic<uint64_t> Deadline::checkCounts[Deadline::STAGE_COUNT] = {};
+
+void Deadline::setBudget(Stage stage, milliseconds budget) {
+	budgetsMs[stage] = budget.count();
+}
+
+milliseconds Deadline::budget(Stage stage) {
+	return milliseconds(budgetsMs[stage].load());
+}
+
+bool Deadline::expired(Stage stage, steady_clock::time_point captured, steady_clock::time_point now) {
+	checkCounts[stage].fetch_add(1, std::memory_order_relaxed);
+	if (now - captured <= budget(stage)) {
+		return false;
+	}
+	missCounts[stage].fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+uint64_t Deadline::misses(Stage stage) {
+	return missCounts[stage].load(std::memory_order_relaxed);
+}
+
+uint64_t Deadline::checked(Stage stage) {
+	return checkCounts[stage].load(std::memory_order_relaxed);
+}
+
+void Deadline::resetCounters() {
+	for (int i = 0; i < STAGE_COUNT; i++) {
+		missCounts[i] = 0;
+		checkCounts[i] = 0;
+	}
+}
+
+const char* Deadline::stageName(Stage stage) {
+	switch (stage) {
+		case QUEUE: return "queue";
+		case DETECT: return "detect";
+		case DECISION: return "decision";
+		default: return "unknown";
+	}
+}
+
+void Deadline::report(std::ostream& out) {
+	for (int i = 0; i < STAGE_COUNT; i++) {
+		Stage stage = static_cast<Stage>(i);
+		out << "⏰ " << stageName(stage) << " deadline (" << budget(stage).count() << " ms) missed "
+			<< misses(stage) << " of " << checked(stage) << " frames" << std::endl;
+	}
+}
+
+StallWatchdog::StallWatchdog(milliseconds b, std::function<void(bool)> callback)
+	: bound(b), onChange(std::move(callback)) {
+}
+
+void StallWatchdog::start() {
+	std::lock_guard<std::mutex> lock(watchdogMutex);
+	if (isOn) return;  // Prevent multiple starts
+	isOn = true;
+	feed();  // The bound starts counting now
+	watchdogThread = std::thread(&StallWatchdog::threadLoop, this);
+}
+
+void StallWatchdog::stop() {
+	{
+		std::lock_guard<std::mutex> lock(watchdogMutex);
+		isOn = false;
+	}
+	watchdogCv.notify_all();
+	if (watchdogThread.joinable()) {
+		watchdogThread.join();
+	}
+}
+
+void StallWatchdog::feed() {
+	lastFeedNs = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void StallWatchdog::threadLoop() {
+	std::unique_lock<std::mutex> lock(watchdogMutex);
+	while (isOn) {
+		// Check a few times per bound so a stall is flagged at most a quarter bound late
+		watchdogCv.wait_for(lock, bound / 4, [this] { return !isOn; });
+		if (!isOn) break;
+
+		auto sinceFeed = steady_clock::now().time_since_epoch() - nanoseconds(lastFeedNs.load());
+		bool stalled = sinceFeed > bound;
+		if (stalled == degraded) continue;
+
+		degraded = stalled;
+		if (stalled) stalls++;
+
+		lock.unlock();
+		std::cerr << (stalled ? "⚠️ WARNING: No fresh sleep decision, safety state degraded!" : "✅ Fresh sleep decisions again, safety state restored.") << std::endl;
+		if (onChange) onChange(stalled);
+		lock.lock();
+	}
+}
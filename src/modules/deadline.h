@@ -0,0 +1,120 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+/**
+ * @brief Per-frame deadlines, measured from the capture time of the frame.
+ *
+ * Every pipeline stage has a budget: a frame (or the result computed from it) that reaches the stage later
+ * than its budget after capture can no longer contribute to a timely decision. Stages call @see expired()
+ * to decide whether to drop or downgrade the work, and every miss is counted per stage.
+ *
+ * ### USAGE:
+ *      if (Deadline::expired(Deadline::DETECT, frame.captured)) {
+ *          continue;  // drop the frame
+ *      }
+ *      ...
+ *      Deadline::report(std::cout);
+ */
+class Deadline
+{
+public:
+	/// @brief Pipeline stage a deadline is checked at
+	enum Stage {
+		QUEUE,      ///< Frame taken out of `frame_queue`
+		DETECT,     ///< Face/eye detection about to start
+		DECISION,   ///< Eye state result handed to the sleep decision
+		STAGE_COUNT
+	};
+
+	/// @brief Sets the budget of a stage, measured from capture.
+	static void setBudget(Stage stage, std::chrono::milliseconds budget);
+
+	/// @brief Returns the budget of a stage.
+	static std::chrono::milliseconds budget(Stage stage);
+
+	/**
+	 * @brief Checks a frame against the budget of a stage and counts a miss if it is too old.
+	 * @param stage Stage doing the check.
+	 * @param captured Capture time of the frame.
+	 * @param now Current time.
+	 * @return True if the deadline has passed.
+	 */
+	static bool expired(Stage stage, std::chrono::steady_clock::time_point captured,
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+	/// @brief Number of deadline misses of a stage.
+	static uint64_t misses(Stage stage);
+
+	/// @brief Number of frames checked at a stage.
+	static uint64_t checked(Stage stage);
+
+	/// @brief Resets all counters.
+	static void resetCounters();
+
+	/// @brief Returns the name of a stage
+	static const char* stageName(Stage stage);
+
+	/// @brief Prints the deadline misses of every stage.
+	static void report(std::ostream& out);
+
+private:
+	static std::atomic<int64_t> budgetsMs[STAGE_COUNT];
+	static std::atomic<uint64_t> missCounts[STAGE_COUNT];
+	static std::atomic<uint64_t> checkCounts[STAGE_COUNT];
+};
+
+/**
+ * @brief Watchdog that flags the safety state as degraded when no fresh decision is produced in time.
+ *
+ * The decision loop calls @see feed() for every decision made from a frame that met its deadline.
+ * If no feed arrives within the bound, the watchdog thread calls the callback with `true`; once decisions
+ * are fresh again it calls it with `false`.
+ */
+class StallWatchdog
+{
+public:
+	/**
+	 * @param bound Longest acceptable time without a fresh decision.
+	 * @param onChange Called from the watchdog thread whenever the degraded state changes.
+	 */
+	StallWatchdog(std::chrono::milliseconds bound, std::function<void(bool degraded)> onChange);
+
+	/** Destructor (Ensures thread stops when object is destroyed) */
+	~StallWatchdog() { stop(); }
+
+	/// Starts the watchdog thread
+	void start();
+
+	/// Stops the watchdog thread
+	void stop();
+
+	/// Signals that a fresh decision was produced
+	void feed();
+
+	/// True while no fresh decision was produced within the bound
+	bool isDegraded() const { return degraded; }
+
+	/// Number of times the watchdog has flagged a stall
+	uint64_t stallCount() const { return stalls; }
+
+private:
+	void threadLoop();
+
+	std::chrono::milliseconds bound;
+	std::function<void(bool)> onChange;
+	std::atomic<int64_t> lastFeedNs{0};
+	std::atomic<bool> degraded{false};
+	std::atomic<uint64_t> stalls{0};
+
+	bool isOn = false;  // Guarded by watchdogMutex
+	std::mutex watchdogMutex;
+	std::condition_variable watchdogCv;
+	std::thread watchdogThread;
+};
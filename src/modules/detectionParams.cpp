@@ -0,0 +1,122 @@
+#include "detectionParams.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+std::string trim(const std::string& text) {
+	size_t first = text.find_first_not_of(" \t\r");
+	if (std::string::npos == first) return "";
+	size_t last = text.find_last_not_of(" \t\r");
+	return text.substr(first, last - first + 1);
+}
+
+}
+
+const std::vector<std::string>& DetectionParams::keys() {
+	static const std::vector<std::string> names = {
+		"face.scaleFactor", "face.minNeighbors", "face.minSize",
+		"eyes.scaleFactor", "eyes.minNeighbors", "eyes.minSize",
+		"blob.minThreshold", "blob.maxThreshold", "blob.minArea",
+		"blob.minCircularity", "blob.minConvexity", "blob.minInertiaRatio",
+		"eyeNet.enabled", "eyeNet.threshold",
+		"eyeCache.threshold", "eyeCache.refresh",
+		"lowLight.enabled", "lowLight.maxBrightness", "lowLight.minContrast", "lowLight.clipLimit", "lowLight.tiles"
+	};
+	return names;
+}
+
+bool DetectionParams::set(const std::string& key, double value) {
+	if (key == "face.scaleFactor") face.scaleFactor = value;
+	else if (key == "face.minNeighbors") face.minNeighbors = static_cast<int>(value);
+	else if (key == "face.minSize") face.minSize = static_cast<int>(value);
+	else if (key == "eyes.scaleFactor") eyes.scaleFactor = value;
+	else if (key == "eyes.minNeighbors") eyes.minNeighbors = static_cast<int>(value);
+	else if (key == "eyes.minSize") eyes.minSize = static_cast<int>(value);
+	else if (key == "blob.minThreshold") blob.minThreshold = static_cast<float>(value);
+	else if (key == "blob.maxThreshold") blob.maxThreshold = static_cast<float>(value);
+	else if (key == "blob.minArea") blob.minArea = static_cast<float>(value);
+	else if (key == "blob.minCircularity") blob.minCircularity = static_cast<float>(value);
+	else if (key == "blob.minConvexity") blob.minConvexity = static_cast<float>(value);
+	else if (key == "blob.minInertiaRatio") blob.minInertiaRatio = static_cast<float>(value);
+	else if (key == "eyeNet.enabled") useEyeNet = value != 0;
+	else if (key == "eyeNet.threshold") eyeNetThreshold = static_cast<float>(value);
+	else if (key == "eyeCache.threshold") eyeCacheThreshold = static_cast<float>(value);
+	else if (key == "eyeCache.refresh") eyeCacheRefresh = static_cast<int>(value);
+	else if (key == "lowLight.enabled") lowLight.enabled = value != 0;
+	else if (key == "lowLight.maxBrightness") lowLight.maxBrightness = static_cast<float>(value);
+	else if (key == "lowLight.minContrast") lowLight.minContrast = static_cast<float>(value);
+	else if (key == "lowLight.clipLimit") lowLight.clipLimit = static_cast<float>(value);
+	else if (key == "lowLight.tiles") lowLight.tiles = static_cast<int>(value);
+	else return false;
+	return true;
+}
+
+double DetectionParams::get(const std::string& key) const {
+	if (key == "face.scaleFactor") return face.scaleFactor;
+	if (key == "face.minNeighbors") return face.minNeighbors;
+	if (key == "face.minSize") return face.minSize;
+	if (key == "eyes.scaleFactor") return eyes.scaleFactor;
+	if (key == "eyes.minNeighbors") return eyes.minNeighbors;
+	if (key == "eyes.minSize") return eyes.minSize;
+	if (key == "blob.minThreshold") return blob.minThreshold;
+	if (key == "blob.maxThreshold") return blob.maxThreshold;
+	if (key == "blob.minArea") return blob.minArea;
+	if (key == "blob.minCircularity") return blob.minCircularity;
+	if (key == "blob.minConvexity") return blob.minConvexity;
+	if (key == "blob.minInertiaRatio") return blob.minInertiaRatio;
+	if (key == "eyeNet.enabled") return useEyeNet ? 1.0 : 0.0;
+	if (key == "eyeNet.threshold") return eyeNetThreshold;
+	if (key == "eyeCache.threshold") return eyeCacheThreshold;
+	if (key == "eyeCache.refresh") return eyeCacheRefresh;
+	if (key == "lowLight.enabled") return lowLight.enabled ? 1.0 : 0.0;
+	if (key == "lowLight.maxBrightness") return lowLight.maxBrightness;
+	if (key == "lowLight.minContrast") return lowLight.minContrast;
+	if (key == "lowLight.clipLimit") return lowLight.clipLimit;
+	if (key == "lowLight.tiles") return lowLight.tiles;
+	return 0.0;
+}
+
+bool DetectionParams::load(const std::string& path) {
+	std::ifstream in(path);
+	if (!in) {
+		return false;
+	}
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(in, line)) {
+		lineNumber++;
+		line = trim(line.substr(0, line.find('#')));
+		if (line.empty()) continue;
+
+		size_t equals = line.find('=');
+		std::istringstream valueText(std::string::npos == equals ? "" : line.substr(equals + 1));
+		double value;
+		if (std::string::npos == equals || !(valueText >> value)) {
+			std::cerr << "⚠️ WARNING: " << path << ":" << lineNumber << ": expected key = value" << std::endl;
+			continue;
+		}
+		std::string key = trim(line.substr(0, equals));
+		if (!set(key, value)) {
+			std::cerr << "⚠️ WARNING: " << path << ":" << lineNumber << ": unknown parameter " << key << std::endl;
+		}
+	}
+	return true;
+}
+
+bool DetectionParams::save(const std::string& path, const std::string& comment) const {
+	std::ofstream out(path);
+	if (!out) {
+		std::cerr << "❌ ERROR: Could not write " << path << std::endl;
+		return false;
+	}
+	if (!comment.empty()) {
+		out << "# " << comment << '\n';
+	}
+	for (const std::string& key : keys()) {
+		out << key << " = " << get(key) << '\n';
+	}
+	return static_cast<bool>(out);
+}
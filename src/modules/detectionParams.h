@@ -0,0 +1,91 @@
+#pragma once
+#include <string>
+#include <vector>
+
+/// @brief Parameters of one `detectMultiScale` call
+struct CascadeParams {
+	double scaleFactor = 1.1;
+	int minNeighbors = 2;
+	/// Smallest object in pixels (square)
+	int minSize = 100;
+};
+
+/// @brief Parameters of the iris blob detector (@see EyeStatus), same meaning as in `cv::SimpleBlobDetector::Params`
+struct BlobParams {
+	float minThreshold = 10;
+	float maxThreshold = 200;
+	float minArea = 150;
+	float minCircularity = 0.1f;
+	float minConvexity = 0.87f;
+	float minInertiaRatio = 0.01f;
+};
+
+/// @brief Parameters of the low-light stage in front of the cascades (@see LowLightEnhancer)
+struct LowLightParams {
+	/// Enhance dark or flat frames at all
+	bool enabled = true;
+	/// Mean grey level below which a frame counts as dark
+	float maxBrightness = 60.0f;
+	/// Standard deviation of the grey levels below which a frame counts as flat
+	float minContrast = 20.0f;
+	/// Histogram bins are clipped at this multiple of the average bin (the CLAHE clip limit)
+	float clipLimit = 3.0f;
+	/// Tiles per side of the frame for the histograms
+	int tiles = 8;
+};
+
+/**
+ * @brief Tunable parameters of the detection path: low-light stage, face and eye cascades and the iris blob detector.
+ *
+ * The defaults are the values the detector has always used. A configuration chosen by the parameter
+ * sweeper (`wake-o-matic-sweep`) is stored as a text file with one `key = value` per line and loaded at
+ * startup; keys that are missing keep their default.
+ *
+ * ### USAGE:
+ *      DetectionParams params;
+ *      params.load("wake-o-matic.conf");
+ *      FrameProcessor frameProcessor(params);
+ *
+ * Keys: face.scaleFactor, face.minNeighbors, face.minSize, eyes.scaleFactor, eyes.minNeighbors, eyes.minSize,
+ * blob.minThreshold, blob.maxThreshold, blob.minArea, blob.minCircularity, blob.minConvexity, blob.minInertiaRatio,
+ * eyeNet.enabled, eyeNet.threshold, eyeCache.threshold, eyeCache.refresh,
+ * lowLight.enabled, lowLight.maxBrightness, lowLight.minContrast, lowLight.clipLimit, lowLight.tiles
+ */
+struct DetectionParams {
+	CascadeParams face{ 1.1, 2, 100 };
+	CascadeParams eyes{ 1.1, 4, 30 };
+	BlobParams blob;
+	/// Classify the eyes with the int8 net (@see EyeNet) instead of the blob detector.
+	/// ⚠️ The built-in weights are a placeholder until weights trained on real eye crops are generated
+	/// (makeEyeNetWeights.py --weights): they are only fitted on synthetic crops and call the closed eye of
+	/// test/images/eyeClosed.jpg open. Leave this off in the car until then.
+	bool useEyeNet = false;
+	/// Net confidence from which an eye counts as open
+	float eyeNetThreshold = 0.5f;
+	/// Mean grey difference per pixel up to which an eye crop counts as unchanged and its last result is reused (0 disables, @see EyeCache)
+	float eyeCacheThreshold = 4.0f;
+	/// Frames in a row an unchanged eye may reuse its result
+	int eyeCacheRefresh = 5;
+	LowLightParams lowLight;
+
+	/// @brief All keys, in file order.
+	static const std::vector<std::string>& keys();
+
+	/**
+	 * @brief Sets one parameter by key.
+	 * @return False if the key is unknown.
+	 */
+	bool set(const std::string& key, double value);
+
+	/// @brief Returns one parameter by key (0 for an unknown key).
+	double get(const std::string& key) const;
+
+	/**
+	 * @brief Reads a configuration file; `#` starts a comment.
+	 * @return False if the file could not be opened. Unknown keys and bad lines are skipped with a warning.
+	 */
+	bool load(const std::string& path);
+
+	/// @brief Writes every parameter to a configuration file.
+	bool save(const std::string& path, const std::string& comment = "") const;
+};
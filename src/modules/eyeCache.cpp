@@ -0,0 +1,131 @@
+#include "eyeCache.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define EYECACHE_NEON
+#elif defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+	#define EYECACHE_SSE2
+#endif
+
+static const size_t NO_SLOT = std::numeric_limits<size_t>::max();
+
+uint32_t EyeCacheKernel::sadScalar(const uint8_t* a, const uint8_t* b, int n) {
+	uint32_t sum = 0;
+	for (int i = 0; i < n; i++) {
+		sum += static_cast<uint32_t>(std::abs(a[i] - b[i]));
+	}
+	return sum;
+}
+
+uint32_t EyeCacheKernel::sad(const uint8_t* a, const uint8_t* b, int n) {
+	int i = 0;
+	uint32_t sum = 0;
+	#if defined(EYECACHE_NEON)
+	uint32x4_t acc = vdupq_n_u32(0);
+	for (; i + 16 <= n; i += 16) {
+		uint8x16_t diff = vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i));
+		acc = vpadalq_u16(acc, vpaddlq_u8(diff));
+	}
+	uint32x2_t half = vadd_u32(vget_low_u32(acc), vget_high_u32(acc));
+	sum = vget_lane_u32(vpadd_u32(half, half), 0);
+	#elif defined(EYECACHE_SSE2)
+	__m128i acc = _mm_setzero_si128();
+	for (; i + 16 <= n; i += 16) {
+		__m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+		__m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+		acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));  // Two 64-bit partial sums
+	}
+	sum = static_cast<uint32_t>(_mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(acc, acc)));
+	#endif
+	return sum + sadScalar(a + i, b + i, n - i);
+}
+
+EyeCache::EyeCache(float maxMeanDifference, int refreshInterval) {
+	configure(maxMeanDifference, refreshInterval);
+}
+
+void EyeCache::configure(float maxMeanDifference, int interval) {
+	maxSad = static_cast<uint32_t>(std::max(0.0f, maxMeanDifference) * THUMB_SIZE * THUMB_SIZE);
+	refreshInterval = std::max(0, interval);
+}
+
+double EyeCache::hitRate() const {
+	uint64_t h = hitCount, m = missCount;
+	return h + m > 0 ? static_cast<double>(h) / (h + m) : 0.0;
+}
+
+size_t EyeCache::match(const cv::Rect& where) const {
+	size_t best = slots.size();
+	int bestDistance = std::numeric_limits<int>::max();
+	for (size_t i = 0; i < slots.size(); i++) {
+		const Slot& slot = slots[i];
+		if (slot.seen) continue;
+		// Same eye: centre within a quarter of its width, size within 25%
+		int dx = (where.x + where.width / 2) - (slot.where.x + slot.where.width / 2);
+		int dy = (where.y + where.height / 2) - (slot.where.y + slot.where.height / 2);
+		int tolerance = slot.where.width / 4;
+		if (std::abs(dx) > tolerance || std::abs(dy) > tolerance) continue;
+		if (where.width * 4 < slot.where.width * 3 || where.width * 3 > slot.where.width * 4) continue;
+		int distance = dx * dx + dy * dy;
+		if (distance < bestDistance) {
+			bestDistance = distance;
+			best = i;
+		}
+	}
+	return best;
+}
+
+bool EyeCache::lookup(const cv::Mat& eye, const cv::Rect& where, Entry& entry, size_t& slot) {
+	if (0 == maxSad) {
+		slot = NO_SLOT;
+		return false;
+	}
+
+	const cv::Mat* source = &eye;
+	if (eye.channels() == 3) {
+		cv::cvtColor(eye, grey, cv::COLOR_BGR2GRAY);
+		source = &grey;
+	}
+	cv::resize(*source, thumb, cv::Size(THUMB_SIZE, THUMB_SIZE), 0, 0, cv::INTER_AREA);
+
+	slot = match(where);
+	if (slot == slots.size()) {
+		slots.emplace_back();
+	}
+	Slot& s = slots[slot];
+	s.where = where;
+	s.seen = true;
+
+	if (s.valid && s.reused < refreshInterval
+		&& EyeCacheKernel::sad(thumb.ptr<uint8_t>(), s.reference.ptr<uint8_t>(), THUMB_SIZE * THUMB_SIZE) <= maxSad) {
+		s.reused++;
+		entry = s.entry;
+		hitCount++;
+		return true;
+	}
+
+	thumb.copyTo(s.pending);
+	missCount++;
+	return false;
+}
+
+void EyeCache::store(size_t slot, const Entry& entry) {
+	if (slot >= slots.size()) return;
+	Slot& s = slots[slot];
+	std::swap(s.reference, s.pending);  // Buffers swap, no allocation once both exist
+	s.entry = entry;
+	s.reused = 0;
+	s.valid = true;
+}
+
+void EyeCache::endFrame() {
+	slots.erase(std::remove_if(slots.begin(), slots.end(), [](const Slot& s) { return !s.seen; }), slots.end());
+	for (Slot& s : slots) {
+		s.seen = false;
+	}
+}
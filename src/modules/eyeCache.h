@@ -0,0 +1,120 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Sum of absolute differences of two byte buffers, vectorised for the CPU the binary is built for.
+ *
+ * NEON on ARM (the Raspberry Pi), SSE2 on x86-64, a scalar loop elsewhere.
+ */
+namespace EyeCacheKernel {
+	/// @brief Sum of |a[i] - b[i]| with the vector kernel.
+	uint32_t sad(const uint8_t* a, const uint8_t* b, int n);
+
+	/// @brief Same with the scalar fallback, for comparison.
+	uint32_t sadScalar(const uint8_t* a, const uint8_t* b, int n);
+}
+
+/**
+ * @brief Motion gate for the eye classifier: reuses the last result of an eye while its crop has not changed.
+ *
+ * Between blinks the eye crops are almost identical from frame to frame. Every crop is shrunk to a 16x16 grey
+ * thumbnail and compared (mean absolute difference) with the thumbnail of the crop that was last classified for
+ * the same eye; eyes are matched between frames by position and size. While the difference stays below the
+ * threshold the cached state and confidence are reused, at most `refreshInterval` frames in a row. Comparing with
+ * the last classified crop rather than the previous frame means a slowly closing lid still adds up to a miss.
+ *
+ * ### USAGE:
+ *      EyeCache cache;
+ *      size_t slot;
+ *      EyeCache::Entry entry;
+ *      if (!cache.lookup(eyeROI, eyeRect, entry, slot)) {
+ *          entry = { classify(eyeROI), ... };
+ *          cache.store(slot, entry);
+ *      }
+ *      ...
+ *      cache.endFrame();                       // forgets the eyes that were not seen in this frame
+ */
+class EyeCache
+{
+public:
+	/// Side of the square thumbnail the crops are compared on
+	static const int THUMB_SIZE = 16;
+
+	/// @brief Result of a full classification of one eye.
+	struct Entry {
+		bool open = false;
+		/// Probability that the eye is open (0..1)
+		float confidence = 0.0f;
+		/// Blob keypoints found, for the telemetry
+		int keypoints = 0;
+	};
+
+	/**
+	 * @param maxMeanDifference Mean absolute grey difference per thumbnail pixel up to which the crop counts as unchanged (0 disables the cache).
+	 * @param refreshInterval Frames in a row an eye may reuse its result before it is classified again.
+	 */
+	explicit EyeCache(float maxMeanDifference = 4.0f, int refreshInterval = 5);
+
+	EyeCache(const EyeCache&) = delete;
+	EyeCache& operator=(const EyeCache&) = delete;
+
+	/**
+	 * @brief Looks up an eye crop.
+	 * @param eye Eye crop, grey or BGR.
+	 * @param where Position of the crop in the frame, used to match it with the eyes of earlier frames.
+	 * @param entry Receives the cached result on a hit.
+	 * @param slot Receives the slot to @see store() the new result in on a miss.
+	 * @return True if the cached result can be reused.
+	 */
+	bool lookup(const cv::Mat& eye, const cv::Rect& where, Entry& entry, size_t& slot);
+
+	/// @brief Stores the result of classifying the crop that missed in @see lookup().
+	void store(size_t slot, const Entry& entry);
+
+	/// @brief Ends the frame: eyes that were not looked up in it are forgotten.
+	void endFrame();
+
+	/// @brief Forgets every eye, e.g. when the classifier or its parameters change.
+	void clear() { slots.clear(); }
+
+	/// @brief Changes the threshold and the refresh interval; cached results are kept.
+	void configure(float maxMeanDifference, int refreshInterval);
+
+	uint64_t hits() const { return hitCount; }
+	uint64_t misses() const { return missCount; }
+
+	/// @brief Share of lookups that reused a result (0 before the first lookup).
+	double hitRate() const;
+
+private:
+	struct Slot {
+		cv::Rect where;
+		/// Thumbnail of the crop the entry was computed from
+		cv::Mat reference;
+		/// Thumbnail of the crop that missed, becomes the reference when its result is stored
+		cv::Mat pending;
+		Entry entry;
+		/// Frames the entry has been reused in a row
+		int reused = 0;
+		bool valid = false;
+		bool seen = false;
+	};
+
+	/// Index of the unclaimed slot of an eye at `where`, or slots.size()
+	size_t match(const cv::Rect& where) const;
+
+	uint32_t maxSad;
+	int refreshInterval;
+	std::vector<Slot> slots;
+
+	// Scratch, reused between calls
+	cv::Mat grey;
+	cv::Mat thumb;
+
+	// Read by the soak test and the metrics while the processing thread runs
+	std::atomic<uint64_t> hitCount{0};
+	std::atomic<uint64_t> missCount{0};
+};
@@ -0,0 +1,166 @@
+#include "eyeNet.h"
+#include "eyeNetWeights.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define EYENET_NEON
+#elif defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+	#define EYENET_SSE2
+#endif
+
+using namespace EyeNetWeights;
+
+int32_t EyeNetKernel::dotScalar(const int8_t* a, const int8_t* b, int n) {
+	int32_t sum = 0;
+	for (int i = 0; i < n; i++) {
+		sum += static_cast<int32_t>(a[i]) * b[i];
+	}
+	return sum;
+}
+
+int32_t EyeNetKernel::dot(const int8_t* a, const int8_t* b, int n) {
+	#if defined(EYENET_NEON)
+	int32x4_t sum = vdupq_n_s32(0);
+	for (int i = 0; i < n; i += 16) {
+		int8x16_t va = vld1q_s8(a + i);
+		int8x16_t vb = vld1q_s8(b + i);
+		int16x8_t products = vmull_s8(vget_low_s8(va), vget_low_s8(vb));
+		products = vmlal_s8(products, vget_high_s8(va), vget_high_s8(vb));  // Weights and activations stay in -127..127, two products fit in int16
+		sum = vpadalq_s16(sum, products);
+	}
+	int32x2_t half = vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+	return vget_lane_s32(vpadd_s32(half, half), 0);
+	#elif defined(EYENET_SSE2)
+	__m128i sum = _mm_setzero_si128();
+	for (int i = 0; i < n; i += 16) {
+		__m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+		__m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+		// Sign-extend to int16 (SSE2 has no cvtepi8), multiply and add pairs to int32
+		__m128i aLo = _mm_srai_epi16(_mm_unpacklo_epi8(va, va), 8);
+		__m128i aHi = _mm_srai_epi16(_mm_unpackhi_epi8(va, va), 8);
+		__m128i bLo = _mm_srai_epi16(_mm_unpacklo_epi8(vb, vb), 8);
+		__m128i bHi = _mm_srai_epi16(_mm_unpackhi_epi8(vb, vb), 8);
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(aLo, bLo));
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(aHi, bHi));
+	}
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum);
+	#else
+	return dotScalar(a, b, n);
+	#endif
+}
+
+const char* EyeNetKernel::name() {
+	#if defined(EYENET_NEON)
+	return "NEON";
+	#elif defined(EYENET_SSE2)
+	return "SSE2";
+	#else
+	return "scalar";
+	#endif
+}
+
+int32_t EyeNet::dot(const int8_t* a, const int8_t* b, int n) const {
+	return scalarOnly ? EyeNetKernel::dotScalar(a, b, n) : EyeNetKernel::dot(a, b, n);
+}
+
+// Fixed-point requantisation to int8 followed by ReLU (same arithmetic as makeEyeNetWeights.py)
+static inline int8_t requantRelu(int32_t acc, int64_t mult) {
+	int64_t v = (static_cast<int64_t>(acc) * mult + (int64_t(1) << (SHIFT - 1))) >> SHIFT;
+	return static_cast<int8_t>(std::clamp<int64_t>(v, 0, 127));
+}
+
+void EyeNet::classify(const std::vector<cv::Mat>& eyes, std::vector<Result>& results) {
+	results.resize(eyes.size());
+	for (size_t i = 0; i < eyes.size(); i++) {
+		results[i] = infer(eyes[i]);
+	}
+}
+
+EyeNet::Result EyeNet::classify(const cv::Mat& eye) {
+	return infer(eye);
+}
+
+EyeNet::Result EyeNet::infer(const cv::Mat& eye) {
+	// 🚀 24x24 grey, centred on its own mean so brightness and IR exposure don't matter
+	const cv::Mat* source = &eye;
+	if (eye.channels() == 3) {
+		cv::cvtColor(eye, grey, cv::COLOR_BGR2GRAY);
+		source = &grey;
+	}
+	cv::resize(*source, crop, cv::Size(INPUT_SIZE, INPUT_SIZE), 0, 0, cv::INTER_AREA);
+
+	int total = 0;
+	for (int y = 0; y < INPUT_SIZE; y++) {
+		const uint8_t* row = crop.ptr<uint8_t>(y);
+		for (int x = 0; x < INPUT_SIZE; x++) total += row[x];
+	}
+	int mean = (total + INPUT_SIZE * INPUT_SIZE / 2) / (INPUT_SIZE * INPUT_SIZE);
+	for (int y = 0; y < INPUT_SIZE; y++) {
+		const uint8_t* row = crop.ptr<uint8_t>(y);
+		for (int x = 0; x < INPUT_SIZE; x++) {
+			input[y * INPUT_SIZE + x] = static_cast<int8_t>(std::clamp((row[x] - mean) >> 1, -127, 127));
+		}
+	}
+
+	// 🚀 Conv 1: 3x3 patches laid out as rows of 16 so every output is one vector dot product
+	std::memset(columns1, 0, sizeof(columns1));
+	for (int y = 0; y < 22; y++) {
+		for (int x = 0; x < 22; x++) {
+			int8_t* column = columns1[y * 22 + x];
+			for (int ky = 0; ky < 3; ky++) {
+				std::memcpy(column + ky * 3, input + (y + ky) * INPUT_SIZE + x, 3);
+			}
+		}
+	}
+	for (int c = 0; c < 8; c++) {
+		for (int p = 0; p < 22 * 22; p++) {
+			act1[c][p / 22][p % 22] = requantRelu(dot(columns1[p], conv1[c], 16) + conv1Bias[c], conv1Mult);
+		}
+	}
+
+	// 🚀 Max-pool 2x2
+	for (int c = 0; c < 8; c++) {
+		for (int y = 0; y < 11; y++) {
+			for (int x = 0; x < 11; x++) {
+				pooled1[c][y][x] = std::max(std::max(act1[c][2 * y][2 * x], act1[c][2 * y][2 * x + 1]),
+					std::max(act1[c][2 * y + 1][2 * x], act1[c][2 * y + 1][2 * x + 1]));
+			}
+		}
+	}
+
+	// 🚀 Conv 2: patches of all 8 channels (channel, row, column) padded to 80
+	std::memset(columns2, 0, sizeof(columns2));
+	for (int y = 0; y < 9; y++) {
+		for (int x = 0; x < 9; x++) {
+			int8_t* column = columns2[y * 9 + x];
+			for (int c = 0; c < 8; c++) {
+				for (int ky = 0; ky < 3; ky++) {
+					std::memcpy(column + c * 9 + ky * 3, &pooled1[c][y + ky][x], 3);
+				}
+			}
+		}
+	}
+
+	// 🚀 ReLU, sum pooling and the linear head
+	float logits[2] = { fcBias[0], fcBias[1] };
+	for (int c = 0; c < 16; c++) {
+		int32_t pooled = 0;
+		for (int p = 0; p < 81; p++) {
+			pooled += requantRelu(dot(columns2[p], conv2[c], 80) + conv2Bias[c], conv2Mult);
+		}
+		logits[0] += fc[0][c] * pooled;
+		logits[1] += fc[1][c] * pooled;
+	}
+
+	Result result;
+	result.confidence = 1.0f / (1.0f + std::exp(logits[1] - logits[0]));
+	result.open = result.confidence >= threshold;
+	return result;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Int8 inner products for the eye-state net, vectorised for the CPU the binary is built for.
+ *
+ * NEON on ARM (the Raspberry Pi), SSE2 on x86-64, a scalar loop elsewhere. Lengths must be multiples of 16.
+ */
+namespace EyeNetKernel {
+	/// @brief Sum of a[i] * b[i] with the vector kernel.
+	int32_t dot(const int8_t* a, const int8_t* b, int n);
+
+	/// @brief Same with the scalar fallback, for comparison.
+	int32_t dotScalar(const int8_t* a, const int8_t* b, int n);
+
+	/// @brief Name of the vector kernel ("NEON", "SSE2" or "scalar").
+	const char* name();
+}
+
+/**
+ * @brief Tiny int8 convolutional net that tells whether an eye is open, an optional replacement for the
+ * blob detector of @see EyeStatus (which trips over glasses, IR glare and squinting).
+ *
+ * The crop is scaled to 24x24 grey and normalised to its mean, then run through conv 3x3 (8 channels), ReLU,
+ * max-pool 2x2, conv 3x3 (16 channels), ReLU, sum pooling and a linear head with a softmax. Weights and
+ * activations are int8 with fixed-point requantisation; the weights are compiled in (eyeNetWeights.h,
+ * generated by src/tools/makeEyeNetWeights.py), there is no ML runtime. Both eyes of a face are classified in
+ * one call so the scratch buffers are set up once per face.
+ *
+ * The weights that ship are a placeholder: fixed filters with a head fitted on synthetic crops. They don't
+ * tell real open and closed eyes apart (test/images/eyeClosed.jpg comes out open), so the net is off by
+ * default until weights trained on real crops are generated with `makeEyeNetWeights.py --weights`.
+ *
+ * ### USAGE:
+ *      EyeNet net;
+ *      std::vector<EyeNet::Result> results;
+ *      net.classify({ leftEye, rightEye }, results);
+ *      if (results[0].open) ...                    // results[0].confidence is P(open)
+ */
+class EyeNet
+{
+public:
+	/// Side of the square input crop
+	static const int INPUT_SIZE = 24;
+
+	struct Result {
+		bool open = false;
+		/// Probability that the eye is open (0..1)
+		float confidence = 0.0f;
+	};
+
+	/// @param openThreshold Confidence from which an eye counts as open.
+	explicit EyeNet(float openThreshold = 0.5f) : threshold(openThreshold) {}
+
+	/**
+	 * @brief Classifies a batch of eye crops.
+	 * @param eyes Eye crops of any size, grey or BGR.
+	 * @param results One result per crop (resized to fit, keeps its capacity).
+	 */
+	void classify(const std::vector<cv::Mat>& eyes, std::vector<Result>& results);
+
+	/// @brief Classifies a single eye crop.
+	Result classify(const cv::Mat& eye);
+
+	/// @brief Uses the scalar kernel instead of the vector one (for comparisons).
+	void setScalar(bool scalar) { scalarOnly = scalar; }
+
+	float threshold;
+
+private:
+	Result infer(const cv::Mat& eye);
+	int32_t dot(const int8_t* a, const int8_t* b, int n) const;
+
+	bool scalarOnly = false;
+
+	// Scratch, reused between calls
+	cv::Mat grey;
+	cv::Mat crop;
+	alignas(16) int8_t input[INPUT_SIZE * INPUT_SIZE];
+	alignas(16) int8_t columns1[22 * 22][16];
+	int8_t act1[8][22][22];
+	int8_t pooled1[8][11][11];
+	alignas(16) int8_t columns2[9 * 9][80];
+};
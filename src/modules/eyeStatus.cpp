@@ -1,12 +1,13 @@
-#include "eyeStatus.h"
-
-bool EyeStatus::detect(Mat image) {
-    std::vector<KeyPoint> keypoints;
-    detector->detect(image, keypoints);
-    if (keypoints.size() > 0) {
-        return true;
-    }
-    else {
-        return false;
-    }
-}
+#include "eyeStatus.h"
+
+bool EyeStatus::detect(Mat image) {
+    keypoints.clear();  // Keeps its capacity, no allocation once it has grown
+    detector->detect(image, keypoints);
+    keypointCount = static_cast<int>(keypoints.size());
+    if (keypoints.size() > 0) {
+        return true;
+    }
+    else {
+        return false;
+    }
+}
@@ -0,0 +1,234 @@
+#include "fatigueAnalytics.h"
+#include "metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <initializer_list>
+#include <utility>
+
+namespace {
+	const char* const WINDOW_NAMES[FatigueAnalytics::WINDOW_COUNT] = { "1s", "10s", "60s", "5min" };
+
+	/// One gauge per window, labelled `window="..."`
+	std::array<Gauge*, FatigueAnalytics::WINDOW_COUNT> windowGauges(const std::string& name, const std::string& help) {
+		std::array<Gauge*, FatigueAnalytics::WINDOW_COUNT> gauges;
+		for (int w = 0; w < FatigueAnalytics::WINDOW_COUNT; w++) {
+			gauges[w] = &Metrics::gauge(name, help, std::string("window=\"") + WINDOW_NAMES[w] + "\"");
+		}
+		return gauges;
+	}
+
+	constexpr int64_t TENTH_US = 100000;
+	/// Completed buckets each window spans (the bucket in progress completes it)
+	constexpr size_t SPAN_1S = 9;
+	constexpr size_t SPAN_10S = 9;
+	constexpr size_t SPAN_60S = 59;
+	constexpr size_t SPAN_5MIN = 29;
+	/// A gap longer than the longest window leaves nothing to keep
+	constexpr int64_t RESET_GAP_TENTHS = 3000;
+
+	int64_t micros(std::chrono::steady_clock::duration duration) {
+		return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+	}
+
+	/// Stores a completed bucket and moves the running sums of the windows over this level along
+	template <size_t N, typename Counts>
+	void push(std::array<Counts, N>& ring, size_t& head, const Counts& bucket, std::initializer_list<std::pair<Counts*, size_t>> windows) {
+		ring[head] = bucket;
+		for (const auto& [sum, span] : windows) {
+			sum->add(bucket);
+			sum->subtract(ring[(head + N - span) % N]);
+		}
+		head = (head + 1) % N;
+	}
+}
+
+static std::array<Gauge*, FatigueAnalytics::WINDOW_COUNT> perclosGauges = windowGauges("wakeomatic_perclos", "Share of the face-visible time with the eyes closed");
+static std::array<Gauge*, FatigueAnalytics::WINDOW_COUNT> blinkRateGauges = windowGauges("wakeomatic_blinks_per_minute", "Blink rate");
+static std::array<Gauge*, FatigueAnalytics::WINDOW_COUNT> blinkDurationGauges = windowGauges("wakeomatic_blink_duration_ms", "Mean blink duration");
+static std::array<Gauge*, FatigueAnalytics::WINDOW_COUNT> longClosureGauges = windowGauges("wakeomatic_long_closures", "Eye closures longer than a blink");
+
+void FatigueAnalytics::Counts::add(const Counts& other) {
+	closedUs += other.closedUs;
+	openUs += other.openUs;
+	blinkUs += other.blinkUs;
+	blinks += other.blinks;
+	longClosures += other.longClosures;
+}
+
+void FatigueAnalytics::Counts::subtract(const Counts& other) {
+	closedUs -= other.closedUs;
+	openUs -= other.openUs;
+	blinkUs -= other.blinkUs;
+	blinks -= other.blinks;
+	longClosures -= other.longClosures;
+}
+
+FatigueAnalytics::FatigueAnalytics(int longClosureMs, int maxFrameGapMs)
+	: longClosureUs(int64_t(longClosureMs) * 1000), maxGapUs(int64_t(maxFrameGapMs) * 1000) {}
+
+void FatigueAnalytics::reset() {
+	tenths = Level<10>();
+	seconds = Level<60>();
+	tens = Level<30>();
+	windowSums = {};
+	started = false;
+	tenthsDone = 0;
+	lastStatus = NOFACE;
+	closing = false;
+}
+
+void FatigueAnalytics::completeTenths() {
+	push(tenths.ring, tenths.head, tenths.current, { { &windowSums[ONE_SECOND], SPAN_1S } });
+	seconds.current.add(tenths.current);
+	tenths.current = Counts();
+	tenthsDone++;
+	if (tenthsDone % 10 == 0) {
+		completeSeconds();
+	}
+}
+
+void FatigueAnalytics::completeSeconds() {
+	push(seconds.ring, seconds.head, seconds.current, { { &windowSums[TEN_SECONDS], SPAN_10S }, { &windowSums[ONE_MINUTE], SPAN_60S } });
+	tens.current.add(seconds.current);
+	seconds.current = Counts();
+	if (tenthsDone % 100 == 0) {
+		completeTens();
+	}
+}
+
+void FatigueAnalytics::completeTens() {
+	push(tens.ring, tens.head, tens.current, { { &windowSums[FIVE_MINUTES], SPAN_5MIN } });
+	tens.current = Counts();
+}
+
+void FatigueAnalytics::advance(std::chrono::steady_clock::time_point now) {
+	int64_t target = micros(now - origin) / TENTH_US;
+	if (target - tenthsDone > RESET_GAP_TENTHS) {
+		// Nothing before the gap is in any window any more
+		tenths = Level<10>();
+		seconds = Level<60>();
+		tens = Level<30>();
+		windowSums = {};
+		tenthsDone = target;
+		return;
+	}
+	while (tenthsDone < target) {
+		completeTenths();
+	}
+}
+
+void FatigueAnalytics::update(const EyeSample& sample) {
+	std::chrono::steady_clock::time_point now = std::max(sample.timestamp, lastSample);
+	if (!started) {
+		started = true;
+		origin = sample.timestamp;
+		now = sample.timestamp;
+	}
+	else {
+		int64_t secondsBefore = tenthsDone / 10;
+		advance(now);
+
+		int64_t dt = std::min(micros(now - lastSample), maxGapUs);
+		if (lastStatus == SLEEPING) {
+			tenths.current.closedUs += dt;
+		}
+		else if (lastStatus == AWAKE) {
+			tenths.current.openUs += dt;
+		}
+
+		if (tenthsDone / 10 != secondsBefore) {
+			publish();
+		}
+	}
+
+	if (sample.status == SLEEPING && !closing) {
+		closing = true;
+		closureStart = now;
+	}
+	else if (sample.status == AWAKE && closing) {
+		int64_t duration = micros(now - closureStart);
+		if (duration < longClosureUs) {
+			tenths.current.blinks++;
+			tenths.current.blinkUs += duration;
+		}
+		else {
+			tenths.current.longClosures++;
+		}
+		closing = false;
+	}
+	else if (sample.status == NOFACE) {
+		// Lost the face mid-closure: we don't know when the eyes opened
+		closing = false;
+	}
+
+	lastSample = now;
+	lastStatus = sample.status;
+}
+
+FatigueAnalytics::WindowStats FatigueAnalytics::window(Window window) const {
+	WindowStats stats;
+	if (!started) return stats;
+
+	Counts counts = windowSums[window];
+	counts.add(tenths.current);
+	double bucketSeconds = 0.1;
+	size_t span = SPAN_1S;
+	if (window != ONE_SECOND) {
+		counts.add(seconds.current);
+		bucketSeconds = 1.0;
+		span = window == TEN_SECONDS ? SPAN_10S : SPAN_60S;
+	}
+	if (window == FIVE_MINUTES) {
+		counts.add(tens.current);
+		bucketSeconds = 10.0;
+		span = SPAN_5MIN;
+	}
+
+	double elapsed = std::chrono::duration<double>(lastSample - origin).count();
+	double inProgress = elapsed - std::floor(elapsed / bucketSeconds) * bucketSeconds;
+	stats.seconds = std::min(elapsed, span * bucketSeconds + inProgress);
+
+	double faceUs = double(counts.closedUs + counts.openUs);
+	stats.faceSeconds = faceUs / 1e6;
+	stats.perclos = faceUs > 0.0 ? counts.closedUs / faceUs : 0.0;
+	stats.blinks = counts.blinks;
+	stats.longClosures = counts.longClosures;
+	stats.blinksPerMinute = stats.seconds > 0.0 ? counts.blinks * 60.0 / stats.seconds : 0.0;
+	stats.meanBlinkMs = counts.blinks > 0 ? counts.blinkUs / 1000.0 / counts.blinks : 0.0;
+	return stats;
+}
+
+double FatigueAnalytics::windowSeconds(Window window) {
+	static const double SECONDS[WINDOW_COUNT] = { 1.0, 10.0, 60.0, 300.0 };
+	return SECONDS[window];
+}
+
+const char* FatigueAnalytics::windowName(Window window) {
+	return WINDOW_NAMES[window];
+}
+
+double FatigueAnalytics::currentClosureMs() const {
+	if (!closing) return 0.0;
+	return std::chrono::duration<double, std::milli>(lastSample - closureStart).count();
+}
+
+void FatigueAnalytics::publish() const {
+	for (int w = 0; w < WINDOW_COUNT; w++) {
+		WindowStats stats = window(Window(w));
+		perclosGauges[w]->set(stats.perclos);
+		blinkRateGauges[w]->set(stats.blinksPerMinute);
+		blinkDurationGauges[w]->set(stats.meanBlinkMs);
+		longClosureGauges[w]->set(stats.longClosures);
+	}
+}
+
+void FatigueAnalytics::report(std::ostream& out) const {
+	char line[160];
+	for (int w = 0; w < WINDOW_COUNT; w++) {
+		WindowStats stats = window(Window(w));
+		std::snprintf(line, sizeof(line), "📈 Fatigue %-4s PERCLOS %5.1f %%, %5.1f blinks/min, mean blink %4.0f ms, %u long closures",
+			WINDOW_NAMES[w], stats.perclos * 100.0, stats.blinksPerMinute, stats.meanBlinkMs, stats.longClosures);
+		out << line << std::endl;
+	}
+}
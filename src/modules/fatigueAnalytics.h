@@ -0,0 +1,130 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include "sleepDetect.h"
+
+/**
+ * @brief Streaming blink and PERCLOS statistics over rolling 1 s, 10 s, 60 s and 5 min windows, for fatigue trends during a shift.
+ *
+ * Every eye-state sample from `status_channel` is added in O(1) amortised time. Time is kept in three levels of
+ * buckets: 100 ms, 1 s and 10 s. The bucket in progress at each level collects the completed buckets of the level
+ * below it (hierarchical rollup), and every window keeps a running sum of the completed buckets it spans. Adding a
+ * bucket to a window and dropping the oldest one are two additions, and a window is read as its running sum plus
+ * the buckets in progress. Memory is fixed (100 buckets) however long the shift runs.
+ *
+ * Closed time is attributed to each frame until the next one (capped, so a stalled pipeline doesn't count as a
+ * long closure). A closure that ends within `longClosureMs` counts as a blink, a longer one as a long closure; both
+ * are counted in the bucket in which the eyes open again. PERCLOS is the share of the time with a face in view in
+ * which the eyes were closed.
+ *
+ * ### USAGE:
+ *      FatigueAnalytics analytics;
+ *      while (...) {
+ *          analytics.update(sample);            // every sample taken from status_channel
+ *      }
+ *      FatigueAnalytics::WindowStats minute = analytics.window(FatigueAnalytics::ONE_MINUTE);
+ *      std::cout << minute.perclos << " " << minute.blinksPerMinute << std::endl;
+ */
+class FatigueAnalytics
+{
+public:
+	/// @brief Rolling windows
+	enum Window {
+		ONE_SECOND,
+		TEN_SECONDS,
+		ONE_MINUTE,
+		FIVE_MINUTES,
+		WINDOW_COUNT
+	};
+
+	/// @brief Statistics of one window
+	struct WindowStats {
+		/// Share of the face-visible time with the eyes closed (0..1)
+		double perclos = 0.0;
+		double blinksPerMinute = 0.0;
+		/// Mean duration of the blinks that ended in the window, 0 without blinks
+		double meanBlinkMs = 0.0;
+		uint32_t blinks = 0;
+		/// Closures longer than a blink that ended in the window
+		uint32_t longClosures = 0;
+		/// Time with a face in view
+		double faceSeconds = 0.0;
+		/// Time the window covers so far (less than its length early in the shift)
+		double seconds = 0.0;
+	};
+
+	/**
+	 * @param longClosureMs Closures from this length on are long closures instead of blinks.
+	 * @param maxFrameGapMs Longest time a single sample counts for, the rest of a gap counts as no data.
+	 */
+	explicit FatigueAnalytics(int longClosureMs = 500, int maxFrameGapMs = 200);
+
+	/// @brief Adds one eye-state sample; samples must come in capture order.
+	void update(const EyeSample& sample);
+
+	/// @brief Statistics of a window, up to the last sample.
+	WindowStats window(Window window) const;
+
+	/// @brief Length of a window in seconds.
+	static double windowSeconds(Window window);
+
+	/// @brief Name of a window ("1s", "10s", "60s", "5min").
+	static const char* windowName(Window window);
+
+	/// @brief Duration of the closure in progress in ms, 0 while the eyes are open.
+	double currentClosureMs() const;
+
+	/// @brief Prints one line per window.
+	void report(std::ostream& out) const;
+
+	/// @brief Forgets everything, e.g. at the start of a new shift.
+	void reset();
+
+private:
+	/// Everything counted in one bucket; all integers, so buckets can be subtracted from running sums exactly
+	struct Counts {
+		int64_t closedUs = 0;
+		int64_t openUs = 0;
+		int64_t blinkUs = 0;
+		uint32_t blinks = 0;
+		uint32_t longClosures = 0;
+
+		void add(const Counts& other);
+		void subtract(const Counts& other);
+	};
+
+	/// One level of buckets: the bucket in progress and a ring of completed ones
+	template <size_t N>
+	struct Level {
+		std::array<Counts, N> ring{};
+		Counts current;
+		size_t head = 0;  ///< Slot the next completed bucket goes to
+	};
+
+	/// Sets the gauges of every window, once a second
+	void publish() const;
+
+	/// Closes buckets up to the one that contains `now`
+	void advance(std::chrono::steady_clock::time_point now);
+	void completeTenths();
+	void completeSeconds();
+	void completeTens();
+
+	int64_t longClosureUs;
+	int64_t maxGapUs;
+
+	Level<10> tenths;    ///< 100 ms buckets, the 1 s window spans 9 completed ones
+	Level<60> seconds;   ///< 1 s buckets, the 10 s and 60 s windows span 9 and 59
+	Level<30> tens;      ///< 10 s buckets, the 5 min window spans 29
+	std::array<Counts, WINDOW_COUNT> windowSums{};
+
+	bool started = false;
+	std::chrono::steady_clock::time_point origin;
+	std::chrono::steady_clock::time_point lastSample;
+	int64_t tenthsDone = 0;  ///< Completed 100 ms buckets since the origin
+	int lastStatus = NOFACE;
+	bool closing = false;
+	std::chrono::steady_clock::time_point closureStart;
+};
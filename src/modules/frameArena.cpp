@@ -0,0 +1,46 @@
+#include "frameArena.h"
+#include <algorithm>
+
+FrameArena::FrameArena(size_t initialBytes) {
+	rebuild(initialBytes);
+}
+
+void FrameArena::rebuild(size_t bytes) {
+	arena.reset();
+	buffer.reset(new std::byte[bytes]);
+	capacityBytes = bytes;
+	arena.emplace(buffer.get(), capacityBytes, &spill);
+}
+
+void* FrameArena::allocate(size_t bytes, size_t alignment) {
+	usedBytes += bytes + alignment - 1;  // Worst case padding, used to size the buffer
+	return arena->allocate(bytes, alignment);
+}
+
+cv::Mat FrameArena::mat(int rows, int cols, int type) {
+	size_t step = static_cast<size_t>(cols) * CV_ELEM_SIZE(type);
+	return cv::Mat(rows, cols, type, allocate(step * rows), step);
+}
+
+void FrameArena::reset() {
+	highWaterBytes = std::max(highWaterBytes, usedBytes);
+	usedBytes = 0;
+
+	if (spill.spilled) {
+		// Grow to the high-water mark with some headroom, heap blocks are freed by the release below
+		overflowCount++;
+		spill.spilled = false;
+		rebuild(std::max(capacityBytes * 2, highWaterBytes + highWaterBytes / 2));
+		return;
+	}
+	arena->release();
+}
+
+void* FrameArena::SpillResource::do_allocate(size_t bytes, size_t alignment) {
+	spilled = true;
+	return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void FrameArena::SpillResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+	std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
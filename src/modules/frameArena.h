@@ -0,0 +1,80 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+/**
+ * @brief Per-frame monotonic arena for the scratch memory of the detection path.
+ *
+ * Scratch images (face and eye regions) and pmr containers are carved out of one persistent buffer with a
+ * `std::pmr::monotonic_buffer_resource` and all released at once by @see reset() at the end of the frame,
+ * so a frame costs no heap allocation and the heap can't fragment over a long shift. If a frame needs more
+ * than the buffer holds, the rest comes from the heap (and is counted) and the buffer grows at the next
+ * reset, so after the first few frames it has settled at the high-water mark.
+ *
+ * Memory handed out by the arena is only valid until the next @see reset().
+ *
+ * ### USAGE:
+ *      cv::Mat faceROI = arena.mat(face.height, face.width, frame.type());
+ *      frame(face).copyTo(faceROI);                  // reuses the arena memory, sizes and types match
+ *      std::pmr::vector<int> counts(arena.resource());
+ *      ...
+ *      arena.reset();                                // end of frame
+ */
+class FrameArena
+{
+public:
+	/// @param initialBytes Size of the buffer before it has grown to the high-water mark.
+	explicit FrameArena(size_t initialBytes = 1 << 20);
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	/// @brief Allocates memory that stays valid until the next @see reset().
+	void* allocate(size_t bytes, size_t alignment = 64);
+
+	/// @brief Image on arena memory. Continuous, rows are not padded.
+	cv::Mat mat(int rows, int cols, int type);
+
+	/// @brief Memory resource for pmr containers that live for one frame.
+	std::pmr::memory_resource* resource() { return &*arena; }
+
+	/// @brief Releases everything allocated since the last reset; grows the buffer if this frame spilled onto the heap.
+	void reset();
+
+	/// @brief Bytes handed out since the last reset.
+	size_t used() const { return usedBytes; }
+
+	/// @brief Size of the persistent buffer.
+	size_t capacity() const { return capacityBytes; }
+
+	/// @brief Most bytes any frame has needed.
+	size_t highWater() const { return highWaterBytes; }
+
+	/// @brief Number of frames that did not fit into the buffer (each one triggers a grow).
+	uint64_t overflows() const { return overflowCount; }
+
+private:
+	/// Heap fallback for the monotonic resource, remembers that the buffer was too small
+	class SpillResource : public std::pmr::memory_resource {
+	public:
+		bool spilled = false;
+	private:
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+	};
+
+	void rebuild(size_t bytes);
+
+	std::unique_ptr<std::byte[]> buffer;
+	size_t capacityBytes = 0;
+	size_t usedBytes = 0;
+	size_t highWaterBytes = 0;
+	uint64_t overflowCount = 0;
+	SpillResource spill;
+	std::optional<std::pmr::monotonic_buffer_resource> arena;
+};
@@ -0,0 +1,171 @@
+#include "frameExport.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+using namespace std::chrono;
+using namespace FrameExportLayout;
+
+bool FrameExporter::open(const Config& config) {
+	close();
+
+	#ifdef _WIN32
+	std::cerr << "⚠️ WARNING: Shared-memory frame export is not available on this system." << std::endl;
+	return false;
+	#else
+	uint32_t slotCount = static_cast<uint32_t>(std::max(2, config.slots));
+	uint32_t resultCount = static_cast<uint32_t>(std::max(1, config.results));
+	uint64_t frameSlotBytes = align64(sizeof(ExportFrameSlot) + static_cast<uint64_t>(config.maxWidth) * config.maxHeight * 3);
+	uint64_t framesOffset = align64(sizeof(ExportHeader));
+	uint64_t resultsOffset = framesOffset + slotCount * frameSlotBytes;
+	mappingBytes = resultsOffset + resultCount * sizeof(ExportResultSlot);
+
+	// A stale object from a crashed run may have another size, start from scratch
+	shm_unlink(config.name.c_str());
+	fd = shm_open(config.name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+	if (fd < 0) {
+		std::cerr << "❌ ERROR: Could not create shared memory " << config.name << std::endl;
+		return false;
+	}
+	if (0 != ftruncate(fd, mappingBytes)) {
+		std::cerr << "❌ ERROR: Could not size shared memory " << config.name << " to " << mappingBytes << " bytes" << std::endl;
+		::close(fd);
+		shm_unlink(config.name.c_str());
+		fd = -1;
+		return false;
+	}
+
+	void* addr = mmap(nullptr, mappingBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (MAP_FAILED == addr) {
+		std::cerr << "❌ ERROR: Could not map shared memory " << config.name << std::endl;
+		::close(fd);
+		shm_unlink(config.name.c_str());
+		fd = -1;
+		return false;
+	}
+
+	// ftruncate zero-fills, so every slot starts empty (sequence 0)
+	name = config.name;
+	mapping = static_cast<uint8_t*>(addr);
+	header = reinterpret_cast<ExportHeader*>(mapping);
+	header->version = VERSION;
+	header->slotCount = slotCount;
+	header->maxWidth = config.maxWidth;
+	header->maxHeight = config.maxHeight;
+	header->resultCount = resultCount;
+	header->frameSlotBytes = frameSlotBytes;
+	header->framesOffset = framesOffset;
+	header->resultsOffset = resultsOffset;
+	header->frameWrites.store(0);
+	header->resultWrites.store(0);
+	// Magic last, readers don't trust the header before it is there
+	std::atomic_thread_fence(std::memory_order_release);
+	std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+
+	std::cout << "✅ Exporting frames to shared memory " << name << " (" << slotCount << " slots)" << std::endl;
+	return true;
+	#endif
+}
+
+void FrameExporter::close() {
+	#ifndef _WIN32
+	if (nullptr != mapping) {
+		munmap(mapping, mappingBytes);
+		shm_unlink(name.c_str());
+	}
+	if (fd >= 0) {
+		::close(fd);
+	}
+	#endif
+
+	mapping = nullptr;
+	header = nullptr;
+	fd = -1;
+}
+
+ExportFrameSlot* FrameExporter::frameSlot(uint64_t index) const {
+	return reinterpret_cast<ExportFrameSlot*>(mapping + header->framesOffset + (index % header->slotCount) * header->frameSlotBytes);
+}
+
+void FrameExporter::nextScene(const cv::Mat& frame) {
+	nextStampedScene(frame, clock->now(), 0);
+}
+
+// The frame is stamped once, the callbacks down the chain and the processing thread keep this capture time
+void FrameExporter::nextStampedScene(const cv::Mat& frame, steady_clock::time_point captured, uint64_t) {
+	uint64_t number = publish(frame, captured);
+	if (nullptr != nextCallback) {
+		nextCallback->nextStampedScene(frame, captured, number);
+	}
+}
+
+uint64_t FrameExporter::publish(const cv::Mat& frame, steady_clock::time_point captured) {
+	if (nullptr == header || frame.empty() || frame.depth() != CV_8U || (frame.channels() != 1 && frame.channels() != 3)) return 0;
+
+	uint64_t number = header->frameWrites.load(std::memory_order_relaxed) + 1;
+	ExportFrameSlot* target = frameSlot(number - 1);
+
+	// Odd sequence: readers skip the slot (or discard what they read) until it is complete
+	target->sequence.store(2 * number - 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	cv::Size size = frame.size();
+	if (size.width > static_cast<int>(header->maxWidth) || size.height > static_cast<int>(header->maxHeight)) {
+		double scale = std::min(static_cast<double>(header->maxWidth) / size.width, static_cast<double>(header->maxHeight) / size.height);
+		size = cv::Size(static_cast<int>(size.width * scale), static_cast<int>(size.height * scale));
+	}
+
+	// Copy (or scale) straight into the slot, OpenCV reuses the memory since size and type match
+	uint8_t* pixels = reinterpret_cast<uint8_t*>(target) + sizeof(ExportFrameSlot);
+	size_t step = static_cast<size_t>(size.width) * frame.elemSize();
+	cv::Mat view(size, frame.type(), pixels, step);
+	if (size == frame.size()) {
+		frame.copyTo(view);
+	}
+	else {
+		cv::resize(frame, view, size, 0, 0, cv::INTER_AREA);
+	}
+
+	target->timestampNs = duration_cast<nanoseconds>(captured.time_since_epoch()).count();
+	target->width = size.width;
+	target->height = size.height;
+	target->type = frame.type();
+	target->step = static_cast<uint32_t>(step);
+
+	target->sequence.store(2 * number, std::memory_order_release);
+	header->frameWrites.store(number, std::memory_order_release);
+	return number;
+}
+
+void FrameExporter::publishResult(uint64_t number, const EyeSample& sample, const TelemetryRecord& record) {
+	if (nullptr == header || 0 == number) return;
+
+	// Indexed by frame number: the slots of dropped frames keep an older sequence and read as missing
+	ExportResultSlot* target = reinterpret_cast<ExportResultSlot*>(mapping + header->resultsOffset) + (number - 1) % header->resultCount;
+
+	target->sequence.store(2 * number - 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	target->timestampNs = duration_cast<nanoseconds>(sample.timestamp.time_since_epoch()).count();
+	target->rawStatus = sample.status;
+	target->gatedStatus = record.gatedStatus;
+	target->openConfidence = sample.openConfidence;
+	target->faceX = record.faceX;
+	target->faceY = record.faceY;
+	target->faceWidth = record.faceWidth;
+	target->faceHeight = record.faceHeight;
+
+	target->sequence.store(2 * number, std::memory_order_release);
+	header->resultWrites.store(number, std::memory_order_release);
+}
+
+uint64_t FrameExporter::framesPublished() const {
+	return nullptr == header ? 0 : header->frameWrites.load();
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "camera.h"
+#include "clock.h"
+#include "sleepDetect.h"
+#include "telemetry.h"
+#include "frameExportLayout.h"
+
+/**
+ * @brief Publishes camera frames and per-frame detection results into a POSIX shared-memory ring, so other
+ * processes on the box (dashcam recorder, telematics agent) can use the frames without opening the camera again.
+ *
+ * Like @see BlackBoxRecorder the exporter sits in the camera callback chain: every frame is copied once into
+ * the next slot of the ring and passed on. Readers map the ring read-only and use the pixels in place
+ * (@see FrameExportReader). Slots are seqlocks (see @see FrameExportLayout), so a slow reader only loses
+ * frames and never holds up the camera thread.
+ *
+ * ### USAGE:
+ *      FrameExporter exporter;
+ *      exporter.open(FrameExporter::Config());
+ *      exporter.chain(&cb);
+ *      camera.registerSceneCallback(&exporter);
+ *      frameProcessor.setFrameExport(&exporter);   // detection results as well
+ *
+ * Only available on POSIX systems, on other systems @see open() returns false and frames are only passed on.
+ */
+class FrameExporter : public Camera::SceneCallback
+{
+public:
+	/// @brief Name and size of the shared-memory ring
+	struct Config {
+		/// Shared-memory object name (shows up in /dev/shm)
+		std::string name = "/wake-o-matic-frames";
+		/// Frames kept in the ring, readers have this many frame periods to use a frame
+		int slots = 8;
+		/// Largest frame stored, bigger frames are downscaled
+		int maxWidth = 1280;
+		int maxHeight = 720;
+		/// Detection results kept in the ring
+		int results = 64;
+	};
+
+	FrameExporter() = default;
+	~FrameExporter() { close(); }
+	FrameExporter(const FrameExporter&) = delete;
+	FrameExporter& operator=(const FrameExporter&) = delete;
+
+	/**
+	 * @brief Creates the shared-memory object (replacing a stale one) and maps it.
+	 * @param config Name and size of the ring.
+	 * @return True if frames are being exported.
+	 */
+	bool open(const Config& config);
+
+	/// @brief Unmaps and removes the shared-memory object; readers that still map it keep their mapping.
+	void close();
+
+	/// @brief Sets the callback the frames are passed on to.
+	void chain(Camera::SceneCallback* next) { nextCallback = next; }
+
+	/// @brief Sets the clock that timestamps frames arriving through @see nextScene (the steady clock by default).
+	void setClock(Clock* newClock) { clock = newClock; }
+
+	/// @brief Stamps and publishes the frame, then passes it on to the chained callback with its capture time and frame number.
+	void nextScene(const cv::Mat& frame) override;
+
+	/// @brief Publishes a frame stamped earlier in the chain, then passes it on with its frame number.
+	void nextStampedScene(const cv::Mat& frame, std::chrono::steady_clock::time_point captured, uint64_t exportNumber) override;
+
+	/**
+	 * @brief Copies a frame into the next slot of the ring.
+	 * @param frame Camera frame (BGR or grey).
+	 * @param captured Capture time of the frame.
+	 * @return Number of the frame in the ring, counting from 1; 0 if it was not exported.
+	 */
+	uint64_t publish(const cv::Mat& frame, std::chrono::steady_clock::time_point captured);
+
+	/**
+	 * @brief Publishes the result of processing a frame under the frame's number, so readers can match the two.
+	 * Frames dropped before detection simply have no result.
+	 * @param frameNumber Number @see publish() returned for the frame (nothing is published for 0).
+	 * @param sample Eye state and capture time of the frame.
+	 * @param record Face and gated status of the frame.
+	 */
+	void publishResult(uint64_t frameNumber, const EyeSample& sample, const TelemetryRecord& record);
+
+	/// @brief Number of frames published since the ring was created.
+	uint64_t framesPublished() const;
+
+private:
+	FrameExportLayout::ExportFrameSlot* frameSlot(uint64_t index) const;
+
+	Camera::SceneCallback* nextCallback = nullptr;
+	Clock* clock = &Clock::steady();
+	std::string name;
+	int fd = -1;
+	uint8_t* mapping = nullptr;
+	size_t mappingBytes = 0;
+	FrameExportLayout::ExportHeader* header = nullptr;
+	cv::Mat scaled;
+};
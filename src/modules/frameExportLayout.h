@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Memory layout of the shared-memory frame export, shared by @see FrameExporter (writer) and
+ * @see FrameExportReader (readers in other processes).
+ *
+ * The region starts with an @see ExportHeader, followed by `slotCount` frame slots of `frameSlotBytes` each
+ * (an @see ExportFrameSlot and the pixels, rows of `step` bytes) and `resultCount` @see ExportResultSlot
+ * entries. All offsets are 64-byte aligned.
+ *
+ * Every slot is a seqlock: its `sequence` is odd while the writer fills it and `2 * n` once it holds frame
+ * number `n` (or the result of frame `n`, in result slot `(n - 1) % resultCount`), counting from 1. Frames dropped
+ * before detection have no result. A reader checks the sequence before and after using a slot; if it
+ * changed, the writer lapped the reader and the data must be discarded. The writer never waits for readers.
+ */
+namespace FrameExportLayout {
+
+static const char MAGIC[8] = { 'W', 'O', 'M', 'S', 'H', 'M', '1', '\0' };
+static const uint32_t VERSION = 2;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared-memory sequence counters must be lock free");
+
+struct ExportHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t slotCount;
+	/// Largest frame a slot holds, bigger frames are downscaled
+	uint32_t maxWidth;
+	uint32_t maxHeight;
+	uint32_t resultCount;
+	uint32_t reserved;
+	uint64_t frameSlotBytes;
+	uint64_t framesOffset;
+	uint64_t resultsOffset;
+	/// Number of frames published so far, the newest one is in slot `(frameWrites - 1) % slotCount`
+	std::atomic<uint64_t> frameWrites;
+	/// Frame number of the newest result published so far
+	std::atomic<uint64_t> resultWrites;
+};
+
+struct alignas(64) ExportFrameSlot {
+	std::atomic<uint64_t> sequence;
+	/// Capture time in nanoseconds of the steady clock
+	int64_t timestampNs;
+	uint32_t width;
+	uint32_t height;
+	/// OpenCV type of the pixels (CV_8UC1 or CV_8UC3)
+	int32_t type;
+	/// Bytes per row
+	uint32_t step;
+};
+
+/// @brief Outcome of `FrameProcessor::processFrame` for one frame
+struct alignas(64) ExportResultSlot {
+	std::atomic<uint64_t> sequence;
+	/// Capture time of the processed frame in nanoseconds of the steady clock, the same as in its frame slot
+	int64_t timestampNs;
+	/// Raw eye status (-1 no face, 0 closed, 1 open) and the status after the microsleep time gate
+	int32_t rawStatus;
+	int32_t gatedStatus;
+	float openConfidence;
+	/// First detected face, all zero when no face was found
+	int32_t faceX;
+	int32_t faceY;
+	int32_t faceWidth;
+	int32_t faceHeight;
+};
+
+inline uint64_t align64(uint64_t bytes) {
+	return (bytes + 63) & ~uint64_t(63);
+}
+
+}
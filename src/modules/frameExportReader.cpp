@@ -0,0 +1,163 @@
+#include "frameExportReader.h"
+#include <algorithm>
+#include <cstring>
+
+#ifndef _WIN32
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+using namespace FrameExportLayout;
+
+bool FrameExportReader::open(const std::string& name) {
+	close();
+
+	#ifdef _WIN32
+	return false;
+	#else
+	fd = shm_open(name.c_str(), O_RDONLY, 0);
+	if (fd < 0) return false;
+
+	struct stat info;
+	if (0 != fstat(fd, &info) || static_cast<size_t>(info.st_size) < sizeof(ExportHeader)) {
+		close();
+		return false;
+	}
+
+	mappingBytes = info.st_size;
+	void* addr = mmap(nullptr, mappingBytes, PROT_READ, MAP_SHARED, fd, 0);
+	if (MAP_FAILED == addr) {
+		close();
+		return false;
+	}
+	mapping = static_cast<const uint8_t*>(addr);
+
+	// The writer stores the magic last, a ring that is still being set up is not opened
+	const ExportHeader* candidate = reinterpret_cast<const ExportHeader*>(mapping);
+	if (0 != std::memcmp(candidate->magic, MAGIC, sizeof(MAGIC))) {
+		close();
+		return false;
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (VERSION != candidate->version || mappingBytes < candidate->resultsOffset + candidate->resultCount * sizeof(ExportResultSlot)) {
+		close();
+		return false;
+	}
+
+	header = candidate;
+	lastNumber = 0;
+	missed = 0;
+	return true;
+	#endif
+}
+
+void FrameExportReader::close() {
+	#ifndef _WIN32
+	if (nullptr != mapping) {
+		munmap(const_cast<uint8_t*>(mapping), mappingBytes);
+	}
+	if (fd >= 0) {
+		::close(fd);
+	}
+	#endif
+
+	mapping = nullptr;
+	header = nullptr;
+	fd = -1;
+}
+
+const ExportFrameSlot* FrameExportReader::frameSlot(uint64_t number) const {
+	return reinterpret_cast<const ExportFrameSlot*>(mapping + header->framesOffset + ((number - 1) % header->slotCount) * header->frameSlotBytes);
+}
+
+uint64_t FrameExportReader::framesPublished() const {
+	return nullptr == header ? 0 : header->frameWrites.load(std::memory_order_acquire);
+}
+
+bool FrameExportReader::readFrame(uint64_t number, Frame& frame) const {
+	const ExportFrameSlot* slot = frameSlot(number);
+	if (slot->sequence.load(std::memory_order_acquire) != 2 * number) return false;
+
+	int64_t timestampNs = slot->timestampNs;
+	int width = static_cast<int>(slot->width);
+	int height = static_cast<int>(slot->height);
+	int type = slot->type;
+	size_t step = slot->step;
+
+	// The slot description must not have changed while it was read
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (slot->sequence.load(std::memory_order_relaxed) != 2 * number) return false;
+	if (width <= 0 || height <= 0 || width > static_cast<int>(header->maxWidth) || height > static_cast<int>(header->maxHeight)) return false;
+
+	frame.number = number;
+	frame.timestampNs = timestampNs;
+	uint8_t* pixels = const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(slot) + sizeof(ExportFrameSlot));
+	frame.image = cv::Mat(height, width, type, pixels, step);  // Mapped read-only, writing to it faults
+	return true;
+}
+
+bool FrameExportReader::latest(Frame& frame) {
+	if (nullptr == header) return false;
+
+	uint64_t newest = framesPublished();
+	if (0 == newest || !readFrame(newest, frame)) return false;
+	lastNumber = newest;
+	return true;
+}
+
+bool FrameExportReader::next(Frame& frame) {
+	if (nullptr == header) return false;
+
+	uint64_t newest = framesPublished();
+	if (newest <= lastNumber) return false;
+
+	// Frames older than the ring (plus one slot that may be being rewritten) are gone
+	uint64_t wanted = lastNumber + 1;
+	uint64_t oldest = newest >= header->slotCount ? newest - header->slotCount + 2 : 1;
+	if (wanted < oldest) {
+		missed += oldest - wanted;
+		wanted = oldest;
+	}
+
+	for (; wanted <= newest; wanted++) {
+		if (readFrame(wanted, frame)) {
+			lastNumber = wanted;
+			return true;
+		}
+		missed++;  // Overwritten while we were looking
+	}
+	lastNumber = newest;
+	return false;
+}
+
+bool FrameExportReader::stillValid(const Frame& frame) const {
+	if (nullptr == header || 0 == frame.number) return false;
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return frameSlot(frame.number)->sequence.load(std::memory_order_relaxed) == 2 * frame.number;
+}
+
+bool FrameExportReader::result(uint64_t number, Result& result) const {
+	if (nullptr == header) return false;
+
+	uint64_t newest = header->resultWrites.load(std::memory_order_acquire);
+	if (0 == number) number = newest;
+	if (0 == number || number > newest) return false;
+
+	const ExportResultSlot* slot = reinterpret_cast<const ExportResultSlot*>(mapping + header->resultsOffset) + (number - 1) % header->resultCount;
+	if (slot->sequence.load(std::memory_order_acquire) != 2 * number) return false;
+
+	Result copy;
+	copy.number = number;
+	copy.timestampNs = slot->timestampNs;
+	copy.rawStatus = slot->rawStatus;
+	copy.gatedStatus = slot->gatedStatus;
+	copy.openConfidence = slot->openConfidence;
+	copy.face = cv::Rect(slot->faceX, slot->faceY, slot->faceWidth, slot->faceHeight);
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (slot->sequence.load(std::memory_order_relaxed) != 2 * number) return false;
+	result = copy;
+	return true;
+}
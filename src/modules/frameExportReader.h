@@ -0,0 +1,107 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <string>
+#include "frameExportLayout.h"
+
+/**
+ * @brief Reads frames and detection results exported by wake-o-matic (@see FrameExporter) from another process.
+ *
+ * The ring is mapped read-only and frames are handed out as `cv::Mat` views on the shared memory, without
+ * copying. The writer never waits for readers: a view stays usable only as long as the writer has not come
+ * round to its slot again, so after using a view (or copying it) call @see stillValid() and discard the
+ * result if it returns false. With the default 8 slots at 30 fps that leaves about 250 ms per frame.
+ *
+ * Only depends on OpenCV core, link the `wake-o-matic-frame-reader` library.
+ *
+ * ### USAGE:
+ *      FrameExportReader reader;
+ *      reader.open("/wake-o-matic-frames");
+ *      FrameExportReader::Frame frame;
+ *      while (running) {
+ *          if (!reader.next(frame)) { sleep(5 ms); continue; }
+ *          encoder.write(frame.image);
+ *          if (!reader.stillValid(frame)) { ... drop what was written ... }
+ *      }
+ */
+class FrameExportReader
+{
+public:
+	/// @brief A frame in the shared ring
+	struct Frame {
+		/// Frame number, counting from 1
+		uint64_t number = 0;
+		/// Capture time in nanoseconds of the writer's steady clock
+		int64_t timestampNs = 0;
+		/// Read-only view on the pixels in shared memory (BGR or grey)
+		cv::Mat image;
+	};
+
+	/// @brief Detection result of one frame
+	struct Result {
+		/// Number of the frame the result belongs to, as in @see Frame
+		uint64_t number = 0;
+		int64_t timestampNs = 0;
+		int rawStatus = -1;
+		int gatedStatus = -1;
+		float openConfidence = 0;
+		cv::Rect face;
+	};
+
+	FrameExportReader() = default;
+	~FrameExportReader() { close(); }
+	FrameExportReader(const FrameExportReader&) = delete;
+	FrameExportReader& operator=(const FrameExportReader&) = delete;
+
+	/**
+	 * @brief Maps an exported ring read-only.
+	 * @param name Shared-memory object name used by the writer.
+	 * @return False if the ring does not exist (yet) or is not a frame export.
+	 */
+	bool open(const std::string& name);
+
+	/// @brief Unmaps the ring.
+	void close();
+
+	/// @brief True while a ring is mapped.
+	bool isOpen() const { return nullptr != header; }
+
+	/**
+	 * @brief Gets the newest frame.
+	 * @return False if no complete frame is available.
+	 */
+	bool latest(Frame& frame);
+
+	/**
+	 * @brief Gets the frame after the last one returned, skipping ahead (and counting the skipped frames)
+	 * if the writer has already overwritten it.
+	 * @return False if there is no newer frame yet.
+	 */
+	bool next(Frame& frame);
+
+	/// @brief True if the frame's slot has not been overwritten since the frame was returned.
+	bool stillValid(const Frame& frame) const;
+
+	/**
+	 * @brief Copies the result of the given frame number (@see Frame::number), or the newest one with 0.
+	 * @return False if the frame was dropped before detection, is not processed yet or its result is no longer in the ring.
+	 */
+	bool result(uint64_t number, Result& result) const;
+
+	/// @brief Number of frames published by the writer so far.
+	uint64_t framesPublished() const;
+
+	/// @brief Frames skipped by @see next() because the writer lapped this reader.
+	uint64_t framesMissed() const { return missed; }
+
+private:
+	bool readFrame(uint64_t number, Frame& frame) const;
+	const FrameExportLayout::ExportFrameSlot* frameSlot(uint64_t number) const;
+
+	int fd = -1;
+	const uint8_t* mapping = nullptr;
+	size_t mappingBytes = 0;
+	const FrameExportLayout::ExportHeader* header = nullptr;
+	uint64_t lastNumber = 0;
+	uint64_t missed = 0;
+};
@@ -1,159 +1,382 @@
-#include "frameProcessor.h"
-
-// ✅ Windows API Fixes
-#include <windows.h>  // Ensure Windows headers are included first
-
-// 🚀 Fix OpenCV `ACCESS_MASK` conflict
-#ifdef ACCESS_MASK
-#undef ACCESS_MASK
-#endif
-
-#ifdef byte  // Some compilers redefine `byte`
-#undef byte  
-#endif
-
-#include <opencv2/core.hpp>  
-#include <opencv2/imgproc.hpp>
-#include <opencv2/highgui.hpp>
-
-#include <chrono>
-using namespace std::chrono;
-
-// 🚀 Track eye closure duration
-static auto eyeCloseStart = steady_clock::now();
-static bool wasEyeOpen = true;
-
-// 🚀 Constructor: Loads Haar cascades properly
-FrameProcessor::FrameProcessor() {
-    std::cout << "Loading Haar cascades..." << std::endl;
-
-    // Load Haar cascade paths using CMake definitions
-    const std::string faceCascadePath = FACE_CASCADE_PATH;
-    const std::string eyesCascadePath = EYES_CASCADE_PATH;
-
-    if (!face_cascade.load(faceCascadePath)) {
-        throw std::runtime_error("❌ ERROR: Could not load face cascade! Check path: " + faceCascadePath);
-    }
-    std::cout << "✅ SUCCESS: Face cascade loaded!" << std::endl;
-
-    if (!eyes_cascade.load(eyesCascadePath)) {
-        throw std::runtime_error("❌ ERROR: Could not load eye cascade! Check path: " + eyesCascadePath);
-    }
-    std::cout << "✅ SUCCESS: Eye cascade loaded!" << std::endl;
-}
-
-// 🚀 Start function (Thread initialization)
-void FrameProcessor::start() {
-    if (isOn) return;  // Prevent multiple starts
-    isOn = true;
-    frameProcessorThread = std::thread(&FrameProcessor::threadLoop, this);
-}
-
-// 🚀 Stop function (Thread cleanup)
-void FrameProcessor::stop() {
-    isOn = false;
-    if (frameProcessorThread.joinable()) {
-        frameProcessorThread.join();
-    }
-    cv::destroyAllWindows();
-}
-
-// 🚀 Processes a single frame to detect faces and eyes
-int FrameProcessor::processFrame(cv::Mat& frame) {
-    if (frame.empty()) {
-        std::cerr << "❌ ERROR: Received an empty frame. Skipping processing." << std::endl;
-        return FACE_NOT_FOUND;
-    }
-
-    if (face_cascade.empty() || eyes_cascade.empty()) {
-        std::cerr << "❌ ERROR: Haar cascades are not loaded. Check paths!" << std::endl;
-        return FACE_NOT_FOUND;
-    }
-
-    bool eyeStatus = false;
-    std::vector<cv::Rect> faces;
-
-    face_cascade.detectMultiScale(frame, faces, 1.1, 2, 0 | cv::CASCADE_SCALE_IMAGE, cv::Size(100, 100));
-
-    static int noFaceCounter = 0;
-    if (faces.empty()) {
-        if (++noFaceCounter % 30 == 0) {  // Reduce excessive logging
-            std::cerr << "⚠️ WARNING: No face detected!" << std::endl;
-        }
-        return FACE_NOT_FOUND;
-    }
-    noFaceCounter = 0;
-
-    for (const auto& face : faces) { 
-        cv::rectangle(frame, face, cv::Scalar(255, 0, 0), 2);  // Draw face rectangle
-
-        cv::Mat faceROI = frame(face).clone();
-        std::vector<cv::Rect> eyes;
-        eyes_cascade.detectMultiScale(faceROI, eyes, 1.1, 4, 0 | cv::CASCADE_SCALE_IMAGE, cv::Size(30, 30));
-
-        for (const auto& eye : eyes) {
-            cv::rectangle(faceROI, eye, cv::Scalar(0, 255, 0), 2);  // Draw eye rectangles
-            cv::Mat eyeROI = faceROI(eye).clone();
-
-            if (blinkDetector.detect(eyeROI)) {
-                eyeStatus = true;
-            }
-        }
-    }
-
-    // 🚀 Show the processed frame
-    cv::imshow("Detection Debug", frame);
-    
-    // 🚀 Quit program when ESC is pressed
-    char key = (char)cv::waitKey(10);
-    if (key == 27) { // ESC key to quit
-        std::cout << "🛑 Exit command received! Stopping wake-o-matic..." << std::endl;
-        stop();  // Stop the processing thread
-        exit(0); // Clean exit
-    }
-
-    // 🚀 Track eye closure duration for microsleep detection
-    if (!eyeStatus) {
-        if (wasEyeOpen) {
-            eyeCloseStart = steady_clock::now(); // Start timing when eyes first close
-            wasEyeOpen = false;
-        }
-    
-        auto duration = duration_cast<milliseconds>(steady_clock::now() - eyeCloseStart).count();
-        
-        if (duration > 1500) { // 1.5 seconds threshold for microsleep
-            std::cout << "⚠️ Microsleep detected! Eyes are closed for too long!" << std::endl;
-            return EYES_CLOSED;
-        }
-    } else {
-        wasEyeOpen = true; // Reset when eyes are open
-    }
-
-    return EYES_OPEN; // ✅ Ensure function always returns a value
-}
-
-// 🚀 Thread loop for continuous frame processing
-void FrameProcessor::threadLoop() {
-    cv::VideoCapture cap(0);  // Open the default camera
-
-    if (!cap.isOpened()) {
-        std::cerr << "❌ ERROR: Could not open camera!" << std::endl;
-        return;
-    }
-
-    cv::Mat frame;
-    while (isOn) {
-        cap >> frame;  // Capture frame
-        if (frame.empty()) continue;
-
-        int status = processFrame(frame);  // Process the captured frame
-
-        if (status == EYES_CLOSED) {
-            std::cout << "⚠️ ALERT: Microsleep detected!" << std::endl;
-        }
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(30));  // Limit frame rate
-    }
-
-    cap.release();
-}
+#include "frameProcessor.h"
+#include "threadPlacement.h"
+#include "metrics.h"
+
+// ✅ Windows API Fixes
+#include <windows.h>  // Ensure Windows headers are included first
+
+// 🚀 Fix OpenCV `ACCESS_MASK` conflict
+#ifdef ACCESS_MASK
+#undef ACCESS_MASK
+#endif
+
+#ifdef byte  // Some compilers redefine `byte`
+#undef byte  
+#endif
+
+#include <opencv2/core.hpp>  
+#include <opencv2/imgproc.hpp>
+#include <opencv2/highgui.hpp>
+
+#include <chrono>
+using namespace std::chrono;
+
+// 🚀 Metrics of the detection path, registered once and updated with relaxed atomics
+static Gauge& queueDepth = Metrics::gauge("wakeomatic_frame_queue_depth", "Frames waiting in frame_queue");
+static Counter& queueDrops = Metrics::counter("wakeomatic_frames_dropped_total", "Frames dropped before detection", "reason=\"queue_full\"");
+static Counter& deadlineDrops = Metrics::counter("wakeomatic_frames_dropped_total", "Frames dropped before detection", "reason=\"late\"");
+static Counter& framesProcessed = Metrics::counter("wakeomatic_frames_processed_total", "Frames run through face and eye detection");
+static Counter& noFaceFrames = Metrics::counter("wakeomatic_frames_no_face_total", "Processed frames without a face");
+static Counter& eyeCacheHits = Metrics::counter("wakeomatic_eye_cache_total", "Eye crops looked up in the motion gate", "result=\"hit\"");
+static Counter& eyeCacheMisses = Metrics::counter("wakeomatic_eye_cache_total", "Eye crops looked up in the motion gate", "result=\"miss\"");
+static Counter& lowLightFrames = Metrics::counter("wakeomatic_low_light_frames_total", "Frames enhanced by the low-light stage before detection");
+static Gauge& frameBrightness = Metrics::gauge("wakeomatic_frame_brightness", "Mean grey level of the last processed frame");
+static Histogram& processingMs = Metrics::histogram("wakeomatic_processing_ms", "Face and eye detection time per frame", Metrics::latencyBucketsMs());
+static Histogram& detectionLatencyMs = Metrics::histogram("wakeomatic_detection_latency_ms", "Time from capture to the eye state result", Metrics::latencyBucketsMs());
+
+// 🚀 Camera callback: stamps the frame right after it was read and queues it for the processing thread.
+// It never waits for the processing thread, so a slow frame doesn't hold up the capture; the processing
+// thread drops the frames that waited too long
+void FrameQueueCallback::nextScene(const cv::Mat& frame) {
+    nextStampedScene(frame, clock->now(), 0);
+}
+
+void FrameQueueCallback::nextStampedScene(const cv::Mat& frame, steady_clock::time_point captured, uint64_t exportNumber) {
+    {
+        std::lock_guard<std::mutex> lock(frame_mutex);
+        if (frame_queue.size() >= MAX_QUEUE_SIZE) {
+            frame_queue.pop();  // Drop the oldest frame
+            droppedFrames++;
+            queueDrops.inc();
+        }
+
+        frame_queue.push({ frame, captured, exportNumber });
+        queueDepth.set(static_cast<double>(frame_queue.size()));
+    }
+    frame_cv.notify_one();
+}
+
+// 🚀 Constructor: Loads Haar cascades properly
+FrameProcessor::FrameProcessor(const DetectionParams& params)
+    : blinkDetector(params.blob), detection(params), lowLight(params.lowLight), eyeNet(params.eyeNetThreshold),
+      eyeCache(params.eyeCacheThreshold, params.eyeCacheRefresh) {
+    std::cout << "Loading Haar cascades..." << std::endl;
+
+    // Load Haar cascade paths using CMake definitions
+    const std::string faceCascadePath = FACE_CASCADE_PATH;
+    const std::string eyesCascadePath = EYES_CASCADE_PATH;
+
+    if (!face_cascade.load(faceCascadePath)) {
+        throw std::runtime_error("❌ ERROR: Could not load face cascade! Check path: " + faceCascadePath);
+    }
+    std::cout << "✅ SUCCESS: Face cascade loaded!" << std::endl;
+
+    if (!eyes_cascade.load(eyesCascadePath)) {
+        throw std::runtime_error("❌ ERROR: Could not load eye cascade! Check path: " + eyesCascadePath);
+    }
+    std::cout << "✅ SUCCESS: Eye cascade loaded!" << std::endl;
+    std::cout << "✅ Low-light stage uses " << LowLightKernel::name(LowLightKernel::active()) << " kernels" << std::endl;
+}
+
+// 🚀 Tuned parameters; the blob detector is rebuilt, the cascades only take them per call
+void FrameProcessor::setDetectionParams(const DetectionParams& params) {
+    detection = params;
+    blinkDetector = EyeStatus(params.blob);
+    eyeNet.threshold = params.eyeNetThreshold;
+    eyeCache.configure(params.eyeCacheThreshold, params.eyeCacheRefresh);
+    eyeCache.clear();  // Results of the old classifier settings don't count
+    lowLight.setParams(params.lowLight);
+}
+
+// 🚀 Start function (Thread initialization)
+void FrameProcessor::start() {
+    if (isOn) return;  // Prevent multiple starts
+    isOn = true;
+    frameProcessorThread = std::thread(&FrameProcessor::threadLoop, this);
+}
+
+// 🚀 Start with warm-up: the processing thread runs the detection on the frame before taking camera frames
+void FrameProcessor::start(const cv::Mat& frame) {
+    if (isOn) return;
+    warmUpFrame = frame;
+    warmed = std::promise<void>();
+    warmedFuture = warmed.get_future().share();
+    if (frame.empty()) {
+        warmed.set_value();  // Nothing to warm up with
+    }
+    start();
+}
+
+bool FrameProcessor::waitUntilWarm(std::chrono::milliseconds timeout) const {
+    return !warmedFuture.valid() || std::future_status::ready == warmedFuture.wait_for(timeout);
+}
+
+// 🚀 Warm-up on the processing thread, so OpenCV's worker threads are spawned with the detector placement
+void FrameProcessor::warmUp() {
+    auto start = steady_clock::now();
+    bool display = debugDisplay;
+    showDebug = false;
+
+    cv::Mat frame = warmUpFrame.clone();
+    processFrame(frame);
+    cv::Mat dark;
+    warmUpFrame.convertTo(dark, CV_8U, 0.25);  // Also warms the low-light stage
+    processFrame(dark);
+
+    // Nothing of the warm-up frames may leak into the decisions
+    resetTracking();
+    lowLight.setParams(detection.lowLight);
+    showDebug = display;
+    warmUpFrame.release();
+    warmUpDuration = duration<double, std::milli>(steady_clock::now() - start).count();
+    warmed.set_value();
+}
+
+// 🚀 Stop function (Thread cleanup)
+void FrameProcessor::stop() {
+    isOn = false;
+    if (frameProcessorThread.joinable()) {
+        frameProcessorThread.join();
+    }
+    cv::destroyAllWindows();
+}
+
+// 🚀 Processes a single frame to detect faces and eyes
+int FrameProcessor::processFrame(cv::Mat& frame) {
+    return processFrame(frame, clock->now());
+}
+
+// 🚀 Processes a single frame captured at `captured` (real or simulated time)
+int FrameProcessor::processFrame(cv::Mat& frame, steady_clock::time_point captured) {
+    lastSample.status = FACE_NOT_FOUND;
+    lastSample.openConfidence = 0.0f;
+    lastSample.timestamp = captured;
+    processingStart = steady_clock::now();  // Processing cost is always measured in real time
+    lastRecord = TelemetryRecord();
+
+    if (frame.empty()) {
+        std::cerr << "❌ ERROR: Received an empty frame. Skipping processing." << std::endl;
+        return finishRecord(FACE_NOT_FOUND);
+    }
+
+    if (face_cascade.empty() || eyes_cascade.empty()) {
+        std::cerr << "❌ ERROR: Haar cascades are not loaded. Check paths!" << std::endl;
+        return finishRecord(FACE_NOT_FOUND);
+    }
+
+    bool eyeStatus = false;
+    int eyesFound = 0;
+    int eyesOpen = 0;
+    int keypoints = 0;
+    float openConfidenceSum = 0.0f;
+    auto countEye = [&](const EyeCache::Entry& entry) {
+        openConfidenceSum += entry.confidence;
+        keypoints += entry.keypoints;
+        if (entry.open) {
+            eyeStatus = true;
+            eyesOpen++;
+        }
+    };
+
+    // 🚀 Dark or flat (night, IR) frames: the cascades and the eye classifier work on the denoised, equalised grey frame
+    const cv::Mat& detectOn = lowLight.process(frame, enhanced) ? enhanced : frame;
+    if (lowLight.isActive()) {
+        lowLightFrames.inc();
+    }
+    frameBrightness.set(lowLight.lastStats().mean);
+
+    face_cascade.detectMultiScale(detectOn, faces, detection.face.scaleFactor, detection.face.minNeighbors, 0 | cv::CASCADE_SCALE_IMAGE,
+        cv::Size(detection.face.minSize, detection.face.minSize));
+
+    if (faces.empty()) {
+        if (++noFaceCounter % 30 == 0) {  // Reduce excessive logging
+            std::cerr << "⚠️ WARNING: No face detected!" << std::endl;
+        }
+        return finishRecord(FACE_NOT_FOUND);
+    }
+    noFaceCounter = 0;
+
+    lastRecord.faces = static_cast<uint8_t>(std::min<size_t>(faces.size(), 255));
+    lastRecord.faceX = faces[0].x;
+    lastRecord.faceY = faces[0].y;
+    lastRecord.faceWidth = faces[0].width;
+    lastRecord.faceHeight = faces[0].height;
+
+    debugEyes.clear();
+    for (const auto& face : faces) { 
+        // Regions are copied into the frame arena instead of cloned, no heap allocation per face and eye
+        cv::Mat faceROI = arena.mat(face.height, face.width, detectOn.type());
+        detectOn(face).copyTo(faceROI);
+        eyes_cascade.detectMultiScale(faceROI, eyes, detection.eyes.scaleFactor, detection.eyes.minNeighbors, 0 | cv::CASCADE_SCALE_IMAGE,
+            cv::Size(detection.eyes.minSize, detection.eyes.minSize));
+
+        eyeCrops.clear();
+        eyeSlots.clear();
+        for (const auto& eye : eyes) {
+            cv::Mat eyeROI = arena.mat(eye.height, eye.width, faceROI.type());
+            faceROI(eye).copyTo(eyeROI);
+            if (showDebug) {
+                debugEyes.push_back(eye + face.tl());
+            }
+            eyesFound++;
+
+            // 🚀 Motion gate: an eye whose crop hasn't changed since it was last classified keeps its result
+            EyeCache::Entry entry;
+            size_t slot;
+            if (eyeCache.lookup(eyeROI, eye + face.tl(), entry, slot)) {
+                eyeCacheHits.inc();
+                countEye(entry);
+                continue;
+            }
+            if (detection.eyeCacheThreshold > 0) {
+                eyeCacheMisses.inc();
+            }
+
+            if (detection.useEyeNet) {
+                eyeCrops.push_back(eyeROI);
+                eyeSlots.push_back(slot);
+                continue;
+            }
+            // The blob detector only gives a yes or no per eye
+            entry.open = blinkDetector.detect(eyeROI);
+            entry.confidence = entry.open ? 1.0f : 0.0f;
+            entry.keypoints = blinkDetector.lastKeypointCount();
+            eyeCache.store(slot, entry);
+            countEye(entry);
+        }
+
+        // Both eyes of the face in one inference call
+        if (!eyeCrops.empty()) {
+            eyeNet.classify(eyeCrops, eyeResults);
+            for (size_t i = 0; i < eyeResults.size(); i++) {
+                EyeCache::Entry entry;
+                entry.open = eyeResults[i].open;
+                entry.confidence = eyeResults[i].confidence;
+                eyeCache.store(eyeSlots[i], entry);
+                countEye(entry);
+            }
+        }
+    }
+
+    // 🚀 Per-frame evidence for the sequential decision engine (no eyes found counts as closed)
+    lastSample.status = eyeStatus ? EYES_OPEN : EYES_CLOSED;
+    lastSample.openConfidence = eyesFound > 0 ? openConfidenceSum / eyesFound : 0.0f;
+
+    lastRecord.eyes = static_cast<uint8_t>(std::min(eyesFound, 255));
+    lastRecord.eyesOpen = static_cast<uint8_t>(std::min(eyesOpen, 255));
+    lastRecord.keypoints = static_cast<uint8_t>(std::min(keypoints, 255));
+    lastRecord.confidence = static_cast<uint8_t>(lastSample.openConfidence * 255.0f + 0.5f);
+
+    // 🚀 Show the processed frame; the rectangles go on a copy, the frame may be a driver buffer that is read in place
+    char key = 0;
+    if (showDebug) {
+        frame.copyTo(debugFrame);
+        for (const auto& face : faces) {
+            cv::rectangle(debugFrame, face, cv::Scalar(255, 0, 0), 2);  // Draw face rectangle
+        }
+        for (const auto& eye : debugEyes) {
+            cv::rectangle(debugFrame, eye, cv::Scalar(0, 255, 0), 2);  // Draw eye rectangles
+        }
+        cv::imshow("Detection Debug", debugFrame);
+        key = (char)cv::waitKey(10);
+    }
+
+    // 🚀 Quit program when ESC is pressed
+    if (key == 27) { // ESC key to quit
+        std::cout << "🛑 Exit command received! Stopping wake-o-matic..." << std::endl;
+        stop();  // Stop the processing thread
+        exit(0); // Clean exit
+    }
+
+    // 🚀 Track eye closure duration for microsleep detection
+    if (!eyeStatus) {
+        if (wasEyeOpen) {
+            eyeCloseStart = captured; // Start timing when eyes first close
+            wasEyeOpen = false;
+        }
+    
+        auto duration = duration_cast<milliseconds>(captured - eyeCloseStart).count();
+        
+        if (duration > 1500) { // 1.5 seconds threshold for microsleep
+            std::cout << "⚠️ Microsleep detected! Eyes are closed for too long!" << std::endl;
+            return finishRecord(EYES_CLOSED);
+        }
+    } else {
+        wasEyeOpen = true; // Reset when eyes are open
+    }
+
+    return finishRecord(EYES_OPEN); // ✅ Ensure function always returns a value
+}
+
+// 🚀 Completes the telemetry record of the frame with the result and the processing time, ends the frame
+int FrameProcessor::finishRecord(int status) {
+    arena.reset();  // Scratch images of the frame are released in bulk
+    eyeCache.endFrame();  // Eyes that weren't seen in this frame are forgotten
+    lastRecord.rawStatus = static_cast<int8_t>(lastSample.status);
+    lastRecord.gatedStatus = static_cast<int8_t>(status);
+    lastRecord.processingUs = static_cast<uint32_t>(duration_cast<microseconds>(steady_clock::now() - processingStart).count());
+    framesProcessed.inc();
+    processingMs.observe(lastRecord.processingUs / 1000.0);
+    if (FACE_NOT_FOUND == lastSample.status) {
+        noFaceFrames.inc();
+    }
+    return status;
+}
+
+// 🚀 Thread loop: takes frames from `frame_queue` and pushes the per-frame result to `status_channel`
+void FrameProcessor::threadLoop() {
+    ThreadPlacement::Scope placement(ThreadPlacement::DETECTOR);
+    if (!warmUpFrame.empty()) {
+        warmUp();
+    }
+    while (isOn) {
+        TimedFrame next;
+        bool late = false;
+        {
+            std::unique_lock<std::mutex> lock(frame_mutex);
+            if (!frame_cv.wait_for(lock, std::chrono::milliseconds(100), [] { return !frame_queue.empty(); })) {
+                continue;  // Re-check isOn regularly
+            }
+
+            // Frames that missed the queue deadline are dropped when a newer one is waiting,
+            // the newest one is kept but processed in downgraded mode
+            next = frame_queue.front();
+            frame_queue.pop();
+            late = Deadline::expired(Deadline::QUEUE, next.captured, clock->now());
+            while (late && !frame_queue.empty()) {
+                lateDrops++;
+                deadlineDrops.inc();
+                next = frame_queue.front();
+                frame_queue.pop();
+                late = Deadline::expired(Deadline::QUEUE, next.captured, clock->now());
+            }
+            queueDepth.set(static_cast<double>(frame_queue.size()));
+            processed = true;  // For callbacks that hand over one frame at a time (the tester's camera callback)
+        }
+
+        // A frame this old can no longer lead to a timely decision
+        if (Deadline::expired(Deadline::DETECT, next.captured, clock->now())) {
+            lateDrops++;
+            deadlineDrops.inc();
+            continue;
+        }
+
+        showDebug = debugDisplay && !late;
+        int status = processFrame(next.frame, next.captured);
+        detectionLatencyMs.observe(duration<double, std::milli>(clock->now() - next.captured).count());
+
+        if (nullptr != telemetry) {
+            lastRecord.timestampUs = duration_cast<microseconds>(next.captured.time_since_epoch()).count();
+            telemetry->log(lastRecord);
+        }
+        if (nullptr != frameExport) {
+            frameExport->publishResult(next.exportNumber, lastSample, lastRecord);
+        }
+
+        if (status == EYES_CLOSED) {
+            std::cout << "⚠️ ALERT: Microsleep detected!" << std::endl;
+        }
+
+        status_channel.push(lastSample);  // Never blocks, the decision side drains in batches
+    }
+}
@@ -1,86 +1,239 @@
-#pragma once
-
-// ✅ Prevent Windows API conflicts BEFORE including <windows.h>
-#ifndef WIN32_LEAN_AND_MEAN
-#define WIN32_LEAN_AND_MEAN  // Exclude rarely-used Windows headers
-#endif  
-
-#ifndef NOMINMAX
-#define NOMINMAX  // Prevent Windows.h from overriding min/max functions
-#endif  
-
-#include <windows.h>  // ✅ Must be included FIRST before OpenCV
-
-// 🚀 Fix OpenCV `ACCESS_MASK` conflict
-#ifdef ACCESS_MASK
-#undef ACCESS_MASK
-#endif
-
-#ifdef byte  // Some compilers redefine `byte`
-#undef byte  
-#endif
-
-// ✅ Include OpenCV libraries AFTER Windows
-#include <opencv2/opencv.hpp>
-#include <opencv2/highgui.hpp>
-#include <opencv2/imgproc.hpp>
-#include <opencv2/objdetect.hpp>
-
-#include <iostream>
-#include <queue>
-#include <condition_variable>
-#include <mutex>
-#include <thread>  // ✅ Needed for threading support
-
-// ✅ Include dependent headers
-#include "eyeStatus.h"
-#include "camera.h"  // External camera handling
-
-// 🚀 Define return values for sleep detection
-enum SleepStatus {
-    FACE_NOT_FOUND = -1,
-    EYES_CLOSED = 0,
-    EYES_OPEN = 1
-};
-
-// ✅ Declare shared resources (Ensure they are **defined** in `frameProcessor.cpp`)
-extern std::queue<cv::Mat> frame_queue;
-extern std::mutex frame_mutex;
-extern std::condition_variable frame_cv;
-extern bool processed;
-
-extern std::queue<int> status_queue;
-extern std::mutex status_mutex;
-extern std::condition_variable status_cv;
-extern bool loading;
-
-class FrameProcessor
-{
-public:
-    /// Constructor
-    FrameProcessor();
-
-    /// Starts the frame processing in a separate thread
-    void start();
-
-    /// Stops the frame processing thread
-    void stop();
-    
-    /// Processes a single frame to detect faces and eyes
-    int processFrame(cv::Mat& frame);
-
-private:
-
-    /// Main loop for frame processing thread
-    void threadLoop();
-
-    bool isOn = false;
-    std::thread frameProcessorThread;
-
-    // Cascade classifiers for face and eye detection
-    cv::CascadeClassifier face_cascade;
-    cv::CascadeClassifier eyes_cascade;
-
-    // ✅ Ensure `EyeStatus` is properly defined
-    EyeStatus blinkDetector;
-};
+#pragma once
+
+// ✅ Prevent Windows API conflicts BEFORE including <windows.h>
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN  // Exclude rarely-used Windows headers
+#endif  
+
+#ifndef NOMINMAX
+#define NOMINMAX  // Prevent Windows.h from overriding min/max functions
+#endif  
+
+#include <windows.h>  // ✅ Must be included FIRST before OpenCV
+
+// 🚀 Fix OpenCV `ACCESS_MASK` conflict
+#ifdef ACCESS_MASK
+#undef ACCESS_MASK
+#endif
+
+#ifdef byte  // Some compilers redefine `byte`
+#undef byte  
+#endif
+
+// ✅ Include OpenCV libraries AFTER Windows
+#include <opencv2/opencv.hpp>
+#include <opencv2/highgui.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/objdetect.hpp>
+
+#include <iostream>
+#include <queue>
+#include <condition_variable>
+#include <mutex>
+#include <thread>  // ✅ Needed for threading support
+#include <atomic>
+#include <future>
+
+// ✅ Include dependent headers
+#include "eyeStatus.h"
+#include "eyeNet.h"
+#include "eyeCache.h"
+#include "lowLight.h"
+#include "detectionParams.h"
+#include "sleepDetect.h"
+#include "deadline.h"
+#include "telemetry.h"
+#include "clock.h"
+#include "frameExport.h"
+#include "frameArena.h"
+#include "statusChannel.h"
+#include "camera.h"  // External camera handling
+
+// 🚀 Define return values for sleep detection
+enum SleepStatus {
+    FACE_NOT_FOUND = -1,
+    EYES_CLOSED = 0,
+    EYES_OPEN = 1
+};
+
+/// @brief A camera frame together with its capture time, used for per-frame deadlines
+struct TimedFrame {
+    cv::Mat frame;
+    std::chrono::steady_clock::time_point captured;
+    /// Number of the frame in the shared-memory export, its result is published under it (0 if not exported)
+    uint64_t exportNumber = 0;
+};
+
+// ✅ Declare shared resources (Ensure they are **defined** in `frameProcessor.cpp`)
+extern std::queue<TimedFrame> frame_queue;
+extern std::mutex frame_mutex;
+extern std::condition_variable frame_cv;
+extern bool processed;
+
+/// Eye-state samples from the processing thread to the decision side
+extern StatusChannel status_channel;
+
+/// @brief Camera callback that stamps every frame with its capture time and hands it to the processing thread through `frame_queue`
+struct FrameQueueCallback : Camera::SceneCallback {
+    /// Frames that may wait in `frame_queue`, the oldest one is dropped beyond that (about the queue deadline at 30 fps)
+    static const size_t MAX_QUEUE_SIZE = 3;
+
+    /// Clock that stamps the frames (the steady clock by default)
+    Clock* clock = &Clock::steady();
+
+    /// Queues the frame without waiting for the processing thread
+    void nextScene(const cv::Mat& frame) override;
+
+    /// Queues a frame stamped earlier in the callback chain, keeping its capture time and export number
+    void nextStampedScene(const cv::Mat& frame, std::chrono::steady_clock::time_point captured, uint64_t exportNumber) override;
+
+    /// Frames dropped because the queue was full
+    uint64_t dropped() const { return droppedFrames; }
+
+private:
+    std::atomic<uint64_t> droppedFrames{0};
+};
+
+class FrameProcessor
+{
+public:
+    /// Constructor, loads the cascades; detection uses the given parameters (the defaults unless tuned)
+    explicit FrameProcessor(const DetectionParams& params = DetectionParams());
+
+    /// Starts the frame processing in a separate thread
+    void start();
+
+    /**
+     * Starts the frame processing thread, which first runs the detection on `warmUpFrame` (as it is and darkened)
+     * so OpenCV's lazy initialisation, its thread pool and cold caches are paid for before the first camera frame.
+     * The frame must stay valid until @see waitUntilWarm() returns.
+     */
+    void start(const cv::Mat& warmUpFrame);
+
+    /// Waits until the warm-up of @see start(const cv::Mat&) has finished, false on timeout
+    bool waitUntilWarm(std::chrono::milliseconds timeout) const;
+
+    /// Time the warm-up took in ms (0 without warm-up)
+    double warmUpMs() const { return warmUpDuration; }
+
+    /// Stops the frame processing thread
+    void stop();
+    
+    /// Processes a single frame to detect faces and eyes, taken now by the processor's clock
+    int processFrame(cv::Mat& frame);
+
+    /// Processes a single frame captured at the given time; the microsleep gate only depends on capture times
+    int processFrame(cv::Mat& frame, std::chrono::steady_clock::time_point captured);
+
+    /// Raw (not time-gated) eye state and open-eye confidence of the last processed frame
+    const EyeSample& lastEyeSample() const { return lastSample; }
+
+    /// True while the processing thread is running
+    bool isRunning() const { return isOn; }
+
+    /// Frames the processing thread dropped because they missed their queue or detection deadline
+    uint64_t droppedFrames() const { return lateDrops; }
+
+    /// Scratch memory of the detection path, for benchmarks
+    const FrameArena& frameArena() const { return arena; }
+
+    /// Everything found in the last processed frame, for the telemetry log
+    const TelemetryRecord& lastTelemetry() const { return lastRecord; }
+
+    /// Logs a telemetry record of every frame processed by the thread (nullptr to disable)
+    void setTelemetry(TelemetryWriter* writer) { telemetry = writer; }
+
+    /// Publishes the result of every frame processed by the thread to shared memory (nullptr to disable)
+    void setFrameExport(FrameExporter* exporter) { frameExport = exporter; }
+
+    /// Enables or disables the debug window (disable for headless runs and benchmarks)
+    void setDebugDisplay(bool enabled) { debugDisplay = enabled; showDebug = enabled; }
+    bool debugDisplayEnabled() const { return debugDisplay; }
+
+    /// Clock used for deadlines and for frames processed without a capture time (the steady clock by default)
+    void setClock(Clock* newClock) { clock = newClock; }
+    Clock* getClock() const { return clock; }
+
+    /// Changes the cascade and blob parameters, e.g. between the runs of a parameter sweep
+    void setDetectionParams(const DetectionParams& params);
+    const DetectionParams& detectionParams() const { return detection; }
+
+    /// Motion gate that reuses the eye results while the eye crops don't change (hit rate for benchmarks and the soak test)
+    const EyeCache& eyeResultCache() const { return eyeCache; }
+
+    /// Contrast normalisation of dark and IR frames ahead of the cascades (whether it is on, frame statistics)
+    const LowLightEnhancer& lowLightStage() const { return lowLight; }
+
+    /// Forgets the eye closure in progress and the cached eye results, e.g. before processing an unrelated recording
+    void resetTracking() { wasEyeOpen = true; noFaceCounter = 0; eyeCache.clear(); }
+
+private:
+
+    /// Main loop for frame processing thread
+    void threadLoop();
+
+    /// Detection on the warm-up frame, then forgets everything it tracked
+    void warmUp();
+
+    /// Completes the telemetry record of the current frame, resets the frame arena and returns the status
+    int finishRecord(int status);
+
+    std::atomic<bool> isOn{false};  // Read by isRunning() on other threads
+    std::thread frameProcessorThread;
+
+    // Warm-up before the first camera frame, run by the processing thread
+    cv::Mat warmUpFrame;
+    std::promise<void> warmed;
+    std::shared_future<void> warmedFuture;
+    double warmUpDuration = 0.0;
+
+    // Debug window is skipped when disabled and for frames that are already late (downgraded work)
+    bool debugDisplay = true;
+    bool showDebug = true;
+    // Overlays are drawn on this copy, never on the processed frame
+    cv::Mat debugFrame;
+    std::vector<cv::Rect> debugEyes;
+
+    // Cascade classifiers for face and eye detection
+    cv::CascadeClassifier face_cascade;
+    cv::CascadeClassifier eyes_cascade;
+
+    // ✅ Ensure `EyeStatus` is properly defined
+    EyeStatus blinkDetector;
+    DetectionParams detection;
+
+    // Dark or flat frames are denoised and equalised before the cascades run on them
+    LowLightEnhancer lowLight;
+    cv::Mat enhanced;
+
+    // Optional int8 net for the eye state; the eyes of a face are classified in one batch
+    EyeNet eyeNet;
+    std::vector<cv::Mat> eyeCrops;
+    std::vector<EyeNet::Result> eyeResults;
+    std::vector<size_t> eyeSlots;
+
+    // Last result of every eye, reused while its crop is unchanged
+    EyeCache eyeCache;
+
+    // Per-frame scratch: region images live in the arena, detection results reuse the capacity of these vectors
+    FrameArena arena;
+    std::vector<cv::Rect> faces;
+    std::vector<cv::Rect> eyes;
+
+    // 🚀 Eye closure tracking for the microsleep threshold, per instance so several processors can run in parallel
+    std::chrono::steady_clock::time_point eyeCloseStart;
+    bool wasEyeOpen = true;
+    int noFaceCounter = 0;
+
+    // Result of the last processed frame, pushed to `status_channel` by the processing thread
+    EyeSample lastSample;
+
+    // Telemetry of the last processed frame and where it is logged
+    TelemetryRecord lastRecord;
+    std::chrono::steady_clock::time_point processingStart;
+    TelemetryWriter* telemetry = nullptr;
+    FrameExporter* frameExport = nullptr;
+
+    Clock* clock = &Clock::steady();
+    std::atomic<uint64_t> lateDrops{0};
+};
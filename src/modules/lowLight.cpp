@@ -0,0 +1,502 @@
+#include "lowLight.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+	#define LOWLIGHT_X86
+	#include <immintrin.h>
+	#if defined(_MSC_VER) && !defined(__clang__)
+		#include <intrin.h>
+		#define LOWLIGHT_TARGET(isa)  // MSVC compiles every intrinsic without flags
+	#else
+		#define LOWLIGHT_TARGET(isa) __attribute__((target(isa)))
+	#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#define LOWLIGHT_NEON
+	#include <arm_neon.h>
+	#if defined(__linux__) && defined(__arm__)
+		#include <sys/auxv.h>
+		#include <asm/hwcap.h>
+	#endif
+#endif
+
+using namespace LowLightKernel;
+
+// ---------------------------------------------------------------------------------------------------------------
+// Scalar kernels, the reference for all others (and the tails of their rows)
+// ---------------------------------------------------------------------------------------------------------------
+
+static inline void blurHorizontalScalar(const uint16_t* sums, uint8_t* out, int from, int to, int width) {
+	for (int x = from; x < to; x++) {
+		int left = sums[std::max(x - 1, 0)];
+		int right = sums[std::min(x + 1, width - 1)];
+		out[x] = static_cast<uint8_t>((left + 2 * sums[x] + right + 8) >> 4);
+	}
+}
+
+static void blurRowScalar(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint16_t* sums, uint8_t* out, int width) {
+	for (int x = 0; x < width; x++) {
+		sums[x] = static_cast<uint16_t>(above[x] + 2 * row[x] + below[x]);
+	}
+	blurHorizontalScalar(sums, out, 0, width, width);
+}
+
+// Both tile rows blended horizontally, then vertically, in 8.8 fixed point (every step fits in 16 bits)
+static inline uint8_t blendPixel(uint8_t v, const uint8_t* top, const uint8_t* bottom, int32_t o0, int32_t o1, int wx, int wy) {
+	int upper = (top[o0 + v] * (256 - wx) + top[o1 + v] * wx + 128) >> 8;
+	int lower = (bottom[o0 + v] * (256 - wx) + bottom[o1 + v] * wx + 128) >> 8;
+	return static_cast<uint8_t>((upper * (256 - wy) + lower * wy + 128) >> 8);
+}
+
+static void blendRowScalar(const uint8_t* src, uint8_t* dst, int width, const uint8_t* top, const uint8_t* bottom,
+	const int32_t* offset0, const int32_t* offset1, const uint16_t* weightX, int weightY) {
+	for (int x = 0; x < width; x++) {
+		dst[x] = blendPixel(src[x], top, bottom, offset0[x], offset1[x], weightX[x], weightY);
+	}
+}
+
+// ---------------------------------------------------------------------------------------------------------------
+// x86: SSE4.1 and AVX2, compiled for the target with function attributes and picked by CPUID
+// ---------------------------------------------------------------------------------------------------------------
+
+#if defined(LOWLIGHT_X86)
+
+LOWLIGHT_TARGET("sse4.1")
+static void blurRowSse41(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint16_t* sums, uint8_t* out, int width) {
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		__m128i a = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(above + x)));
+		__m128i r = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + x)));
+		__m128i b = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(below + x)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(sums + x), _mm_add_epi16(_mm_add_epi16(a, b), _mm_slli_epi16(r, 1)));
+	}
+	for (; x < width; x++) {
+		sums[x] = static_cast<uint16_t>(above[x] + 2 * row[x] + below[x]);
+	}
+
+	const __m128i round = _mm_set1_epi16(8);
+	blurHorizontalScalar(sums, out, 0, 1, width);
+	for (x = 1; x + 9 <= width; x += 8) {
+		__m128i left = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sums + x - 1));
+		__m128i centre = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sums + x));
+		__m128i right = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sums + x + 1));
+		__m128i sum = _mm_add_epi16(_mm_add_epi16(left, right), _mm_add_epi16(_mm_slli_epi16(centre, 1), round));
+		sum = _mm_srli_epi16(sum, 4);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(sum, sum));
+	}
+	blurHorizontalScalar(sums, out, x, width, width);
+}
+
+LOWLIGHT_TARGET("sse4.1")
+static void blendRowSse41(const uint8_t* src, uint8_t* dst, int width, const uint8_t* top, const uint8_t* bottom,
+	const int32_t* offset0, const int32_t* offset1, const uint16_t* weightX, int weightY) {
+	alignas(16) uint16_t topLeft[8], topRight[8], bottomLeft[8], bottomRight[8];
+	const __m128i full = _mm_set1_epi16(256);
+	const __m128i round = _mm_set1_epi16(128);
+	const __m128i wy = _mm_set1_epi16(static_cast<short>(weightY));
+	const __m128i wyInv = _mm_sub_epi16(full, wy);
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		// No byte gather before AVX2, the table lookups stay scalar
+		for (int i = 0; i < 8; i++) {
+			uint8_t v = src[x + i];
+			topLeft[i] = top[offset0[x + i] + v];
+			topRight[i] = top[offset1[x + i] + v];
+			bottomLeft[i] = bottom[offset0[x + i] + v];
+			bottomRight[i] = bottom[offset1[x + i] + v];
+		}
+		__m128i wx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weightX + x));
+		__m128i wxInv = _mm_sub_epi16(full, wx);
+		__m128i upper = _mm_add_epi16(_mm_mullo_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(topLeft)), wxInv),
+			_mm_mullo_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(topRight)), wx));
+		__m128i lower = _mm_add_epi16(_mm_mullo_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(bottomLeft)), wxInv),
+			_mm_mullo_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(bottomRight)), wx));
+		upper = _mm_srli_epi16(_mm_add_epi16(upper, round), 8);
+		lower = _mm_srli_epi16(_mm_add_epi16(lower, round), 8);
+		__m128i result = _mm_add_epi16(_mm_mullo_epi16(upper, wyInv), _mm_mullo_epi16(lower, wy));
+		result = _mm_srli_epi16(_mm_add_epi16(result, round), 8);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(result, result));
+	}
+	blendRowScalar(src + x, dst + x, width - x, top, bottom, offset0 + x, offset1 + x, weightX + x, weightY);
+}
+
+LOWLIGHT_TARGET("avx2")
+static void blurRowAvx2(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint16_t* sums, uint8_t* out, int width) {
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		__m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(above + x)));
+		__m256i r = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x)));
+		__m256i b = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(below + x)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(sums + x), _mm256_add_epi16(_mm256_add_epi16(a, b), _mm256_slli_epi16(r, 1)));
+	}
+	for (; x < width; x++) {
+		sums[x] = static_cast<uint16_t>(above[x] + 2 * row[x] + below[x]);
+	}
+
+	const __m256i round = _mm256_set1_epi16(8);
+	blurHorizontalScalar(sums, out, 0, 1, width);
+	for (x = 1; x + 17 <= width; x += 16) {
+		__m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sums + x - 1));
+		__m256i centre = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sums + x));
+		__m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sums + x + 1));
+		__m256i sum = _mm256_add_epi16(_mm256_add_epi16(left, right), _mm256_add_epi16(_mm256_slli_epi16(centre, 1), round));
+		sum = _mm256_srli_epi16(sum, 4);
+		// Pack across the two 128-bit lanes
+		__m128i packed = _mm_packus_epi16(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), packed);
+	}
+	blurHorizontalScalar(sums, out, x, width, width);
+}
+
+LOWLIGHT_TARGET("avx2")
+static void blendRowAvx2(const uint8_t* src, uint8_t* dst, int width, const uint8_t* top, const uint8_t* bottom,
+	const int32_t* offset0, const int32_t* offset1, const uint16_t* weightX, int weightY) {
+	const __m256i byteMask = _mm256_set1_epi32(0xFF);
+	const __m256i full = _mm256_set1_epi32(256);
+	const __m256i round = _mm256_set1_epi32(128);
+	const __m256i wy = _mm256_set1_epi32(weightY);
+	const __m256i wyInv = _mm256_sub_epi32(full, wy);
+	const int* topBase = reinterpret_cast<const int*>(top);
+	const int* bottomBase = reinterpret_cast<const int*>(bottom);
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		// Table lookups with 32-bit gathers at byte offsets, the tables are padded for the 3 bytes read past the end
+		__m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + x)));
+		__m256i left = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(offset0 + x)), v);
+		__m256i right = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(offset1 + x)), v);
+		__m256i topLeft = _mm256_and_si256(_mm256_i32gather_epi32(topBase, left, 1), byteMask);
+		__m256i topRight = _mm256_and_si256(_mm256_i32gather_epi32(topBase, right, 1), byteMask);
+		__m256i bottomLeft = _mm256_and_si256(_mm256_i32gather_epi32(bottomBase, left, 1), byteMask);
+		__m256i bottomRight = _mm256_and_si256(_mm256_i32gather_epi32(bottomBase, right, 1), byteMask);
+
+		__m256i wx = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(weightX + x)));
+		__m256i wxInv = _mm256_sub_epi32(full, wx);
+		__m256i upper = _mm256_add_epi32(_mm256_mullo_epi32(topLeft, wxInv), _mm256_mullo_epi32(topRight, wx));
+		__m256i lower = _mm256_add_epi32(_mm256_mullo_epi32(bottomLeft, wxInv), _mm256_mullo_epi32(bottomRight, wx));
+		upper = _mm256_srli_epi32(_mm256_add_epi32(upper, round), 8);
+		lower = _mm256_srli_epi32(_mm256_add_epi32(lower, round), 8);
+		__m256i result = _mm256_add_epi32(_mm256_mullo_epi32(upper, wyInv), _mm256_mullo_epi32(lower, wy));
+		result = _mm256_srli_epi32(_mm256_add_epi32(result, round), 8);
+
+		__m128i words = _mm_packus_epi32(_mm256_castsi256_si128(result), _mm256_extracti128_si256(result, 1));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(words, words));
+	}
+	blendRowScalar(src + x, dst + x, width - x, top, bottom, offset0 + x, offset1 + x, weightX + x, weightY);
+}
+
+static Isa detectX86() {
+	#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 0);
+	int highest = info[0];
+	__cpuid(info, 1);
+	bool sse41 = (info[2] & (1 << 19)) != 0;
+	bool osAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+	bool avx2 = false;
+	if (highest >= 7 && osAvx) {
+		__cpuidex(info, 7, 0);
+		avx2 = (info[1] & (1 << 5)) != 0;
+	}
+	#else
+	__builtin_cpu_init();
+	bool sse41 = __builtin_cpu_supports("sse4.1");
+	bool avx2 = __builtin_cpu_supports("avx2");
+	#endif
+	return avx2 ? AVX2 : sse41 ? SSE41 : SCALAR;
+}
+
+#endif
+
+// ---------------------------------------------------------------------------------------------------------------
+// ARM: NEON
+// ---------------------------------------------------------------------------------------------------------------
+
+#if defined(LOWLIGHT_NEON)
+
+static void blurRowNeon(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint16_t* sums, uint8_t* out, int width) {
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		uint16x8_t sum = vaddl_u8(vld1_u8(above + x), vld1_u8(below + x));
+		sum = vaddq_u16(sum, vshll_n_u8(vld1_u8(row + x), 1));
+		vst1q_u16(sums + x, sum);
+	}
+	for (; x < width; x++) {
+		sums[x] = static_cast<uint16_t>(above[x] + 2 * row[x] + below[x]);
+	}
+
+	blurHorizontalScalar(sums, out, 0, 1, width);
+	for (x = 1; x + 9 <= width; x += 8) {
+		uint16x8_t sum = vaddq_u16(vld1q_u16(sums + x - 1), vld1q_u16(sums + x + 1));
+		sum = vaddq_u16(sum, vshlq_n_u16(vld1q_u16(sums + x), 1));
+		vst1_u8(out + x, vrshrn_n_u16(sum, 4));  // Rounding shift: (sum + 8) >> 4
+	}
+	blurHorizontalScalar(sums, out, x, width, width);
+}
+
+static void blendRowNeon(const uint8_t* src, uint8_t* dst, int width, const uint8_t* top, const uint8_t* bottom,
+	const int32_t* offset0, const int32_t* offset1, const uint16_t* weightX, int weightY) {
+	alignas(16) uint16_t topLeft[8], topRight[8], bottomLeft[8], bottomRight[8];
+	const uint16x8_t full = vdupq_n_u16(256);
+	const uint16x8_t wy = vdupq_n_u16(static_cast<uint16_t>(weightY));
+	const uint16x8_t wyInv = vsubq_u16(full, wy);
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		for (int i = 0; i < 8; i++) {
+			uint8_t v = src[x + i];
+			topLeft[i] = top[offset0[x + i] + v];
+			topRight[i] = top[offset1[x + i] + v];
+			bottomLeft[i] = bottom[offset0[x + i] + v];
+			bottomRight[i] = bottom[offset1[x + i] + v];
+		}
+		uint16x8_t wx = vld1q_u16(weightX + x);
+		uint16x8_t wxInv = vsubq_u16(full, wx);
+		uint16x8_t upper = vmlaq_u16(vmulq_u16(vld1q_u16(topLeft), wxInv), vld1q_u16(topRight), wx);
+		uint16x8_t lower = vmlaq_u16(vmulq_u16(vld1q_u16(bottomLeft), wxInv), vld1q_u16(bottomRight), wx);
+		upper = vrshrq_n_u16(upper, 8);
+		lower = vrshrq_n_u16(lower, 8);
+		uint16x8_t result = vmlaq_u16(vmulq_u16(upper, wyInv), lower, wy);
+		vst1_u8(dst + x, vqmovn_u16(vrshrq_n_u16(result, 8)));
+	}
+	blendRowScalar(src + x, dst + x, width - x, top, bottom, offset0 + x, offset1 + x, weightX + x, weightY);
+}
+
+static Isa detectNeon() {
+	#if defined(__aarch64__)
+	return NEON;  // Always there on 64-bit ARM
+	#elif defined(__linux__) && defined(HWCAP_NEON)
+	return (getauxval(AT_HWCAP) & HWCAP_NEON) ? NEON : SCALAR;
+	#else
+	return NEON;
+	#endif
+}
+
+#endif
+
+// ---------------------------------------------------------------------------------------------------------------
+// Dispatch
+// ---------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+struct Dispatch {
+	Isa isa = SCALAR;
+	void (*blur)(const uint8_t*, const uint8_t*, const uint8_t*, uint16_t*, uint8_t*, int) = blurRowScalar;
+	void (*blend)(const uint8_t*, uint8_t*, int, const uint8_t*, const uint8_t*, const int32_t*, const int32_t*, const uint16_t*, int) = blendRowScalar;
+};
+
+Dispatch select(Isa isa) {
+	Dispatch d;
+	#if defined(LOWLIGHT_X86)
+	if (AVX2 == isa) {
+		d = { AVX2, blurRowAvx2, blendRowAvx2 };
+	}
+	else if (SSE41 == isa) {
+		d = { SSE41, blurRowSse41, blendRowSse41 };
+	}
+	#elif defined(LOWLIGHT_NEON)
+	if (NEON == isa) {
+		d = { NEON, blurRowNeon, blendRowNeon };
+	}
+	#endif
+	return d;
+}
+
+Dispatch& dispatch() {
+	static Dispatch current = select(detected());
+	return current;
+}
+
+}
+
+Isa LowLightKernel::detected() {
+	static const Isa best = [] {
+		#if defined(LOWLIGHT_X86)
+		return detectX86();
+		#elif defined(LOWLIGHT_NEON)
+		return detectNeon();
+		#else
+		return SCALAR;
+		#endif
+	}();
+	return best;
+}
+
+Isa LowLightKernel::active() {
+	return dispatch().isa;
+}
+
+void LowLightKernel::use(Isa isa) {
+	Isa best = detected();
+	bool supported = SCALAR == isa || isa == best || (SSE41 == isa && AVX2 == best);
+	dispatch() = select(supported ? isa : best);
+}
+
+const char* LowLightKernel::name(Isa isa) {
+	switch (isa) {
+	case SSE41: return "SSE4.1";
+	case AVX2: return "AVX2";
+	case NEON: return "NEON";
+	default: return "scalar";
+	}
+}
+
+void LowLightKernel::blurRow(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint16_t* scratch, uint8_t* out, int width) {
+	dispatch().blur(above, row, below, scratch, out, width);
+}
+
+void LowLightKernel::blendRow(const uint8_t* src, uint8_t* dst, int width, const uint8_t* lutsTop, const uint8_t* lutsBottom,
+	const int32_t* offset0, const int32_t* offset1, const uint16_t* weightX, int weightY) {
+	dispatch().blend(src, dst, width, lutsTop, lutsBottom, offset0, offset1, weightX, weightY);
+}
+
+// ---------------------------------------------------------------------------------------------------------------
+// LowLightEnhancer
+// ---------------------------------------------------------------------------------------------------------------
+
+LowLightEnhancer::LowLightEnhancer(const LowLightParams& params) : params(params), histogram(256) {}
+
+void LowLightEnhancer::setParams(const LowLightParams& newParams) {
+	params = newParams;
+	active = false;
+}
+
+LowLightEnhancer::Stats LowLightEnhancer::measure(const cv::Mat& frame) {
+	Stats result;
+	uint64_t sum = 0, squares = 0, count = 0;
+	int channels = frame.channels();
+	for (int y = 0; y < frame.rows; y += 4) {
+		const uint8_t* row = frame.ptr<uint8_t>(y);
+		for (int x = 0; x < frame.cols; x += 4) {
+			const uint8_t* p = row + x * channels;
+			// BT.601 luma in 8-bit fixed point, as cvtColor
+			uint32_t luma = channels >= 3 ? (p[0] * 29 + p[1] * 150 + p[2] * 77 + 128) >> 8 : p[0];
+			sum += luma;
+			squares += luma * luma;
+			count++;
+		}
+	}
+	if (count > 0) {
+		double mean = static_cast<double>(sum) / count;
+		result.mean = static_cast<float>(mean);
+		result.contrast = static_cast<float>(std::sqrt(std::max(0.0, static_cast<double>(squares) / count - mean * mean)));
+	}
+	return result;
+}
+
+bool LowLightEnhancer::process(const cv::Mat& frame, cv::Mat& out) {
+	if (!params.enabled || frame.empty() || frame.depth() != CV_8U) {
+		active = false;
+		return false;
+	}
+
+	// 🚀 Switch on for dark or flat frames, off again only once the frame is clearly better (hysteresis)
+	stats = measure(frame);
+	if (active) {
+		active = stats.mean < params.maxBrightness + 10.0f || stats.contrast < params.minContrast + 5.0f;
+	}
+	else {
+		active = stats.mean < params.maxBrightness || stats.contrast < params.minContrast;
+	}
+	if (!active) {
+		return false;
+	}
+
+	const cv::Mat* source = &frame;
+	if (frame.channels() == 3) {
+		cv::cvtColor(frame, grey, cv::COLOR_BGR2GRAY);
+		source = &grey;
+	}
+	enhance(*source, out);
+	enhancedCount++;
+	return true;
+}
+
+void LowLightEnhancer::prepareColumns(int width, int tiles) {
+	if (width == preparedWidth && tiles == preparedTiles) return;
+	offset0.resize(width);
+	offset1.resize(width);
+	weightX.resize(width);
+	for (int x = 0; x < width; x++) {
+		// Position in tile units, relative to the centre of the first tile
+		double f = (x + 0.5) * tiles / width - 0.5;
+		int left = static_cast<int>(std::floor(f));
+		int weight = static_cast<int>(std::lround((f - left) * 256));
+		if (left < 0) { left = 0; weight = 0; }
+		if (left >= tiles - 1) { left = tiles - 1; weight = 0; }
+		offset0[x] = left * 256;
+		offset1[x] = std::min(left + 1, tiles - 1) * 256;
+		weightX[x] = static_cast<uint16_t>(weight);
+	}
+	preparedWidth = width;
+	preparedTiles = tiles;
+}
+
+void LowLightEnhancer::enhance(const cv::Mat& source, cv::Mat& out) {
+	if (source.type() != CV_8UC1) {
+		throw std::invalid_argument("❌ ERROR: LowLightEnhancer::enhance expects an 8-bit grey image");
+	}
+	const int width = source.cols, height = source.rows;
+	const int tiles = std::max(1, std::min({ params.tiles, 16, width / 8, height / 8 }));
+	denoised.create(height, width, CV_8UC1);
+	out.create(height, width, CV_8UC1);
+	rowScratch.resize(width);
+
+	// 🚀 Denoise first, the equalisation would amplify the sensor noise of a dark IR frame
+	for (int y = 0; y < height; y++) {
+		LowLightKernel::blurRow(source.ptr<uint8_t>(std::max(y - 1, 0)), source.ptr<uint8_t>(y),
+			source.ptr<uint8_t>(std::min(y + 1, height - 1)), rowScratch.data(), denoised.ptr<uint8_t>(y), width);
+	}
+
+	// 🚀 Contrast-limited histogram of every tile and its cumulative lookup table
+	luts.resize(static_cast<size_t>(tiles) * tiles * 256 + 4);  // Padding for the 32-bit gathers of the AVX2 kernel
+	for (int ty = 0; ty < tiles; ty++) {
+		int y0 = ty * height / tiles, y1 = (ty + 1) * height / tiles;
+		for (int tx = 0; tx < tiles; tx++) {
+			int x0 = tx * width / tiles, x1 = (tx + 1) * width / tiles;
+			std::fill(histogram.begin(), histogram.end(), 0u);
+			for (int y = y0; y < y1; y++) {
+				const uint8_t* row = denoised.ptr<uint8_t>(y);
+				for (int x = x0; x < x1; x++) histogram[row[x]]++;
+			}
+
+			uint32_t area = static_cast<uint32_t>((y1 - y0) * (x1 - x0));
+			uint32_t clip = std::max<uint32_t>(1, static_cast<uint32_t>(params.clipLimit * area / 256));
+			uint32_t excess = 0;
+			for (uint32_t& bin : histogram) {
+				if (bin > clip) {
+					excess += bin - clip;
+					bin = clip;
+				}
+			}
+			// What was clipped is spread over all bins
+			uint32_t share = excess / 256, rest = excess % 256;
+			for (int v = 0; v < 256; v++) {
+				histogram[v] += share + (static_cast<uint32_t>(v) < rest ? 1 : 0);
+			}
+
+			uint8_t* lut = &luts[(static_cast<size_t>(ty) * tiles + tx) * 256];
+			uint32_t cumulative = 0;
+			for (int v = 0; v < 256; v++) {
+				cumulative += histogram[v];
+				lut[v] = static_cast<uint8_t>(std::min<uint32_t>(255, (cumulative * 255 + area / 2) / area));
+			}
+		}
+	}
+
+	// 🚀 Every pixel through the tables of the four tiles around it, bilinearly weighted
+	prepareColumns(width, tiles);
+	for (int y = 0; y < height; y++) {
+		double f = (y + 0.5) * tiles / height - 0.5;
+		int upper = static_cast<int>(std::floor(f));
+		int weight = static_cast<int>(std::lround((f - upper) * 256));
+		if (upper < 0) { upper = 0; weight = 0; }
+		if (upper >= tiles - 1) { upper = tiles - 1; weight = 0; }
+		int lower = std::min(upper + 1, tiles - 1);
+		LowLightKernel::blendRow(denoised.ptr<uint8_t>(y), out.ptr<uint8_t>(y), width,
+			&luts[static_cast<size_t>(upper) * tiles * 256], &luts[static_cast<size_t>(lower) * tiles * 256],
+			offset0.data(), offset1.data(), weightX.data(), weight);
+	}
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "detectionParams.h"
+
+/**
+ * @brief Hand-vectorised kernels of the low-light stage, chosen at runtime by CPU detection.
+ *
+ * AVX2 or SSE4.1 on x86 (whichever the CPU supports, the binary doesn't need to be built for it), NEON on ARM,
+ * a scalar loop elsewhere. All variants give bit-identical results.
+ */
+namespace LowLightKernel {
+	enum Isa { SCALAR, SSE41, AVX2, NEON };
+
+	/// @brief Best instruction set this CPU supports (and the binary has kernels for).
+	Isa detected();
+
+	/// @brief Instruction set the kernels currently run on.
+	Isa active();
+
+	/// @brief Runs the kernels on another instruction set, for tests and benchmarks; sets beyond @see detected() fall back to it. Call before the pipeline starts.
+	void use(Isa isa);
+
+	/// @brief Name of an instruction set ("AVX2", "SSE4.1", "NEON" or "scalar").
+	const char* name(Isa isa);
+
+	/**
+	 * @brief 3x3 binomial blur of one row: (1 2 1) vertically over the three rows, then horizontally, borders replicated.
+	 * @param scratch At least `width` elements.
+	 */
+	void blurRow(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint16_t* scratch, uint8_t* out, int width);
+
+	/**
+	 * @brief Tone-maps one row through the bilinearly interpolated lookup tables of the tiles around it.
+	 * @param lutsTop Tables (256 bytes each, 4 bytes of padding after the last) of the tile row above the pixels.
+	 * @param lutsBottom Tables of the tile row below the pixels.
+	 * @param offset0 Per column, offset of the table of the tile on the left (tile column * 256).
+	 * @param offset1 Per column, offset of the table of the tile on the right.
+	 * @param weightX Per column, weight of the right tile (0..256).
+	 * @param weightY Weight of the bottom tile row (0..256).
+	 */
+	void blendRow(const uint8_t* src, uint8_t* dst, int width, const uint8_t* lutsTop, const uint8_t* lutsBottom,
+		const int32_t* offset0, const int32_t* offset1, const uint16_t* weightX, int weightY);
+}
+
+/**
+ * @brief Contrast normalisation for dark and IR frames, ahead of the Haar cascades.
+ *
+ * At night the IR camera gives low-contrast, noisy frames and the cascades need many more pyramid levels and
+ * neighbours to find anything. Every frame is measured on a sparse grid (mean and spread of the grey levels);
+ * when it is too dark or too flat the frame is converted to grey, denoised with a 3x3 binomial blur and
+ * equalised with tiled, contrast-limited histograms (CLAHE) before detection. The decision has hysteresis, so
+ * a frame around the threshold doesn't make the stage flicker on and off.
+ *
+ * ### USAGE:
+ *      LowLightEnhancer lowLight(params.lowLight);
+ *      cv::Mat enhanced;
+ *      const cv::Mat& detectOn = lowLight.process(frame, enhanced) ? enhanced : frame;
+ */
+class LowLightEnhancer
+{
+public:
+	/// @brief Grey-level statistics of a frame
+	struct Stats {
+		float mean = 0.0f;
+		/// Standard deviation of the grey levels
+		float contrast = 0.0f;
+	};
+
+	explicit LowLightEnhancer(const LowLightParams& params = LowLightParams());
+
+	LowLightEnhancer(const LowLightEnhancer&) = delete;
+	LowLightEnhancer& operator=(const LowLightEnhancer&) = delete;
+
+	/// @brief Changes the thresholds and the equalisation.
+	void setParams(const LowLightParams& newParams);
+
+	/**
+	 * @brief Measures the frame and enhances it if the statistics call for it.
+	 * @param frame BGR or grey frame.
+	 * @param out Receives the enhanced grey frame (keeps its buffer between calls).
+	 * @return True if `out` holds the enhanced frame, false if the frame should be used as it is.
+	 */
+	bool process(const cv::Mat& frame, cv::Mat& out);
+
+	/// @brief Denoises and equalises a grey image, whatever its statistics.
+	void enhance(const cv::Mat& grey, cv::Mat& out);
+
+	/// @brief Grey-level statistics on every 4th pixel of every 4th row.
+	static Stats measure(const cv::Mat& frame);
+
+	/// @brief True if the last frame was enhanced.
+	bool isActive() const { return active; }
+
+	/// @brief Statistics of the last frame.
+	const Stats& lastStats() const { return stats; }
+
+	/// @brief Frames enhanced so far.
+	uint64_t enhancedFrames() const { return enhancedCount; }
+
+private:
+	/// Column offsets and weights of the tile interpolation, recomputed when the width or tiling changes
+	void prepareColumns(int width, int tiles);
+
+	LowLightParams params;
+	bool active = false;
+	Stats stats;
+
+	// Scratch, reused between frames
+	cv::Mat grey;
+	cv::Mat denoised;
+	std::vector<uint16_t> rowScratch;
+	std::vector<uint32_t> histogram;
+	std::vector<uint8_t> luts;
+	std::vector<int32_t> offset0;
+	std::vector<int32_t> offset1;
+	std::vector<uint16_t> weightX;
+	int preparedWidth = 0;
+	int preparedTiles = 0;
+
+	std::atomic<uint64_t> enhancedCount{0};
+};
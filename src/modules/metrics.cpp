@@ -0,0 +1,150 @@
+#include "metrics.h"
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <sstream>
+
+Histogram::Histogram(std::vector<double> bounds)
+	: upperBounds(std::move(bounds)), buckets(new std::atomic<uint64_t>[upperBounds.size() + 1]) {
+	std::sort(upperBounds.begin(), upperBounds.end());
+	for (size_t i = 0; i <= upperBounds.size(); i++) {
+		buckets[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+void Histogram::observe(double value) {
+	size_t i = std::lower_bound(upperBounds.begin(), upperBounds.end(), value) - upperBounds.begin();
+	buckets[i].fetch_add(1, std::memory_order_relaxed);
+	total.fetch_add(value, std::memory_order_relaxed);
+}
+
+namespace {
+
+enum class MetricType { COUNTER, GAUGE, HISTOGRAM };
+
+struct Entry {
+	std::string name;
+	std::string help;
+	std::string labels;
+	MetricType type;
+	std::unique_ptr<Counter> counter;
+	std::unique_ptr<Gauge> gauge;
+	std::unique_ptr<Histogram> histogram;
+};
+
+struct Registry {
+	std::mutex mutex;
+	std::deque<Entry> entries;  // Addresses stay valid while entries are added
+};
+
+// Constructed on first use, so modules may register from their static initialisers
+Registry& registry() {
+	static Registry instance;
+	return instance;
+}
+
+Entry& findOrAdd(const std::string& name, const std::string& help, const std::string& labels, MetricType type) {
+	Registry& r = registry();
+	for (Entry& entry : r.entries) {
+		if (entry.name == name && entry.labels == labels && entry.type == type) {
+			return entry;
+		}
+	}
+	r.entries.push_back(Entry{ name, help, labels, type, nullptr, nullptr, nullptr });
+	return r.entries.back();
+}
+
+const char* typeName(MetricType type) {
+	switch (type) {
+		case MetricType::COUNTER: return "counter";
+		case MetricType::GAUGE: return "gauge";
+		default: return "histogram";
+	}
+}
+
+std::string braces(const std::string& labels, const std::string& extra = "") {
+	if (labels.empty() && extra.empty()) return "";
+	if (labels.empty()) return "{" + extra + "}";
+	if (extra.empty()) return "{" + labels + "}";
+	return "{" + labels + "," + extra + "}";
+}
+
+}
+
+Counter& Metrics::counter(const std::string& name, const std::string& help, const std::string& labels) {
+	std::lock_guard<std::mutex> lock(registry().mutex);
+	Entry& entry = findOrAdd(name, help, labels, MetricType::COUNTER);
+	if (!entry.counter) entry.counter = std::make_unique<Counter>();
+	return *entry.counter;
+}
+
+Gauge& Metrics::gauge(const std::string& name, const std::string& help, const std::string& labels) {
+	std::lock_guard<std::mutex> lock(registry().mutex);
+	Entry& entry = findOrAdd(name, help, labels, MetricType::GAUGE);
+	if (!entry.gauge) entry.gauge = std::make_unique<Gauge>();
+	return *entry.gauge;
+}
+
+Histogram& Metrics::histogram(const std::string& name, const std::string& help, const std::vector<double>& bounds,
+	const std::string& labels) {
+	std::lock_guard<std::mutex> lock(registry().mutex);
+	Entry& entry = findOrAdd(name, help, labels, MetricType::HISTOGRAM);
+	if (!entry.histogram) entry.histogram = std::make_unique<Histogram>(bounds);
+	return *entry.histogram;
+}
+
+const std::vector<double>& Metrics::latencyBucketsMs() {
+	static const std::vector<double> bounds = { 1, 2, 5, 10, 20, 33, 50, 75, 100, 150, 200, 300, 500, 1000, 2000 };
+	return bounds;
+}
+
+void Metrics::write(std::ostream& out) {
+	Registry& r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+
+	// Series of one metric family have to be adjacent, with one HELP and TYPE line
+	std::vector<const Entry*> sorted;
+	for (const Entry& entry : r.entries) sorted.push_back(&entry);
+	std::stable_sort(sorted.begin(), sorted.end(), [](const Entry* a, const Entry* b) { return a->name < b->name; });
+
+	const std::string* family = nullptr;
+	for (const Entry* entry : sorted) {
+		if (nullptr == family || *family != entry->name) {
+			family = &entry->name;
+			out << "# HELP " << entry->name << ' ' << entry->help << '\n';
+			out << "# TYPE " << entry->name << ' ' << typeName(entry->type) << '\n';
+		}
+
+		switch (entry->type) {
+			case MetricType::COUNTER:
+				out << entry->name << braces(entry->labels) << ' ' << entry->counter->get() << '\n';
+				break;
+			case MetricType::GAUGE:
+				out << entry->name << braces(entry->labels) << ' ' << entry->gauge->get() << '\n';
+				break;
+			case MetricType::HISTOGRAM: {
+				// Buckets are read one by one while they may still change; the count is derived from the
+				// same reads so that +Inf and _count always agree
+				const Histogram& h = *entry->histogram;
+				uint64_t cumulative = 0;
+				for (size_t i = 0; i < h.bounds().size(); i++) {
+					cumulative += h.bucket(i);
+					std::ostringstream le;
+					le << "le=\"" << h.bounds()[i] << '"';
+					out << entry->name << "_bucket" << braces(entry->labels, le.str()) << ' ' << cumulative << '\n';
+				}
+				cumulative += h.bucket(h.bounds().size());
+				out << entry->name << "_bucket" << braces(entry->labels, "le=\"+Inf\"") << ' ' << cumulative << '\n';
+				out << entry->name << "_sum" << braces(entry->labels) << ' ' << h.sum() << '\n';
+				out << entry->name << "_count" << braces(entry->labels) << ' ' << cumulative << '\n';
+				break;
+			}
+		}
+	}
+}
+
+std::string Metrics::text() {
+	std::ostringstream out;
+	write(out);
+	return out.str();
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/// @brief Monotonic count (frames, drops, alarms). Lock-free, safe to update from any thread.
+class Counter
+{
+public:
+	void inc(uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+	uint64_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<uint64_t> value{0};
+};
+
+/// @brief Value that goes up and down (queue depth, fps, state). Lock-free, safe to update from any thread.
+class Gauge
+{
+public:
+	void set(double v) { value.store(v, std::memory_order_relaxed); }
+	void add(double d) { value.fetch_add(d, std::memory_order_relaxed); }
+	double get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<double> value{0.0};
+};
+
+/**
+ * @brief Distribution of a value over fixed buckets (latencies). Lock-free, safe to update from any thread.
+ *
+ * Buckets are counted individually and only made cumulative when exported, so an observation is two
+ * relaxed increments and one add.
+ */
+class Histogram
+{
+public:
+	/// @param bounds Upper bounds of the buckets, ascending. A last +Inf bucket is implied.
+	explicit Histogram(std::vector<double> bounds);
+
+	void observe(double value);
+
+	const std::vector<double>& bounds() const { return upperBounds; }
+
+	/// @brief Observations in bucket `i` alone (not cumulative), `bounds().size()` is the +Inf bucket.
+	uint64_t bucket(size_t i) const { return buckets[i].load(std::memory_order_relaxed); }
+
+	double sum() const { return total.load(std::memory_order_relaxed); }
+
+private:
+	std::vector<double> upperBounds;
+	std::unique_ptr<std::atomic<uint64_t>[]> buckets;
+	std::atomic<double> total{0.0};
+};
+
+/**
+ * @brief Process-wide registry of the metrics in Prometheus text format.
+ *
+ * Modules register their metrics once (at static initialisation or construction) and keep the returned
+ * reference, so updating a metric on the hot path is a relaxed atomic operation and never touches the
+ * registry lock. Registering the same name and labels again returns the same metric. @see MetricsServer
+ * serves @see write() to the fleet agent.
+ *
+ * ### USAGE:
+ *      static Counter& framesCaptured = Metrics::counter("wakeomatic_camera_frames_total", "Frames read from the camera");
+ *      static Counter& lateDrops = Metrics::counter("wakeomatic_frames_dropped_total", "Frames dropped", "reason=\"late\"");
+ *      ...
+ *      framesCaptured.inc();
+ *      ...
+ *      Metrics::write(std::cout);
+ */
+class Metrics
+{
+public:
+	/**
+	 * @brief Returns the counter of that name and labels, registering it on first use.
+	 * @param name Metric name, counters end in `_total` by convention.
+	 * @param help One line description for the `# HELP` line.
+	 * @param labels Fixed labels without braces, e.g. `reason="late"`, empty for none.
+	 */
+	static Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+
+	/// @brief Returns the gauge of that name and labels, registering it on first use.
+	static Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+
+	/// @brief Returns the histogram of that name and labels, registering it with `bounds` on first use.
+	static Histogram& histogram(const std::string& name, const std::string& help, const std::vector<double>& bounds,
+		const std::string& labels = "");
+
+	/// @brief Bucket bounds for latencies in milliseconds (1 ms to 2 s).
+	static const std::vector<double>& latencyBucketsMs();
+
+	/// @brief Writes every metric in the Prometheus text exposition format (version 0.0.4).
+	static void write(std::ostream& out);
+
+	/// @brief Same as @see write() into a string.
+	static std::string text();
+};
@@ -0,0 +1,138 @@
+#include "metricsServer.h"
+#include "threadPlacement.h"
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+	#include <arpa/inet.h>
+	#include <netinet/in.h>
+	#include <poll.h>
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <unistd.h>
+#endif
+
+//how often the server thread checks whether it should stop
+static const int ACCEPT_POLL_MS = 200;
+
+//a client that doesn't send its request within this time is dropped
+static const int REQUEST_TIMEOUT_MS = 1000;
+
+bool MetricsServer::start(const Config& newConfig) {
+	if (isOn) return true;  // Prevent multiple starts
+	config = newConfig;
+
+	#ifdef _WIN32
+	std::cerr << "⚠️ WARNING: The metrics server is not available on this system." << std::endl;
+	return false;
+	#else
+	if (0 == config.port) {
+		sockaddr_un address{};
+		address.sun_family = AF_UNIX;
+		if (config.unixPath.size() >= sizeof(address.sun_path)) {
+			std::cerr << "⚠️ WARNING: Metrics socket path too long: " << config.unixPath << std::endl;
+			return false;
+		}
+		std::strncpy(address.sun_path, config.unixPath.c_str(), sizeof(address.sun_path) - 1);
+		unlink(config.unixPath.c_str());  // Left behind by a crashed run
+		listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (listenFd < 0 || 0 != bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address))) {
+			std::cerr << "⚠️ WARNING: Could not open metrics socket " << config.unixPath << std::endl;
+			stop();
+			return false;
+		}
+	}
+	else {
+		sockaddr_in address{};
+		address.sin_family = AF_INET;
+		address.sin_port = htons(static_cast<uint16_t>(config.port));
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);  // Never reachable from outside the unit
+		listenFd = socket(AF_INET, SOCK_STREAM, 0);
+		int reuse = 1;
+		if (listenFd >= 0) setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+		if (listenFd < 0 || 0 != bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address))) {
+			std::cerr << "⚠️ WARNING: Could not open metrics port 127.0.0.1:" << config.port << std::endl;
+			stop();
+			return false;
+		}
+	}
+
+	if (0 != listen(listenFd, 4)) {
+		std::cerr << "⚠️ WARNING: Could not listen for metrics scrapes" << std::endl;
+		stop();
+		return false;
+	}
+
+	isOn = true;
+	serverThread = std::thread(&MetricsServer::threadLoop, this);
+	return true;
+	#endif
+}
+
+void MetricsServer::stop() {
+	isOn = false;
+	if (serverThread.joinable()) {
+		serverThread.join();
+	}
+	#ifndef _WIN32
+	if (listenFd >= 0) {
+		close(listenFd);
+		listenFd = -1;
+		if (0 == config.port) {
+			unlink(config.unixPath.c_str());
+		}
+	}
+	#endif
+}
+
+void MetricsServer::threadLoop() {
+	ThreadPlacement::Scope placement(ThreadPlacement::METRICS);
+	#ifndef _WIN32
+	while (isOn) {
+		pollfd listening{ listenFd, POLLIN, 0 };
+		if (poll(&listening, 1, ACCEPT_POLL_MS) <= 0) {
+			continue;  // Re-check isOn regularly
+		}
+		int client = accept(listenFd, nullptr, nullptr);
+		if (client < 0) continue;
+		serve(client);
+		close(client);
+	}
+	#endif
+}
+
+void MetricsServer::serve(int client) {
+	#ifndef _WIN32
+	// Only the request line matters, the headers are read as far as they fit and ignored
+	char request[1024];
+	size_t received = 0;
+	while (received < sizeof(request) - 1) {
+		pollfd readable{ client, POLLIN, 0 };
+		if (poll(&readable, 1, REQUEST_TIMEOUT_MS) <= 0) return;
+		ssize_t n = recv(client, request + received, sizeof(request) - 1 - received, 0);
+		if (n <= 0) return;
+		received += static_cast<size_t>(n);
+		request[received] = '\0';
+		if (nullptr != std::strstr(request, "\r\n\r\n") || nullptr != std::strstr(request, "\n\n")) break;
+	}
+	request[received] = '\0';
+
+	std::string response;
+	if (0 == std::strncmp(request, "GET /metrics", 12) || 0 == std::strncmp(request, "GET / ", 6)) {
+		std::string body = Metrics::text();
+		response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: "
+			+ std::to_string(body.size()) + "\r\n\r\n" + body;
+		scrapeCount++;
+	}
+	else {
+		response = "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+	}
+
+	size_t sent = 0;
+	while (sent < response.size()) {
+		ssize_t n = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+		if (n <= 0) return;  // Scraper went away
+		sent += static_cast<size_t>(n);
+	}
+	#endif
+}
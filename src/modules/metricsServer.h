@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include "metrics.h"
+
+/**
+ * @brief Serves @see Metrics in Prometheus text format to local scrapers.
+ *
+ * Listens on a Unix socket (default) or on a TCP port bound to 127.0.0.1 and answers every
+ * `GET /metrics` with a plain HTTP/1.0 response, so the fleet agent can scrape it with
+ * `curl --unix-socket /tmp/wake-o-matic.metrics http://localhost/metrics`. The exposition is built on
+ * the server's own thread, which runs at the lowest priority (@see ThreadPlacement::METRICS): the
+ * pipeline threads only ever update their atomics.
+ *
+ * ### USAGE:
+ *      MetricsServer metricsServer;
+ *      metricsServer.start(MetricsServer::Config());
+ *      ...
+ *      metricsServer.stop();
+ *
+ * Only available on POSIX systems.
+ */
+class MetricsServer
+{
+public:
+	struct Config {
+		/// Path of the Unix socket, used when `port` is 0
+		std::string unixPath = "/tmp/wake-o-matic.metrics";
+		/// TCP port on 127.0.0.1 instead of the Unix socket, 0 to use the socket
+		int port = 0;
+	};
+
+	/** Destructor (Ensures thread stops when object is destroyed) */
+	~MetricsServer() { stop(); }
+
+	/**
+	 * @brief Opens the socket and starts the server thread.
+	 * @return False (with a warning) if the socket could not be opened.
+	 */
+	bool start(const Config& config);
+
+	/// Stops the server thread and removes the Unix socket
+	void stop();
+
+	/// Number of scrapes answered so far
+	uint64_t scrapes() const { return scrapeCount; }
+
+private:
+	void threadLoop();
+	void serve(int client);
+
+	Config config;
+	int listenFd = -1;
+	std::atomic<bool> isOn{false};
+	std::atomic<uint64_t> scrapeCount{0};
+	std::thread serverThread;
+};
@@ -0,0 +1,132 @@
+#include "parameterSweep.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace std::chrono;
+
+std::vector<LabelledInterval> loadLabels(const std::string& path) {
+	std::vector<LabelledInterval> labels;
+	std::ifstream in(path);
+	if (!in) {
+		return labels;
+	}
+
+	std::string line;
+	while (std::getline(in, line)) {
+		if (line.empty() || '#' == line[0]) continue;
+		std::replace(line.begin(), line.end(), ',', ' ');
+		std::istringstream fields(line);
+		LabelledInterval interval;
+		std::string label;
+		if (!(fields >> interval.startMs >> interval.endMs >> label)) continue;  // Header or broken line
+		label.erase(std::remove(label.begin(), label.end(), '\r'), label.end());
+
+		if (label == "open") interval.label = LabelledInterval::OPEN_EYES;
+		else if (label == "closed") interval.label = LabelledInterval::CLOSED_EYES;
+		else if (label == "noface") interval.label = LabelledInterval::NO_FACE;
+		else if (label == "microsleep") interval.label = LabelledInterval::MICROSLEEP;
+		else {
+			std::cerr << "⚠️ WARNING: Unknown label " << label << " in " << path << std::endl;
+			continue;
+		}
+		labels.push_back(interval);
+	}
+	std::sort(labels.begin(), labels.end(), [](const LabelledInterval& a, const LabelledInterval& b) { return a.startMs < b.startMs; });
+	return labels;
+}
+
+void ReplayScore::add(const ReplayScore& other) {
+	labelledFrames += other.labelledFrames;
+	correctFrames += other.correctFrames;
+	microsleeps += other.microsleeps;
+	detected += other.detected;
+	falseAlarms += other.falseAlarms;
+	latencySumMs += other.latencySumMs;
+}
+
+static double toMs(steady_clock::time_point t) {
+	return duration<double, std::milli>(t.time_since_epoch()).count();
+}
+
+ReplayScore scoreReplay(const std::vector<EyeSample>& samples, const std::vector<SequentialSleepDetect::DetectionEvent>& events,
+	const std::vector<LabelledInterval>& labels) {
+	ReplayScore score;
+
+	// Samples and labels are both in time order, walk them together
+	size_t current = 0;
+	for (const EyeSample& sample : samples) {
+		double t = toMs(sample.timestamp);
+		while (current < labels.size() && labels[current].endMs < t) current++;
+		if (current >= labels.size() || t < labels[current].startMs) continue;
+
+		int expected = AWAKE;
+		switch (labels[current].label) {
+			case LabelledInterval::OPEN_EYES: expected = AWAKE; break;
+			case LabelledInterval::CLOSED_EYES:
+			case LabelledInterval::MICROSLEEP: expected = SLEEPING; break;
+			case LabelledInterval::NO_FACE: expected = NOFACE; break;
+		}
+		score.labelledFrames++;
+		if (sample.status == expected) score.correctFrames++;
+	}
+
+	std::vector<bool> matched(events.size(), false);
+	for (const LabelledInterval& interval : labels) {
+		if (LabelledInterval::MICROSLEEP != interval.label) continue;
+		score.microsleeps++;
+		for (size_t i = 0; i < events.size(); i++) {
+			double decision = toMs(events[i].decision);
+			if (!matched[i] && decision >= interval.startMs && decision <= interval.endMs + ALARM_GRACE_MS) {
+				matched[i] = true;
+				score.detected++;
+				score.latencySumMs += decision - interval.startMs;
+				break;
+			}
+		}
+	}
+	score.falseAlarms = static_cast<int>(std::count(matched.begin(), matched.end(), false));
+	return score;
+}
+
+bool dominates(const SweepPoint& a, const SweepPoint& b) {
+	bool noWorse = a.fps >= b.fps && a.score.accuracy() >= b.score.accuracy()
+		&& a.score.alarmErrors() <= b.score.alarmErrors() && a.score.meanLatencyMs() <= b.score.meanLatencyMs();
+	bool better = a.fps > b.fps || a.score.accuracy() > b.score.accuracy()
+		|| a.score.alarmErrors() < b.score.alarmErrors() || a.score.meanLatencyMs() < b.score.meanLatencyMs();
+	return noWorse && better;
+}
+
+std::vector<size_t> paretoFront(const std::vector<SweepPoint>& points) {
+	std::vector<size_t> front;
+	for (size_t i = 0; i < points.size(); i++) {
+		bool dominated = false;
+		for (size_t j = 0; j < points.size() && !dominated; j++) {
+			dominated = j != i && dominates(points[j], points[i]);
+		}
+		if (!dominated) front.push_back(i);
+	}
+	return front;
+}
+
+size_t chooseConfiguration(const std::vector<SweepPoint>& points, const std::vector<size_t>& front, double accuracyTolerance) {
+	int fewestErrors = points[front[0]].score.alarmErrors();
+	for (size_t i : front) fewestErrors = std::min(fewestErrors, points[i].score.alarmErrors());
+
+	double bestAccuracy = 0;
+	for (size_t i : front) {
+		if (points[i].score.alarmErrors() == fewestErrors) bestAccuracy = std::max(bestAccuracy, points[i].score.accuracy());
+	}
+
+	size_t chosen = front[0];
+	double fastest = -1;
+	for (size_t i : front) {
+		const SweepPoint& p = points[i];
+		if (p.score.alarmErrors() == fewestErrors && p.score.accuracy() >= bestAccuracy - accuracyTolerance && p.fps > fastest) {
+			fastest = p.fps;
+			chosen = i;
+		}
+	}
+	return chosen;
+}
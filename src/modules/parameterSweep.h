@@ -0,0 +1,81 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "detectionParams.h"
+#include "sleepDetect.h"
+#include "sequentialSleepDetect.h"
+
+/// @brief Ground truth for a stretch of a recording, from `<video>.labels.csv`
+struct LabelledInterval {
+	enum Label {
+		OPEN_EYES,   ///< Eyes open
+		CLOSED_EYES, ///< Eyes closed (blink), no alarm expected
+		NO_FACE,     ///< No face in the picture
+		MICROSLEEP   ///< Eyes closed and an alarm is expected
+	};
+	double startMs = 0;
+	double endMs = 0;
+	Label label = OPEN_EYES;
+};
+
+/**
+ * @brief Reads the labels of a recording.
+ *
+ * One interval per line: `start_ms,end_ms,label` with label `open`, `closed`, `noface` or `microsleep`.
+ * A header line and `#` comments are skipped. Frames outside every interval are not scored.
+ */
+std::vector<LabelledInterval> loadLabels(const std::string& path);
+
+/// @brief How well one configuration did on a recording (or, summed up, on the corpus)
+struct ReplayScore {
+	/// Frames inside a labelled interval, and those whose raw eye state matched the label
+	int labelledFrames = 0;
+	int correctFrames = 0;
+	/// Labelled microsleeps, and those an alarm was raised for
+	int microsleeps = 0;
+	int detected = 0;
+	/// Alarms outside every microsleep
+	int falseAlarms = 0;
+	/// Sum over the detected microsleeps of the time from their start to the alarm
+	double latencySumMs = 0;
+
+	void add(const ReplayScore& other);
+	double accuracy() const { return labelledFrames > 0 ? static_cast<double>(correctFrames) / labelledFrames : 0.0; }
+	double meanLatencyMs() const { return detected > 0 ? latencySumMs / detected : 0.0; }
+	/// Missed microsleeps plus false alarms
+	int alarmErrors() const { return microsleeps - detected + falseAlarms; }
+};
+
+/// An alarm counts for a microsleep if it is raised up to this long after the labelled end
+const double ALARM_GRACE_MS = 2000;
+
+/**
+ * @brief Scores the per-frame eye states and the alarms of a replay against its labels.
+ * @param samples Per-frame samples of the replay (timestamps relative to the start of the video).
+ * @param events Alarms of the replay.
+ * @param labels Ground truth, @see loadLabels().
+ */
+ReplayScore scoreReplay(const std::vector<EyeSample>& samples, const std::vector<SequentialSleepDetect::DetectionEvent>& events,
+	const std::vector<LabelledInterval>& labels);
+
+/// @brief One configuration of the sweep with its throughput and score over the corpus
+struct SweepPoint {
+	DetectionParams params;
+	/// Frames per second of processing time (one core)
+	double fps = 0;
+	ReplayScore score;
+};
+
+/// @brief True if `a` is at least as good as `b` in fps, accuracy, alarm errors and alarm latency, and better in one.
+bool dominates(const SweepPoint& a, const SweepPoint& b);
+
+/// @brief Indices of the points no other point dominates, in the order of the input.
+std::vector<size_t> paretoFront(const std::vector<SweepPoint>& points);
+
+/**
+ * @brief Picks the configuration to deploy from the Pareto front.
+ * Fewest alarm errors first; among those, the fastest one whose accuracy is within `accuracyTolerance`
+ * of the best accuracy.
+ * @return Index into `points`.
+ */
+size_t chooseConfiguration(const std::vector<SweepPoint>& points, const std::vector<size_t>& front, double accuracyTolerance = 0.02);
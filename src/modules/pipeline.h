@@ -0,0 +1,161 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <vector>
+#include "sleepDetect.h"
+
+/// @brief Eye state of one frame, replaces the untyped `int` status of @see EyeSample
+enum class EyeState : int8_t {
+	NoFace = -1,
+	Closed = 0,
+	Open = 1
+};
+
+/// @brief Driver state decided from the eye states, replaces the `SLEEPING` / `AWAKE` / `NOFACE` macros
+enum class DriverState : int8_t {
+	NoFace = NOFACE,
+	Asleep = SLEEPING,
+	Awake = AWAKE
+};
+
+/// @brief Legacy status code for the parts of the program that still take an `int`
+constexpr int toStatus(EyeState state) { return static_cast<int>(state); }
+constexpr int toStatus(DriverState state) { return static_cast<int>(state); }
+
+/// @brief Typed state of a legacy status code (anything unknown counts as no face)
+constexpr DriverState toDriverState(int status) {
+	return AWAKE == status ? DriverState::Awake : SLEEPING == status ? DriverState::Asleep : DriverState::NoFace;
+}
+
+/// @brief Result of the eye stage for one frame
+struct EyeObservation {
+	EyeState state = EyeState::NoFace;
+	/// Share of the found eyes that were classified as open
+	float openConfidence = 0.0f;
+	/// Capture time of the frame
+	std::chrono::steady_clock::time_point captured;
+
+	/// Same observation for the decision engines that take an @see EyeSample
+	EyeSample toSample() const { return EyeSample{ toStatus(state), openConfidence, captured }; }
+};
+
+// 🚀 Stage requirements, checked when a pipeline is composed
+
+/// Delivers frames; returns false when there is no further frame
+template <class T>
+concept FrameSource = requires(T source, cv::Mat& frame, std::chrono::steady_clock::time_point& captured) {
+	{ source.next(frame, captured) } -> std::same_as<bool>;
+};
+
+/// Prepares a frame for detection (colour conversion, contrast...); the result may live in the stage
+template <class T>
+concept FramePreprocessor = requires(T stage, const cv::Mat& frame) {
+	{ stage.apply(frame) } -> std::convertible_to<const cv::Mat&>;
+};
+
+/// Finds faces in the frame and eyes inside a face (eye rectangles relative to the face)
+template <class T>
+concept FaceEyeDetector = requires(T detector, const cv::Mat& image, const cv::Rect& face) {
+	{ detector.faces(image) } -> std::convertible_to<const std::vector<cv::Rect>&>;
+	{ detector.eyes(image(face)) } -> std::convertible_to<const std::vector<cv::Rect>&>;
+};
+
+/// Tells whether one eye is open
+template <class T>
+concept EyeClassifier = requires(T classifier, const cv::Mat& eye) {
+	{ classifier.classify(eye) } -> std::same_as<EyeState>;
+};
+
+/// Turns per-frame observations into a driver state
+template <class T>
+concept DecisionPolicy = requires(T decision, const EyeObservation& observation) {
+	{ decision.update(observation) } -> std::same_as<DriverState>;
+};
+
+/// Acts on the driver state (alarm, status queue, nothing)
+template <class T>
+concept ActionSink = requires(T sink, DriverState state) {
+	sink.act(state);
+};
+
+/**
+ * @brief Detection pipeline composed at compile time from policy types.
+ *
+ * The stages are plain members, not interfaces: every call is resolved (and can be inlined) by the compiler,
+ * and a deployment builds exactly the variant it runs instead of choosing behaviour with runtime branches.
+ * Statuses are the typed @see EyeState and @see DriverState.
+ *
+ * Ready-made policies are in pipelinePolicies.h.
+ *
+ * ### USAGE:
+ *      using DashPipeline = Pipeline<CameraSource, GreyPreprocess, CascadeDetector, BlobEyeClassifier, SequentialDecision, ActionMachineSink>;
+ *      DashPipeline pipeline;
+ *      while (pipeline.step()) {}
+ */
+template <FrameSource Source, FramePreprocessor Preprocess, FaceEyeDetector Detector, EyeClassifier Classifier,
+	DecisionPolicy Decision, ActionSink Sink>
+class Pipeline
+{
+public:
+	Source source;
+	Preprocess preprocess;
+	Detector detector;
+	Classifier classifier;
+	Decision decision;
+	Sink sink;
+
+	/**
+	 * @brief Takes the next frame from the source and runs it through all stages.
+	 * @return False once the source has no more frames.
+	 */
+	bool step() {
+		std::chrono::steady_clock::time_point captured;
+		if (!source.next(frame, captured)) return false;
+		process(frame, captured);
+		return true;
+	}
+
+	/**
+	 * @brief Runs one frame through the stages after the source.
+	 * @return Driver state after this frame.
+	 */
+	DriverState process(const cv::Mat& input, std::chrono::steady_clock::time_point captured) {
+		const cv::Mat& image = preprocess.apply(input);
+		lastObservation = EyeObservation{ EyeState::NoFace, 0.0f, captured };
+
+		const std::vector<cv::Rect>& faces = detector.faces(image);
+		if (!faces.empty()) {
+			int eyesFound = 0;
+			int eyesOpen = 0;
+			for (const cv::Rect& face : faces) {
+				cv::Mat faceImage = image(face);
+				for (const cv::Rect& eye : detector.eyes(faceImage)) {
+					eyesFound++;
+					if (EyeState::Open == classifier.classify(faceImage(eye))) {
+						eyesOpen++;
+					}
+				}
+			}
+			// Same rule as FrameProcessor: one open eye is enough, no eyes found counts as closed
+			lastObservation.state = eyesOpen > 0 ? EyeState::Open : EyeState::Closed;
+			lastObservation.openConfidence = eyesFound > 0 ? static_cast<float>(eyesOpen) / eyesFound : 0.0f;
+		}
+
+		lastState = decision.update(lastObservation);
+		sink.act(lastState);
+		return lastState;
+	}
+
+	/// @brief Eye stage result of the last frame.
+	const EyeObservation& observation() const { return lastObservation; }
+
+	/// @brief Driver state after the last frame.
+	DriverState state() const { return lastState; }
+
+private:
+	cv::Mat frame;
+	EyeObservation lastObservation;
+	DriverState lastState = DriverState::Awake;
+};
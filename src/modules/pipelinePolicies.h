@@ -0,0 +1,207 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/objdetect.hpp>
+#include <opencv2/videoio.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "pipeline.h"
+#include "clock.h"
+#include "detectionParams.h"
+#include "eyeStatus.h"
+#include "eyeNet.h"
+#include "sleepDetect.h"
+#include "sequentialSleepDetect.h"
+#include "actionStateMachine.h"
+
+/**
+ * @brief Ready-made stages for @see Pipeline. All header-only so the compiler can inline across stages.
+ */
+
+// 🚀 Sources
+
+/// @brief Live camera, frames stamped by the clock right after they were read
+struct CameraSource {
+	cv::VideoCapture capture;
+	Clock* clock = &Clock::steady();
+
+	bool open(int deviceID = 0, int apiID = cv::CAP_ANY) {
+		if (!capture.open(deviceID, apiID)) return false;
+		capture.set(cv::CAP_PROP_FRAME_WIDTH, 640);
+		capture.set(cv::CAP_PROP_FRAME_HEIGHT, 480);
+		capture.set(cv::CAP_PROP_FPS, 30);
+		return true;
+	}
+
+	bool next(cv::Mat& frame, std::chrono::steady_clock::time_point& captured) {
+		if (!capture.read(frame) || frame.empty()) return false;
+		captured = clock->now();
+		return true;
+	}
+};
+
+/// @brief Recorded video, frames stamped with their video time (like @see replayVideo)
+struct VideoFileSource {
+	cv::VideoCapture capture;
+	int frames = 0;
+
+	bool open(const std::string& path) {
+		frames = 0;
+		return capture.open(path);
+	}
+
+	bool next(cv::Mat& frame, std::chrono::steady_clock::time_point& captured) {
+		if (!capture.read(frame) || frame.empty()) return false;
+		double videoMs = capture.get(cv::CAP_PROP_POS_MSEC);
+		if (videoMs <= 0 && frames > 0) {
+			double fps = capture.get(cv::CAP_PROP_FPS);
+			videoMs = frames * 1000.0 / (fps > 0 ? fps : 30.0);
+		}
+		frames++;
+		captured = std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double, std::milli>(videoMs)));
+		return true;
+	}
+};
+
+/// @brief The same image over and over at 30 fps of simulated time, for benchmarks and tests
+struct StillImageSource {
+	cv::Mat image;
+	int remaining = 0;
+	std::chrono::steady_clock::time_point time;
+
+	bool next(cv::Mat& frame, std::chrono::steady_clock::time_point& captured) {
+		if (remaining <= 0) return false;
+		remaining--;
+		frame = image;
+		captured = time;
+		time += std::chrono::microseconds(33333);
+		return true;
+	}
+};
+
+// 🚀 Preprocessors
+
+/// @brief Detection runs on the camera frame as it is
+struct NoPreprocess {
+	const cv::Mat& apply(const cv::Mat& frame) { return frame; }
+};
+
+/// @brief Converts to grey once per frame (the cascades and the blob detector work on grey anyway)
+struct GreyPreprocess {
+	cv::Mat grey;
+
+	const cv::Mat& apply(const cv::Mat& frame) {
+		if (frame.channels() == 1) return frame;
+		cv::cvtColor(frame, grey, cv::COLOR_BGR2GRAY);  // Reuses the buffer while the size doesn't change
+		return grey;
+	}
+};
+
+// 🚀 Detectors
+
+/// @brief Haar cascades for face and eyes, with the parameters of FrameProcessor (@see DetectionParams): the built-in
+/// defaults until @see configure() passes the tuned ones (wake-o-matic.conf)
+struct CascadeDetector {
+	cv::CascadeClassifier faceCascade;
+	cv::CascadeClassifier eyesCascade;
+	CascadeParams faceParams = DetectionParams().face;
+	CascadeParams eyesParams = DetectionParams().eyes;
+	std::vector<cv::Rect> faceRects;
+	std::vector<cv::Rect> eyeRects;
+
+#if defined(FACE_CASCADE_PATH) && defined(EYES_CASCADE_PATH)
+	CascadeDetector() : CascadeDetector(FACE_CASCADE_PATH, EYES_CASCADE_PATH) {}
+#endif
+
+	CascadeDetector(const std::string& facePath, const std::string& eyesPath) {
+		if (!faceCascade.load(facePath)) {
+			throw std::runtime_error("❌ ERROR: Could not load face cascade! Check path: " + facePath);
+		}
+		if (!eyesCascade.load(eyesPath)) {
+			throw std::runtime_error("❌ ERROR: Could not load eye cascade! Check path: " + eyesPath);
+		}
+	}
+
+	void configure(const DetectionParams& params) {
+		faceParams = params.face;
+		eyesParams = params.eyes;
+	}
+
+	const std::vector<cv::Rect>& faces(const cv::Mat& image) {
+		faceCascade.detectMultiScale(image, faceRects, faceParams.scaleFactor, faceParams.minNeighbors, 0 | cv::CASCADE_SCALE_IMAGE,
+			cv::Size(faceParams.minSize, faceParams.minSize));
+		return faceRects;
+	}
+
+	const std::vector<cv::Rect>& eyes(const cv::Mat& face) {
+		eyesCascade.detectMultiScale(face, eyeRects, eyesParams.scaleFactor, eyesParams.minNeighbors, 0 | cv::CASCADE_SCALE_IMAGE,
+			cv::Size(eyesParams.minSize, eyesParams.minSize));
+		return eyeRects;
+	}
+};
+
+// 🚀 Eye classifiers
+
+/// @brief Iris blob detection (@see EyeStatus)
+struct BlobEyeClassifier {
+	EyeStatus blobs;
+
+	void configure(const DetectionParams& params) { blobs = EyeStatus(params.blob); }
+
+	EyeState classify(const cv::Mat& eye) {
+		return blobs.detect(eye) ? EyeState::Open : EyeState::Closed;
+	}
+};
+
+/// @brief Int8 eye-state net (@see EyeNet), open from `net.threshold` on
+struct NetEyeClassifier {
+	EyeNet net;
+
+	void configure(const DetectionParams& params) { net.threshold = params.eyeNetThreshold; }
+
+	EyeState classify(const cv::Mat& eye) {
+		return net.classify(eye).open ? EyeState::Open : EyeState::Closed;
+	}
+};
+
+// 🚀 Decision policies
+
+/// @brief Sequential probability ratio test (@see SequentialSleepDetect)
+struct SequentialDecision {
+	SequentialSleepDetect engine;
+
+	DriverState update(const EyeObservation& observation) {
+		return toDriverState(engine.update(observation.toSample()));
+	}
+};
+
+/// @brief Majority vote over windows of `Frames` frames (@see SleepDetect), the state changes once per window
+template <int Frames = 30>
+struct MajorityDecision {
+	SleepDetect votes;
+	DriverState current = DriverState::Awake;
+
+	DriverState update(const EyeObservation& observation) {
+		votes.load(toStatus(observation.state));
+		if (votes.bufferSize() >= Frames) {
+			current = toDriverState(votes.detect());
+		}
+		return current;
+	}
+};
+
+// 🚀 Action sinks
+
+/// @brief Alarm and warning sounds (@see ActionStateMachine)
+struct ActionMachineSink {
+	ActionStateMachine machine;
+
+	void act(DriverState state) { machine.changeState(toStatus(state)); }
+};
+
+/// @brief Does nothing, for replays and benchmarks
+struct NullSink {
+	void act(DriverState) {}
+};
@@ -0,0 +1,111 @@
+#include "sequentialSleepDetect.h"
+#include <cmath>
+#include <algorithm>
+#include "metrics.h"
+
+using namespace std::chrono;
+
+static Counter& microsleeps = Metrics::counter("wakeomatic_microsleeps_total", "Microsleeps detected by the sequential test");
+static Histogram& alarmLatencyMs = Metrics::histogram("wakeomatic_microsleep_latency_ms", "Time from eye closure to the microsleep decision", Metrics::latencyBucketsMs());
+
+SequentialSleepDetect::SequentialSleepDetect(const Params& p) : params(p) {
+	// Wald's approximations of the decision bounds
+	upperBound = std::log((1.0 - params.missRate) / params.falseAlarmRate);
+	lowerBound = std::log(params.missRate / (1.0 - params.falseAlarmRate));
+
+	// log-likelihood ratio of asleep vs awake for a certainly closed and a certainly open frame
+	llrClosed = std::log(params.pClosedAsleep / params.pClosedAwake);
+	llrOpen = std::log((1.0 - params.pClosedAsleep) / (1.0 - params.pClosedAwake));
+}
+
+void SequentialSleepDetect::reset() {
+	llrSum = 0.0;
+	recoverySum = 0.0;
+	framesInTest = 0;
+	currentStatus = AWAKE;
+	closureRunning = false;
+	faceMissing = false;
+	detectionEvents.clear();
+}
+
+//expected log-likelihood ratio of a frame, weighted by how sure the classifier was that the eyes are closed
+double SequentialSleepDetect::frameLlr(float closedConfidence) const {
+	double c = std::clamp(static_cast<double>(closedConfidence), 0.0, 1.0);
+	return c * llrClosed + (1.0 - c) * llrOpen;
+}
+
+int SequentialSleepDetect::update(const EyeSample& sample) {
+
+	//no face: hold the running test and only report NOFACE once the face has been gone long enough
+	if (NOFACE == sample.status) {
+		if (!faceMissing) {
+			faceMissing = true;
+			faceLostAt = sample.timestamp;
+		}
+		auto missingMs = duration_cast<milliseconds>(sample.timestamp - faceLostAt).count();
+		if (missingMs >= params.noFaceTimeoutMs && NOFACE != currentStatus) {
+			currentStatus = NOFACE;
+			llrSum = 0.0;
+			recoverySum = 0.0;
+			framesInTest = 0;
+			closureRunning = false;
+		}
+		return currentStatus;
+	}
+
+	faceMissing = false;
+	if (NOFACE == currentStatus) {
+		currentStatus = AWAKE;
+	}
+
+	float closedConfidence = 1.0f - sample.openConfidence;
+	double llr = frameLlr(closedConfidence);
+
+	//driver is asleep: run the mirrored test until there is enough evidence of open eyes
+	if (SLEEPING == currentStatus) {
+		recoverySum = std::max(0.0, recoverySum - llr);
+		if (recoverySum >= -lowerBound) {
+			currentStatus = AWAKE;
+			recoverySum = 0.0;
+			closureRunning = false;
+		}
+		return currentStatus;
+	}
+
+	//remember when the current eye closure started so the alarm latency can be measured from it
+	if (closedConfidence > 0.5f) {
+		if (!closureRunning) {
+			closureRunning = true;
+			closureOnset = sample.timestamp;
+		}
+	}
+	else {
+		closureRunning = false;
+	}
+
+	llrSum += llr;
+	framesInTest++;
+
+	if (llrSum >= upperBound) {
+		DetectionEvent event;
+		event.onset = closureRunning ? closureOnset : sample.timestamp;
+		event.decision = sample.timestamp;
+		event.latencyMs = duration<double, std::milli>(event.decision - event.onset).count();
+		event.frames = framesInTest;
+		detectionEvents.push_back(event);
+		microsleeps.inc();
+		alarmLatencyMs.observe(event.latencyMs);
+
+		currentStatus = SLEEPING;
+		llrSum = 0.0;
+		recoverySum = 0.0;
+		framesInTest = 0;
+	}
+	else if (llrSum <= lowerBound) {
+		//accept "awake" and restart the test
+		llrSum = 0.0;
+		framesInTest = 0;
+	}
+
+	return currentStatus;
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <vector>
+#include <chrono>
+#include "sleepDetect.h"
+
+/** @brief Sleep decision engine based on Wald's sequential probability ratio test (SPRT).
+ *
+ * Instead of waiting for a whole buffer (see @see SleepDetect) and the fixed 1.5 s microsleep threshold in the
+ * frame processor, every frame adds its log-likelihood ratio of "asleep" versus "awake" to a running sum.
+ * The driver is declared asleep as soon as the sum crosses the upper Wald bound derived from the configured
+ * false alarm and miss rates, so strong evidence (several confidently closed frames) raises the alarm early
+ * while ambiguous evidence still needs more frames. When the sum crosses the lower bound the test accepts
+ * "awake" and restarts, which is the usual repeated SPRT used for continuous monitoring.
+ *
+ * ### USAGE:
+ * Feed every per-frame sample with @see update(), which returns the current status of the driver.
+ * The latency of every alarm is recorded and can be read with @see events().
+*/
+class SequentialSleepDetect
+{
+public:
+	/// @brief Tuning parameters of the test. Probabilities are per frame, at the camera frame rate of 30 fps.
+	struct Params {
+		/// Acceptable probability of declaring sleep while the driver is awake (alpha)
+		double falseAlarmRate = 0.01;
+		/// Acceptable probability of missing a real microsleep (beta)
+		double missRate = 0.05;
+		/// Probability that a frame shows closed eyes while the driver is asleep
+		double pClosedAsleep = 0.97;
+		/// Probability that a frame shows closed eyes while the driver is awake (blinks, misdetections).
+		/// Kept high so that an ordinary blink of up to ~400 ms at 30 fps never reaches the upper bound.
+		double pClosedAwake = 0.7;
+		/// How long the face has to be missing before NOFACE is reported, in milliseconds
+		int noFaceTimeoutMs = 1000;
+	};
+
+	/// @brief A single alarm raised by the engine.
+	struct DetectionEvent {
+		/// Capture time of the first closed-eye frame of the closure
+		std::chrono::steady_clock::time_point onset;
+		/// Capture time of the frame on which the alarm was raised
+		std::chrono::steady_clock::time_point decision;
+		/// Time from onset to decision, in milliseconds
+		double latencyMs;
+		/// Number of frames the test needed to decide
+		int frames;
+	};
+
+	SequentialSleepDetect() : SequentialSleepDetect(Params()) {}
+
+	/**
+	 * @brief Constructs the engine and precomputes the Wald bounds and per-frame log-likelihood ratios.
+	 * @param params Tuning parameters of the test.
+	 */
+	explicit SequentialSleepDetect(const Params& params);
+
+	/**
+	 * @brief Adds the evidence of one frame and returns the resulting driver status.
+	 *
+	 * @param sample Raw eye state of the frame, with its open-eye confidence and capture time.
+	 * @return int; 1 for awake, 0 for asleep, -1 for not detected.
+	 */
+	int update(const EyeSample& sample);
+
+	/// @brief Returns the current driver status without adding evidence.
+	int status() const { return currentStatus; }
+
+	/// @brief Returns the current value of the log-likelihood ratio sum.
+	double llr() const { return llrSum; }
+
+	/// @brief Returns all alarms raised so far, with their detection latency.
+	const std::vector<DetectionEvent>& events() const { return detectionEvents; }
+
+	/// @brief Clears the running test and the recorded events.
+	void reset();
+
+private:
+	double frameLlr(float closedConfidence) const;
+
+	Params params;
+	double upperBound;
+	double lowerBound;
+	double llrClosed;
+	double llrOpen;
+
+	double llrSum = 0.0;
+	double recoverySum = 0.0;
+	int framesInTest = 0;
+	int currentStatus = AWAKE;
+
+	bool closureRunning = false;
+	std::chrono::steady_clock::time_point closureOnset;
+
+	bool faceMissing = false;
+	std::chrono::steady_clock::time_point faceLostAt;
+
+	std::vector<DetectionEvent> detectionEvents;
+};
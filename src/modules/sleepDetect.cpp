@@ -1,43 +1,54 @@
-#include "sleepDetect.h"
-
-
-int SleepDetect::bufferSize() {
-	return buffer.size();
-}
-
-void SleepDetect::load(int val) {
-	buffer.push_back(val);
-}
-
-int SleepDetect::detect() {
-
-	int openCounter = 0;
-	int closedCounter = 0;
-	int nofaceCounter = 0;
-
-	for (int i = 0; i < buffer.size(); i++) {
-		if (buffer[i] == 1) {
-			openCounter += 1;
-		}
-		else if (buffer[i] == 0) {
-			closedCounter += 1;
-		}
-		else{
-			nofaceCounter += 1;
-		}
-	}
-
-	//clear the buffer
-	buffer.clear();
-
-	if (openCounter > closedCounter && openCounter > nofaceCounter) {
-		return AWAKE;
-	}
-
-	if (closedCounter > openCounter && closedCounter > nofaceCounter){
-		return SLEEPING;
-	}
-
-	return NOFACE;
-	
-}
+#include "sleepDetect.h"
+#include "metrics.h"
+
+static Counter& awakeVotes = Metrics::counter("wakeomatic_majority_decisions_total", "Majority vote decisions", "state=\"awake\"");
+static Counter& asleepVotes = Metrics::counter("wakeomatic_majority_decisions_total", "Majority vote decisions", "state=\"asleep\"");
+static Counter& noFaceVotes = Metrics::counter("wakeomatic_majority_decisions_total", "Majority vote decisions", "state=\"noface\"");
+
+int SleepDetect::bufferSize() {
+	return buffer.size();
+}
+
+void SleepDetect::load(int val) {
+	buffer.push_back(val);
+}
+
+void SleepDetect::load(const EyeSample& sample) {
+	load(sample.status);
+}
+
+int SleepDetect::detect() {
+
+	int openCounter = 0;
+	int closedCounter = 0;
+	int nofaceCounter = 0;
+
+	for (int i = 0; i < buffer.size(); i++) {
+		if (buffer[i] == 1) {
+			openCounter += 1;
+		}
+		else if (buffer[i] == 0) {
+			closedCounter += 1;
+		}
+		else{
+			nofaceCounter += 1;
+		}
+	}
+
+	//clear the buffer
+	buffer.clear();
+
+	if (openCounter > closedCounter && openCounter > nofaceCounter) {
+		awakeVotes.inc();
+		return AWAKE;
+	}
+
+	if (closedCounter > openCounter && closedCounter > nofaceCounter){
+		asleepVotes.inc();
+		return SLEEPING;
+	}
+
+	noFaceVotes.inc();
+	return NOFACE;
+	
+}
@@ -1,45 +1,66 @@
-#pragma once
-#include <vector>
-
-#define SLEEPING 0
-#define AWAKE 1
-#define NOFACE -1
-
-
-/** @brief Class that takes history of eyeStatus values and decides whether the person is awake, sleeping or not detected.
- * Currently, its only looking at the most prevalent value in the buffer holding the history.  
- * 
- * ### USAGE:
- * Firstly, load the eye status values one by one using @see load(), then call @see detect(), which returns status of the driver.
- * 	
-*/
-class SleepDetect
-{
-public:
-	/** @brief Returns the size of the buffer holding eye status history.
-	 * 
-	 * @return number of eye status values currently stored in the class.
-	 */
-	int bufferSize();
-
-	/**
-	 * @brief Loads a value of eye status into the buffer.
-	 * 
-	 * @param val An eye status value: 1 for eyes open, 0 for eyes closed, -1 for no face
-	 */
-	void load(int val);
-
-	/**
-	 * @brief Processes the buffer to decide whether the driver is asleep, awake or not detected.
-	 * Currently, the algorithm decides only according to the most frequent value in the buffer.
-	 * @return int; 1 for awake, 0 for asleep, -1 for not detected.
-	 */
-	int detect();
-	
-	SleepDetect() = default;
-
-private:
-	std::vector<int> buffer;
-
-};
-
+#pragma once
+#include <vector>
+#include <chrono>
+
+#define SLEEPING 0
+#define AWAKE 1
+#define NOFACE -1
+
+/** @brief A single per-frame eye state result as produced by the frame processor.
+ * 
+ * Carries the raw (ungated) eye status together with how confident the classifier was that the eyes are open,
+ * so that decision engines can weigh the evidence of each frame instead of only counting labels.
+ */
+struct EyeSample {
+	/// Eye status of the frame: 1 for eyes open, 0 for eyes closed, -1 for no face
+	int status = -1;
+	/// Probability in [0, 1] that the eyes are open, only meaningful when a face was found
+	float openConfidence = 0.0f;
+	/// Capture time of the frame the sample was computed from
+	std::chrono::steady_clock::time_point timestamp;
+};
+
+/** @brief Class that takes history of eyeStatus values and decides whether the person is awake, sleeping or not detected.
+ * Currently, its only looking at the most prevalent value in the buffer holding the history.  
+ * 
+ * ### USAGE:
+ * Firstly, load the eye status values one by one using @see load(), then call @see detect(), which returns status of the driver.
+ * 	
+*/
+class SleepDetect
+{
+public:
+	/** @brief Returns the size of the buffer holding eye status history.
+	 * 
+	 * @return number of eye status values currently stored in the class.
+	 */
+	int bufferSize();
+
+	/**
+	 * @brief Loads a value of eye status into the buffer.
+	 * 
+	 * @param val An eye status value: 1 for eyes open, 0 for eyes closed, -1 for no face
+	 */
+	void load(int val);
+
+	/**
+	 * @brief Loads the status of a per-frame sample into the buffer.
+	 * 
+	 * @param sample Sample produced by the frame processor, only its status is used.
+	 */
+	void load(const EyeSample& sample);
+
+	/**
+	 * @brief Processes the buffer to decide whether the driver is asleep, awake or not detected.
+	 * Currently, the algorithm decides only according to the most frequent value in the buffer.
+	 * @return int; 1 for awake, 0 for asleep, -1 for not detected.
+	 */
+	int detect();
+	
+	SleepDetect() = default;
+
+private:
+	std::vector<int> buffer;
+
+};
+
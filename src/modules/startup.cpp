@@ -0,0 +1,124 @@
+#include "startup.h"
+#include "metrics.h"
+#include <cstdio>
+#include <exception>
+
+static Gauge& firstDecisionGauge = Metrics::gauge("wakeomatic_startup_first_decision_ms", "Time from startup to the first valid sleep decision");
+
+StartupOrchestrator::StartupOrchestrator() : started(std::chrono::steady_clock::now()) {}
+
+StartupOrchestrator::~StartupOrchestrator() {
+	wait();
+}
+
+double StartupOrchestrator::elapsedMs() const {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+}
+
+void StartupOrchestrator::execute(size_t index, const std::function<bool()>& work) {
+	double start = elapsedMs();
+	bool ok = false;
+	std::string error;
+	try {
+		ok = work();
+	}
+	catch (const std::exception& e) {
+		error = e.what();
+	}
+	catch (...) {
+		error = "unknown exception";
+	}
+	double end = elapsedMs();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	Phase& phase = phaseList[index];
+	phase.startMs = start;
+	phase.endMs = end;
+	phase.ok = ok;
+	phase.error = error;
+}
+
+void StartupOrchestrator::launch(const std::string& name, ThreadPlacement::Role role, std::function<bool()> work) {
+	size_t index;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		index = phaseList.size();
+		Phase phase;
+		phase.name = name;
+		phase.concurrent = true;
+		phase.startMs = elapsedMs();
+		phaseList.push_back(phase);
+	}
+	threads.emplace_back([this, index, role, work = std::move(work)] {
+		ThreadPlacement::Scope placement(role);
+		execute(index, work);
+	});
+}
+
+bool StartupOrchestrator::wait() {
+	for (std::thread& thread : threads) {
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
+	threads.clear();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	for (const Phase& phase : phaseList) {
+		if (!phase.ok) return false;
+	}
+	return true;
+}
+
+bool StartupOrchestrator::run(const std::string& name, const std::function<bool()>& work) {
+	size_t index;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		index = phaseList.size();
+		Phase phase;
+		phase.name = name;
+		phaseList.push_back(phase);
+	}
+	execute(index, work);
+	std::lock_guard<std::mutex> lock(mutex);
+	return phaseList[index].ok;
+}
+
+void StartupOrchestrator::markFirstDecision() {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (firstDecision >= 0.0) return;
+	firstDecision = elapsedMs();
+	firstDecisionGauge.set(firstDecision);
+}
+
+double StartupOrchestrator::firstDecisionMs() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return firstDecision;
+}
+
+std::vector<StartupOrchestrator::Phase> StartupOrchestrator::phases() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return phaseList;
+}
+
+void StartupOrchestrator::report(std::ostream& out) const {
+	std::lock_guard<std::mutex> lock(mutex);
+	out << "⏱️ Startup phases (ms since start):" << std::endl;
+	char line[256];
+	for (const Phase& phase : phaseList) {
+		std::snprintf(line, sizeof(line), "   %-14s %8.1f -> %8.1f  %8.1f ms  %s%s", phase.name.c_str(), phase.startMs, phase.endMs,
+			phase.durationMs(), phase.concurrent ? "(concurrent) " : "", phase.ok ? "✅" : "❌");
+		out << line;
+		if (!phase.error.empty()) {
+			out << " " << phase.error;
+		}
+		out << std::endl;
+	}
+	if (firstDecision >= 0.0) {
+		std::snprintf(line, sizeof(line), "   first valid decision after %.1f ms", firstDecision);
+		out << line << std::endl;
+	}
+	else {
+		out << "   no valid decision yet" << std::endl;
+	}
+}
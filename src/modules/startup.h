@@ -0,0 +1,101 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "threadPlacement.h"
+
+/**
+ * @brief Runs the startup steps concurrently where they don't depend on each other and times every phase.
+ *
+ * The driver has to be protected as soon as possible after ignition. Independent steps (opening the camera,
+ * loading the cascades, setting up audio) are launched on their own threads, each placed like the pipeline
+ * thread it prepares for, so they overlap instead of adding up. Dependent steps run in order on the calling
+ * thread. Every phase is timed from the start of the orchestrator, and so is the first valid decision.
+ *
+ * A phase fails if its function returns false or throws; the exception message is kept for the report.
+ *
+ * ### USAGE:
+ *      StartupOrchestrator startup;
+ *      startup.launch("camera", ThreadPlacement::CAPTURE, [&] { camera.start(); return camera.isOpened(); });
+ *      startup.launch("classifiers", ThreadPlacement::DETECTOR, [&] { processor.emplace(params); return true; });
+ *      bool ok = startup.wait();               // joins the launched phases
+ *      startup.run("warm-up", [&] { ... });    // on this thread
+ *      ...
+ *      startup.markFirstDecision();            // first fresh decision reached the action state machine
+ *      startup.report(std::cout);
+ */
+class StartupOrchestrator
+{
+public:
+	/// @brief Timing and outcome of one phase
+	struct Phase {
+		std::string name;
+		/// Start and end, in ms since the orchestrator was created
+		double startMs = 0.0;
+		double endMs = 0.0;
+		bool ok = false;
+		/// True if it ran on its own thread
+		bool concurrent = false;
+		/// Message of the exception the phase threw, if any
+		std::string error;
+
+		double durationMs() const { return endMs - startMs; }
+	};
+
+	StartupOrchestrator();
+
+	/// @brief Joins phases that are still running.
+	~StartupOrchestrator();
+
+	StartupOrchestrator(const StartupOrchestrator&) = delete;
+	StartupOrchestrator& operator=(const StartupOrchestrator&) = delete;
+
+	/**
+	 * @brief Starts a phase on its own thread.
+	 * @param name Name in the report.
+	 * @param role Placement of the thread (the role of the pipeline thread the phase prepares for).
+	 * @param work The phase; returns false on failure.
+	 */
+	void launch(const std::string& name, ThreadPlacement::Role role, std::function<bool()> work);
+
+	/**
+	 * @brief Waits for all launched phases.
+	 * @return True if all of them succeeded.
+	 */
+	bool wait();
+
+	/**
+	 * @brief Runs a phase on the calling thread.
+	 * @return True if it succeeded.
+	 */
+	bool run(const std::string& name, const std::function<bool()>& work);
+
+	/// @brief Records the time of the first valid decision; later calls are ignored.
+	void markFirstDecision();
+
+	/// @brief Time from the start to the first valid decision in ms, negative until @see markFirstDecision().
+	double firstDecisionMs() const;
+
+	/// @brief Milliseconds since the orchestrator was created.
+	double elapsedMs() const;
+
+	/// @brief All phases in the order they were started.
+	std::vector<Phase> phases() const;
+
+	/// @brief Prints the timed breakdown of the phases and the time to the first decision.
+	void report(std::ostream& out) const;
+
+private:
+	/// Runs the phase and stores its timing in slot `index`
+	void execute(size_t index, const std::function<bool()>& work);
+
+	std::chrono::steady_clock::time_point started;
+	mutable std::mutex mutex;
+	std::vector<Phase> phaseList;
+	std::vector<std::thread> threads;
+	double firstDecision = -1.0;
+};
@@ -0,0 +1,71 @@
+#include "statusChannel.h"
+#include "metrics.h"
+#include <algorithm>
+
+static Counter& droppedTotal = Metrics::counter("wakeomatic_status_dropped_total", "Eye-state samples dropped because the status channel was full");
+
+StatusChannel::StatusChannel(size_t capacity) : slots(std::max<size_t>(1, capacity)) {
+	order.reserve(slots.size());
+}
+
+// 🚀 Producer: claim a free slot, fill it, publish it; no locks and no waiting for the consumer
+bool StatusChannel::push(const EyeSample& sample) {
+	const size_t count = slots.size();
+	for (size_t attempt = 0; attempt < count; attempt++) {
+		Slot& slot = slots[claimIndex.fetch_add(1, std::memory_order_relaxed) % count];
+		bool expected = false;
+		if (!slot.busy.compare_exchange_strong(expected, true, std::memory_order_acquire, std::memory_order_relaxed)) {
+			continue;  // Still waiting to be drained
+		}
+		slot.sample = sample;
+		const uint32_t index = static_cast<uint32_t>(&slot - slots.data());
+		uint32_t previous = head.load(std::memory_order_relaxed);
+		do {
+			slot.next = previous;
+		} while (!head.compare_exchange_weak(previous, index, std::memory_order_release, std::memory_order_relaxed));
+
+		// Wake the consumer only when the channel turns non-empty, it drains the rest in the same batch
+		if (EMPTY == previous) {
+			published.release();
+		}
+		return true;
+	}
+	droppedSamples.fetch_add(1, std::memory_order_relaxed);
+	droppedTotal.inc();
+	return false;
+}
+
+// 🚀 Consumer: one exchange takes the whole chain (newest first), which is walked back into publishing order
+size_t StatusChannel::drain(std::vector<EyeSample>& batch) {
+	batch.clear();
+	uint32_t index = head.exchange(EMPTY, std::memory_order_acquire);
+	if (EMPTY == index) return 0;
+
+	order.clear();
+	for (; EMPTY != index; index = slots[index].next) {
+		order.push_back(index);
+	}
+	for (auto it = order.rbegin(); it != order.rend(); ++it) {
+		Slot& slot = slots[*it];
+		batch.push_back(slot.sample);
+		slot.busy.store(false, std::memory_order_release);
+	}
+	return batch.size();
+}
+
+size_t StatusChannel::waitAndDrain(std::vector<EyeSample>& batch, std::chrono::milliseconds timeout) {
+	const auto deadline = std::chrono::steady_clock::now() + timeout;
+	while (0 == drain(batch)) {
+		// A release can be left over from a batch that was drained without waiting, so wake-ups may find nothing
+		if (!published.try_acquire_until(deadline)) {
+			return drain(batch);
+		}
+	}
+	return batch.size();
+}
+
+void StatusChannel::clear() {
+	std::vector<EyeSample> discarded;
+	drain(discarded);
+	while (published.try_acquire()) {}
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <semaphore>
+#include <vector>
+#include "sleepDetect.h"
+
+/**
+ * @brief Lock-free multi-producer / single-consumer channel carrying eye-state samples from the frame processing
+ * thread(s) to the decision side.
+ *
+ * Producers never block or wait for the consumer: a sample is written into a free slot of a fixed ring and the slot
+ * is published by pushing its index onto an atomic stack (a compare-and-swap loop that only contends with other
+ * producers). The consumer takes everything published so far with a single atomic exchange (one acquire for the
+ * whole batch), restores the publishing order and frees the slots. When every slot is waiting to be drained the new
+ * sample is dropped and counted rather than blocking the pipeline.
+ *
+ * A consumer with nothing to drain sleeps on a semaphore that producers release when the channel turns non-empty,
+ * which is a single atomic operation (plus a futex wake if the consumer is asleep) on the producer side.
+ *
+ * ### USAGE:
+ *      StatusChannel channel;
+ *      channel.push(sample);                            // any number of producer threads
+ *
+ *      std::vector<EyeSample> batch;                    // one consumer thread
+ *      while (channel.waitAndDrain(batch, std::chrono::seconds(5))) {
+ *          for (const EyeSample& sample : batch) { ... }   // oldest first
+ *      }
+ */
+class StatusChannel
+{
+public:
+	/// @param capacity Samples that may wait to be drained (8 s at 30 fps by default).
+	explicit StatusChannel(size_t capacity = 256);
+
+	StatusChannel(const StatusChannel&) = delete;
+	StatusChannel& operator=(const StatusChannel&) = delete;
+
+	/**
+	 * @brief Publishes a sample, without blocking.
+	 * @return False if the channel was full and the sample was dropped.
+	 */
+	bool push(const EyeSample& sample);
+
+	/**
+	 * @brief Takes every published sample, oldest first.
+	 * @param batch Cleared, then receives the samples.
+	 * @return Number of samples taken.
+	 */
+	size_t drain(std::vector<EyeSample>& batch);
+
+	/**
+	 * @brief Like @see drain(), but waits up to `timeout` for a sample if there is none.
+	 * @return Number of samples taken, 0 on timeout.
+	 */
+	size_t waitAndDrain(std::vector<EyeSample>& batch, std::chrono::milliseconds timeout);
+
+	/// @brief Discards the samples waiting to be drained (consumer side only).
+	void clear();
+
+	/// @brief Samples dropped because the channel was full.
+	uint64_t dropped() const { return droppedSamples.load(std::memory_order_relaxed); }
+
+	size_t capacity() const { return slots.size(); }
+
+private:
+	static constexpr uint32_t EMPTY = UINT32_MAX;
+
+	struct alignas(64) Slot {
+		EyeSample sample;
+		/// Next published slot (toward older samples), written before the slot is published
+		uint32_t next = EMPTY;
+		/// Held by a producer or waiting to be drained
+		std::atomic<bool> busy{false};
+	};
+
+	std::vector<Slot> slots;
+	/// Where producers look for a free slot next
+	alignas(64) std::atomic<uint32_t> claimIndex{0};
+	/// Newest published slot, EMPTY when there is nothing to drain
+	alignas(64) std::atomic<uint32_t> head{EMPTY};
+	std::atomic<uint64_t> droppedSamples{0};
+	/// Released when the channel turns non-empty
+	std::counting_semaphore<> published{0};
+	/// Consumer scratch: the drained chain in publishing order
+	std::vector<uint32_t> order;
+};
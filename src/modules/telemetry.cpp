@@ -0,0 +1,284 @@
+#include "telemetry.h"
+#include <cstring>
+
+static const char TELEMETRY_MAGIC[4] = { 'W', 'O', 'M', 'T' };
+static const uint8_t TELEMETRY_VERSION = 1;
+//largest encoding of one record: two 10-byte varints, four 5-byte varints, five count bytes and half a status byte
+static const size_t MAX_RECORD_BYTES = 48;
+
+//zigzag maps small negative and positive deltas to small unsigned values
+static uint64_t zigzag(int64_t v) {
+	return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v) {
+	return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+static void putVarint(std::vector<uint8_t>& out, uint64_t v) {
+	while (v >= 0x80) {
+		out.push_back(static_cast<uint8_t>(v) | 0x80);
+		v >>= 7;
+	}
+	out.push_back(static_cast<uint8_t>(v));
+}
+
+static bool getVarint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+	v = 0;
+	for (int shift = 0; shift < 64 && p < end; shift += 7) {
+		uint8_t byte = *p++;
+		v |= static_cast<uint64_t>(byte & 0x7f) << shift;
+		if (!(byte & 0x80)) return true;
+	}
+	return false;
+}
+
+static void putUint32(std::vector<uint8_t>& out, uint32_t v) {
+	for (int i = 0; i < 4; i++) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+static uint32_t getUint32(const uint8_t* p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+bool TelemetryWriter::open(const std::string& path) {
+	close();
+
+	bool isNew = !std::ifstream(path).good();
+	file.open(path, std::ios::binary | std::ios::app);
+	if (!file) {
+		std::cerr << "❌ ERROR: Could not open telemetry file " << path << std::endl;
+		return false;
+	}
+	if (isNew) {
+		file.write(TELEMETRY_MAGIC, sizeof(TELEMETRY_MAGIC));
+		file.put(static_cast<char>(TELEMETRY_VERSION));
+	}
+
+	filling.reserve(BLOCK_RECORDS);
+	full.reserve(MAX_PENDING_BLOCKS);
+	spare.resize(MAX_PENDING_BLOCKS);
+	for (auto& block : spare) {
+		block.reserve(BLOCK_RECORDS);
+	}
+	isOn = true;
+	writerThread = std::thread(&TelemetryWriter::threadLoop, this);
+	return true;
+}
+
+void TelemetryWriter::close() {
+	{
+		std::lock_guard<std::mutex> lock(telemetryMutex);
+		if (!isOn) return;
+		isOn = false;
+	}
+	telemetryCv.notify_one();
+	writerThread.join();
+
+	// Writer thread is gone, write whatever is left from here
+	for (const auto& block : full) {
+		writeBlock(block);
+	}
+	if (!filling.empty()) writeBlock(filling);
+	filling.clear();
+	full.clear();
+	spare.clear();
+	file.close();
+}
+
+void TelemetryWriter::log(const TelemetryRecord& record) {
+	std::unique_lock<std::mutex> lock(telemetryMutex);
+	if (!isOn) return;
+
+	if (filling.size() < BLOCK_RECORDS) {
+		filling.push_back(record);  // Within the reserved capacity, no allocation
+		return;
+	}
+
+	// The block is full: hand it to the writer thread before adding the record
+	if (spare.empty()) {
+		// Writer is too far behind, drop rather than block the pipeline or grow the block
+		droppedRecords++;
+		return;
+	}
+	full.push_back(std::move(filling));
+	filling = std::move(spare.back());  // Keeps its capacity, no allocation
+	spare.pop_back();
+	filling.push_back(record);
+	lock.unlock();
+	telemetryCv.notify_one();
+}
+
+void TelemetryWriter::threadLoop() {
+	std::unique_lock<std::mutex> lock(telemetryMutex);
+	while (true) {
+		telemetryCv.wait(lock, [this] { return !full.empty() || !isOn; });
+		if (full.empty()) break;
+
+		std::vector<TelemetryRecord> block = std::move(full.front());
+		full.erase(full.begin());
+
+		lock.unlock();
+		writeBlock(block);
+		block.clear();
+		lock.lock();
+
+		spare.push_back(std::move(block));
+	}
+}
+
+void TelemetryWriter::writeBlock(const std::vector<TelemetryRecord>& records) {
+	encoded.clear();
+	encodeBlock(records, encoded);
+
+	std::vector<uint8_t> blockHeader;
+	putUint32(blockHeader, static_cast<uint32_t>(records.size()));
+	putUint32(blockHeader, static_cast<uint32_t>(encoded.size()));
+	file.write(reinterpret_cast<const char*>(blockHeader.data()), blockHeader.size());
+	file.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+	file.flush();
+}
+
+void TelemetryWriter::encodeBlock(const std::vector<TelemetryRecord>& records, std::vector<uint8_t>& out) {
+	// Timestamps: delta of the delta to the previous frame, usually just the jitter of the frame period
+	int64_t previous = 0;
+	int64_t previousDelta = 0;
+	for (const auto& r : records) {
+		int64_t delta = r.timestampUs - previous;
+		putVarint(out, zigzag(delta - previousDelta));
+		previousDelta = delta;
+		previous = r.timestampUs;
+	}
+
+	int64_t lastProcessing = 0;
+	for (const auto& r : records) {
+		putVarint(out, zigzag(static_cast<int64_t>(r.processingUs) - lastProcessing));
+		lastProcessing = r.processingUs;
+	}
+
+	// Face rectangle, one column per coordinate, deltas to the previous frame (the face barely moves)
+	int32_t TelemetryRecord::* rectColumns[] = { &TelemetryRecord::faceX, &TelemetryRecord::faceY, &TelemetryRecord::faceWidth, &TelemetryRecord::faceHeight };
+	for (auto column : rectColumns) {
+		int32_t last = 0;
+		for (const auto& r : records) {
+			putVarint(out, zigzag(r.*column - last));
+			last = r.*column;
+		}
+	}
+
+	uint8_t TelemetryRecord::* countColumns[] = { &TelemetryRecord::faces, &TelemetryRecord::eyes, &TelemetryRecord::eyesOpen, &TelemetryRecord::keypoints, &TelemetryRecord::confidence };
+	for (auto column : countColumns) {
+		for (const auto& r : records) {
+			out.push_back(r.*column);
+		}
+	}
+
+	// Statuses: (status + 1) in two bits, raw and gated status of a record in one nibble, two records per byte
+	for (size_t i = 0; i < records.size(); i += 2) {
+		uint8_t byte = 0;
+		for (size_t j = 0; j < 2 && i + j < records.size(); j++) {
+			const auto& r = records[i + j];
+			uint8_t nibble = static_cast<uint8_t>((r.rawStatus + 1) & 0x3) | static_cast<uint8_t>(((r.gatedStatus + 1) & 0x3) << 2);
+			byte |= nibble << (4 * j);
+		}
+		out.push_back(byte);
+	}
+}
+
+//block header of a torn write (power cut) can hold anything, reject counts and sizes the writer never produces
+static bool plausibleBlock(uint32_t count, size_t size) {
+	return count <= TelemetryWriter::BLOCK_RECORDS && size <= count * MAX_RECORD_BYTES;
+}
+
+static bool decodeColumns(const uint8_t* p, size_t size, uint32_t count, TelemetryRecord* block) {
+	const uint8_t* end = p + size;
+	uint64_t v;
+
+	int64_t previous = 0;
+	int64_t previousDelta = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		if (!getVarint(p, end, v)) return false;
+		previousDelta += unzigzag(v);
+		previous += previousDelta;
+		block[i].timestampUs = previous;
+	}
+
+	int64_t lastProcessing = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		if (!getVarint(p, end, v)) return false;
+		lastProcessing += unzigzag(v);
+		block[i].processingUs = static_cast<uint32_t>(lastProcessing);
+	}
+
+	int32_t TelemetryRecord::* rectColumns[] = { &TelemetryRecord::faceX, &TelemetryRecord::faceY, &TelemetryRecord::faceWidth, &TelemetryRecord::faceHeight };
+	for (auto column : rectColumns) {
+		int32_t last = 0;
+		for (uint32_t i = 0; i < count; i++) {
+			if (!getVarint(p, end, v)) return false;
+			last += static_cast<int32_t>(unzigzag(v));
+			block[i].*column = last;
+		}
+	}
+
+	uint8_t TelemetryRecord::* countColumns[] = { &TelemetryRecord::faces, &TelemetryRecord::eyes, &TelemetryRecord::eyesOpen, &TelemetryRecord::keypoints, &TelemetryRecord::confidence };
+	for (auto column : countColumns) {
+		if (end - p < static_cast<ptrdiff_t>(count)) return false;
+		for (uint32_t i = 0; i < count; i++) {
+			block[i].*column = *p++;
+		}
+	}
+
+	if (end - p < static_cast<ptrdiff_t>((count + 1) / 2)) return false;
+	for (uint32_t i = 0; i < count; i++) {
+		uint8_t nibble = (p[i / 2] >> (4 * (i % 2))) & 0xf;
+		block[i].rawStatus = static_cast<int8_t>(nibble & 0x3) - 1;
+		block[i].gatedStatus = static_cast<int8_t>((nibble >> 2) & 0x3) - 1;
+	}
+	return true;
+}
+
+bool TelemetryReader::decodeBlock(const uint8_t* p, size_t size, uint32_t count, std::vector<TelemetryRecord>& records) {
+	if (!plausibleBlock(count, size)) return false;
+	size_t first = records.size();
+	records.resize(first + count);
+	if (decodeColumns(p, size, count, records.data() + first)) return true;
+	records.resize(first);  // No half-decoded rows from a torn block
+	return false;
+}
+
+bool TelemetryReader::readAll(const std::string& path, std::vector<TelemetryRecord>& records) {
+	std::ifstream in(path, std::ios::binary);
+	char magic[4];
+	if (!in.read(magic, sizeof(magic)) || 0 != std::memcmp(magic, TELEMETRY_MAGIC, sizeof(magic)) || TELEMETRY_VERSION != in.get()) {
+		std::cerr << "❌ ERROR: " << path << " is not a telemetry file" << std::endl;
+		return false;
+	}
+
+	records.clear();
+	uint8_t blockHeader[8];
+	std::vector<uint8_t> payload;
+	while (in.read(reinterpret_cast<char*>(blockHeader), sizeof(blockHeader))) {
+		uint32_t count = getUint32(blockHeader);
+		uint32_t size = getUint32(blockHeader + 4);
+		if (!plausibleBlock(count, size)) {
+			std::cerr << "⚠️ WARNING: Corrupt telemetry block header in " << path << std::endl;
+			return false;
+		}
+		payload.resize(size);
+		if (!in.read(reinterpret_cast<char*>(payload.data()), size) || !decodeBlock(payload.data(), size, count, records)) {
+			std::cerr << "⚠️ WARNING: Truncated telemetry block in " << path << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+void TelemetryReader::writeCsv(const std::vector<TelemetryRecord>& records, std::ostream& out) {
+	out << "timestamp_us,processing_us,face_x,face_y,face_width,face_height,faces,eyes,eyes_open,keypoints,confidence,raw_status,gated_status\n";
+	for (const auto& r : records) {
+		out << r.timestampUs << ',' << r.processingUs << ','
+			<< r.faceX << ',' << r.faceY << ',' << r.faceWidth << ',' << r.faceHeight << ','
+			<< int(r.faces) << ',' << int(r.eyes) << ',' << int(r.eyesOpen) << ',' << int(r.keypoints) << ','
+			<< r.confidence / 255.0 << ',' << int(r.rawStatus) << ',' << int(r.gatedStatus) << '\n';
+	}
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+
+/// @brief Everything `FrameProcessor::processFrame` found in one frame
+struct TelemetryRecord {
+	/// Capture time in microseconds of the steady clock
+	int64_t timestampUs = 0;
+	/// Time spent in processFrame, in microseconds
+	uint32_t processingUs = 0;
+	/// First detected face, all zero when no face was found
+	int32_t faceX = 0;
+	int32_t faceY = 0;
+	int32_t faceWidth = 0;
+	int32_t faceHeight = 0;
+	uint8_t faces = 0;
+	uint8_t eyes = 0;
+	uint8_t eyesOpen = 0;
+	/// Blob keypoints found over all eyes
+	uint8_t keypoints = 0;
+	/// Open-eye confidence scaled to 0-255
+	uint8_t confidence = 0;
+	/// Raw eye status of the frame (-1, 0, 1)
+	int8_t rawStatus = -1;
+	/// Status returned by processFrame after the microsleep time gate (-1, 0, 1)
+	int8_t gatedStatus = -1;
+};
+
+/**
+ * @brief Compact binary per-frame telemetry log.
+ *
+ * Records are collected in memory and written by a background thread in blocks of @see BLOCK_RECORDS
+ * records. Each block is stored column by column: timestamps as zigzag varint delta-of-deltas, processing
+ * times and face rectangles as zigzag varint deltas from the previous record, counts and confidence as one
+ * byte each and the two statuses bit-packed into two bits each. A typical frame takes about 12 bytes,
+ * against ~60 bytes as CSV text.
+ *
+ * File layout: the magic `WOMT` and a version byte, followed by blocks of
+ * `[uint32 record count][uint32 payload bytes][payload]`.
+ *
+ * ### USAGE:
+ *      TelemetryWriter telemetry;
+ *      telemetry.open("telemetry.womt");
+ *      telemetry.log(record);   // from the frame processing thread, never does I/O
+ *      ...
+ *      std::vector<TelemetryRecord> records;
+ *      TelemetryReader::readAll("telemetry.womt", records);
+ *      TelemetryReader::writeCsv(records, std::cout);
+ */
+class TelemetryWriter
+{
+public:
+	/// Number of records encoded into one block
+	static const size_t BLOCK_RECORDS = 256;
+
+	/// Number of full blocks that may wait for the writer thread (e.g. during a slow SD card flush)
+	static const size_t MAX_PENDING_BLOCKS = 8;
+
+	TelemetryWriter() = default;
+
+	/** Destructor (Writes the last partial block and stops the writer thread) */
+	~TelemetryWriter() { close(); }
+
+	/**
+	 * @brief Opens (appends to) a telemetry file and starts the writer thread.
+	 * @param path Telemetry file.
+	 * @return True if the file could be opened.
+	 */
+	bool open(const std::string& path);
+
+	/// @brief Writes the remaining records and stops the writer thread.
+	void close();
+
+	/**
+	 * @brief Adds a record. Only copies it into a preallocated buffer, the encoding and I/O happen on the writer thread.
+	 * If the writer falls @see MAX_PENDING_BLOCKS blocks behind, the record is dropped and counted.
+	 */
+	void log(const TelemetryRecord& record);
+
+	/// @brief Number of records dropped because the writer thread could not keep up.
+	uint64_t dropped() const { return droppedRecords; }
+
+	/// @brief Encodes a block of records in the columnar format (without the block header).
+	static void encodeBlock(const std::vector<TelemetryRecord>& records, std::vector<uint8_t>& out);
+
+private:
+	void threadLoop();
+	void writeBlock(const std::vector<TelemetryRecord>& records);
+
+	std::ofstream file;
+	bool isOn = false;
+	std::mutex telemetryMutex;
+	std::condition_variable telemetryCv;
+	std::thread writerThread;
+
+	// All blocks are preallocated by open(), log() only moves them between these lists
+	std::vector<TelemetryRecord> filling;             // Filled by log()
+	std::vector<std::vector<TelemetryRecord>> full;   // Waiting for the writer thread, oldest first
+	std::vector<std::vector<TelemetryRecord>> spare;  // Written and cleared, ready for reuse
+	std::atomic<uint64_t> droppedRecords{0};
+	std::vector<uint8_t> encoded;
+};
+
+/// @brief Reads telemetry files written by @see TelemetryWriter
+class TelemetryReader
+{
+public:
+	/**
+	 * @brief Decodes every block of a telemetry file.
+	 * @param path Telemetry file.
+	 * @param records Decoded records, in the order they were logged; only complete blocks, also when reading fails.
+	 * @return True if the file was read completely.
+	 */
+	static bool readAll(const std::string& path, std::vector<TelemetryRecord>& records);
+
+	/// @brief Decodes one block payload, appending its records; appends nothing if the block is corrupt or torn.
+	static bool decodeBlock(const uint8_t* data, size_t size, uint32_t count, std::vector<TelemetryRecord>& records);
+
+	/// @brief Writes records as CSV with a header line.
+	static void writeCsv(const std::vector<TelemetryRecord>& records, std::ostream& out);
+};
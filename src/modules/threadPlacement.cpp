@@ -0,0 +1,129 @@
+#include "threadPlacement.h"
+#include <opencv2/core.hpp>
+#include <thread>
+#include <ctime>
+
+#ifdef _OPENMP
+	#include <omp.h>
+#endif
+
+#ifdef __linux__
+	#include <pthread.h>
+	#include <sched.h>
+	#include <unistd.h>
+	#include <sys/resource.h>
+	#include <sys/syscall.h>
+#endif
+
+std::mutex ThreadPlacement::placementMutex;
+ThreadPlacement::RoleConfig ThreadPlacement::configs[ThreadPlacement::ROLE_COUNT];
+std::vector<ThreadPlacement::Usage> ThreadPlacement::usage;
+
+const char* ThreadPlacement::roleName(Role role) {
+	switch (role) {
+		case CAPTURE: return "capture";
+		case DETECTOR: return "detector";
+		case ACTION: return "action";
+		case MAIN: return "main";
+		case METRICS: return "metrics";
+		default: return "unknown";
+	}
+}
+
+void ThreadPlacement::configure(Role role, const RoleConfig& config) {
+	std::lock_guard<std::mutex> lock(placementMutex);
+	configs[role] = config;
+}
+
+void ThreadPlacement::configureDefaults() {
+	// Metrics are served at the lowest priority wherever they run, scraping must never delay the pipeline
+	configure(METRICS, { {}, 0, 19 });
+	if (std::thread::hardware_concurrency() < 4) {
+		return;
+	}
+	configure(CAPTURE, { {0}, 20, -5 });
+	configure(DETECTOR, { {1, 2}, 0, 0 });
+	configure(ACTION, { {3}, 30, -5 });
+	configure(MAIN, { {3}, 0, 0 });
+	configure(METRICS, { {3}, 0, 19 });
+}
+
+void ThreadPlacement::limitLibraryThreads(int workers) {
+	cv::setNumThreads(workers);
+	#ifdef _OPENMP
+	omp_set_num_threads(workers);
+	#endif
+}
+
+double ThreadPlacement::threadCpuMs() {
+	#ifdef __linux__
+	timespec ts;
+	if (0 == clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts)) {
+		return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+	}
+	#endif
+	return 0.0;
+}
+
+bool ThreadPlacement::apply(Role role) {
+	RoleConfig config;
+	{
+		std::lock_guard<std::mutex> lock(placementMutex);
+		config = configs[role];
+	}
+
+	bool applied = true;
+
+	#ifdef __linux__
+	if (!config.cores.empty()) {
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (int core : config.cores) {
+			CPU_SET(core, &set);
+		}
+		if (0 != pthread_setaffinity_np(pthread_self(), sizeof(set), &set)) {
+			std::cerr << "⚠️ WARNING: Could not pin " << roleName(role) << " thread to its cores." << std::endl;
+			applied = false;
+		}
+	}
+
+	if (config.fifoPriority > 0) {
+		sched_param param{};
+		param.sched_priority = config.fifoPriority;
+		if (0 == pthread_setschedparam(pthread_self(), SCHED_FIFO, &param)) {
+			return applied;
+		}
+		// Usually EPERM without CAP_SYS_NICE, fall back to the nice value
+		std::cerr << "⚠️ WARNING: No permission for SCHED_FIFO on " << roleName(role) << " thread, using nice " << config.nice << "." << std::endl;
+		applied = false;
+	}
+
+	if (0 != config.nice) {
+		pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+		if (0 != setpriority(PRIO_PROCESS, tid, config.nice)) {
+			std::cerr << "⚠️ WARNING: Could not set nice " << config.nice << " on " << roleName(role) << " thread." << std::endl;
+			applied = false;
+		}
+	}
+	#endif
+
+	return applied;
+}
+
+ThreadPlacement::Scope::Scope(Role r) : role(r) {
+	apply(role);
+	startCpuMs = threadCpuMs();
+}
+
+ThreadPlacement::Scope::~Scope() {
+	double cpuMs = threadCpuMs() - startCpuMs;
+	std::lock_guard<std::mutex> lock(placementMutex);
+	usage.push_back({ role, cpuMs });
+}
+
+void ThreadPlacement::report(std::ostream& out) {
+	std::lock_guard<std::mutex> lock(placementMutex);
+	for (const auto& u : usage) {
+		out << "🧵 " << roleName(u.role) << " thread CPU time: " << u.cpuMs << " ms" << std::endl;
+	}
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <mutex>
+#include <iostream>
+
+/**
+ * @brief Pins the pipeline threads to cores and sets their scheduling priority.
+ *
+ * Every pipeline thread has a role. The placement of each role (cores, SCHED_FIFO priority or nice value)
+ * is configured once at startup with @see configure(), and applied by the thread itself by creating a
+ * @see ThreadPlacement::Scope at the top of its loop. If the process lacks the privileges for real-time
+ * scheduling, the thread falls back to its nice value and finally to the default policy, with a warning.
+ *
+ * The scope also measures the CPU time consumed by the thread, which @see report() prints at exit.
+ *
+ * ### USAGE:
+ *      ThreadPlacement::configureDefaults();
+ *      ThreadPlacement::limitLibraryThreads(1);
+ *      ...
+ *      void Camera::threadLoop() {
+ *          ThreadPlacement::Scope placement(ThreadPlacement::CAPTURE);
+ *          ...
+ *      }
+ *      ...
+ *      ThreadPlacement::report(std::cout);
+ *
+ * Only has an effect on Linux, on other systems the threads are left to the scheduler.
+ */
+class ThreadPlacement
+{
+public:
+	/// @brief Role of a thread in the pipeline
+	enum Role {
+		CAPTURE,
+		DETECTOR,
+		ACTION,
+		MAIN,
+		METRICS,
+		ROLE_COUNT
+	};
+
+	/// @brief Placement of one role
+	struct RoleConfig {
+		/// Cores the thread may run on, empty for all cores
+		std::vector<int> cores;
+		/// SCHED_FIFO priority (1-99), 0 to keep the default policy
+		int fifoPriority = 0;
+		/// Nice value used when SCHED_FIFO is not requested or not permitted
+		int nice = 0;
+	};
+
+	/// @brief Sets the placement of a role. Must be called before the thread of that role starts.
+	static void configure(Role role, const RoleConfig& config);
+
+	/**
+	 * @brief Sets the default placement for a 4-core Raspberry Pi.
+	 * Capture on core 0, detector on cores 1-2, action and main loop on core 3. The capture and action
+	 * threads get SCHED_FIFO priorities since they are short and latency sensitive, the detector is the
+	 * long running job and keeps the default policy. The metrics server runs at nice 19 next to them.
+	 * On machines with fewer cores the roles are left unpinned.
+	 */
+	static void configureDefaults();
+
+	/**
+	 * @brief Caps the worker thread pools of OpenCV and OpenMP so that they don't oversubscribe the cores
+	 * owned by the pipeline threads.
+	 * @param workers Number of worker threads each library may use, 1 disables the pools.
+	 */
+	static void limitLibraryThreads(int workers);
+
+	/// @brief Prints the CPU time consumed by every thread that has finished its scope.
+	static void report(std::ostream& out);
+
+	/// @brief Applies the placement of a role to the calling thread and records its CPU time on destruction.
+	class Scope {
+	public:
+		explicit Scope(Role role);
+		~Scope();
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	private:
+		Role role;
+		double startCpuMs;
+	};
+
+	/// @brief Returns the name of a role
+	static const char* roleName(Role role);
+
+private:
+	/// Applies the placement of a role to the calling thread, returns true if everything requested was applied.
+	static bool apply(Role role);
+
+	/// CPU time consumed by the calling thread in milliseconds
+	static double threadCpuMs();
+
+	struct Usage {
+		Role role;
+		double cpuMs;
+	};
+
+	static std::mutex placementMutex;
+	static RoleConfig configs[ROLE_COUNT];
+	static std::vector<Usage> usage;
+};
@@ -0,0 +1,467 @@
+#include "v4l2Capture.h"
+#include "metrics.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+	#include <fcntl.h>
+	#include <poll.h>
+	#include <sys/ioctl.h>
+	#include <sys/mman.h>
+	#include <unistd.h>
+	#include <linux/videodev2.h>
+#endif
+
+static Counter& starvedReads = Metrics::counter("wakeomatic_v4l2_starved_total", "Reads that timed out while the pipeline held every driver buffer");
+static Counter& shortFrames = Metrics::counter("wakeomatic_v4l2_short_frames_total", "Driver buffers with fewer bytes than a frame");
+static Gauge& buffersHeld = Metrics::gauge("wakeomatic_v4l2_buffers_in_use", "Driver buffers held by frames in the pipeline");
+
+// ---------------------------------------------------------------------------------------------------------------
+// V4l2Device
+
+V4l2Device::Format V4l2Device::makeFormat(uint32_t fourcc, int width, int height) {
+	Format format;
+	format.fourcc = fourcc;
+	format.width = width;
+	format.height = height;
+	format.bytesPerLine = YUYV == fourcc ? 2 * width : width;
+	size_t luma = size_t(width) * height;
+	format.imageBytes = YUYV == fourcc ? 2 * luma : (YU12 == fourcc || NV12 == fourcc) ? luma + 2 * (size_t((width + 1) / 2) * ((height + 1) / 2)) : luma;
+	return format;
+}
+
+std::string V4l2Device::fourccName(uint32_t fourcc) {
+	return { char(fourcc & 0xFF), char((fourcc >> 8) & 0xFF), char((fourcc >> 16) & 0xFF), char((fourcc >> 24) & 0xFF) };
+}
+
+// ---------------------------------------------------------------------------------------------------------------
+// V4l2KernelDevice
+
+#ifdef __linux__
+/// ioctl that is retried when a signal interrupts it
+static int xioctl(int fd, unsigned long request, void* arg) {
+	int result;
+	do {
+		result = ioctl(fd, request, arg);
+	} while (-1 == result && EINTR == errno);
+	return result;
+}
+#endif
+
+V4l2KernelDevice::~V4l2KernelDevice() {
+	#ifdef __linux__
+	streamOff();
+	unmapBuffers();
+	if (fd >= 0) {
+		::close(fd);
+	}
+	#endif
+}
+
+bool V4l2KernelDevice::open() {
+	#ifndef __linux__
+	std::cerr << "⚠️ WARNING: V4L2 capture is not available on this system." << std::endl;
+	return false;
+	#else
+	fd = ::open(path.c_str(), O_RDWR | O_NONBLOCK);
+	if (fd < 0) {
+		std::cerr << "⚠️ WARNING: Could not open " << path << ": " << std::strerror(errno) << std::endl;
+		return false;
+	}
+
+	v4l2_capability capability{};
+	if (-1 == xioctl(fd, VIDIOC_QUERYCAP, &capability)) {
+		std::cerr << "⚠️ WARNING: " << path << " is not a V4L2 device" << std::endl;
+		return false;
+	}
+	uint32_t caps = (capability.capabilities & V4L2_CAP_DEVICE_CAPS) ? capability.device_caps : capability.capabilities;
+	if (!(caps & V4L2_CAP_VIDEO_CAPTURE) || !(caps & V4L2_CAP_STREAMING)) {
+		std::cerr << "⚠️ WARNING: " << path << " cannot stream video captures" << std::endl;
+		return false;
+	}
+	return true;
+	#endif
+}
+
+bool V4l2KernelDevice::setFormat(Format& format, int fps) {
+	#ifndef __linux__
+	return false;
+	#else
+	v4l2_format request{};
+	request.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	request.fmt.pix.width = format.width;
+	request.fmt.pix.height = format.height;
+	request.fmt.pix.pixelformat = format.fourcc;
+	request.fmt.pix.field = V4L2_FIELD_NONE;
+	if (-1 == xioctl(fd, VIDIOC_S_FMT, &request)) {
+		return false;
+	}
+	format.fourcc = request.fmt.pix.pixelformat;
+	format.width = request.fmt.pix.width;
+	format.height = request.fmt.pix.height;
+	format.bytesPerLine = request.fmt.pix.bytesperline;
+	format.imageBytes = request.fmt.pix.sizeimage;
+
+	// Not every driver can set the frame rate, the default is fine then
+	v4l2_streamparm parameters{};
+	parameters.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	parameters.parm.capture.timeperframe.numerator = 1;
+	parameters.parm.capture.timeperframe.denominator = fps;
+	xioctl(fd, VIDIOC_S_PARM, &parameters);
+	return true;
+	#endif
+}
+
+std::vector<V4l2Device::Buffer> V4l2KernelDevice::mapBuffers(int count) {
+	#ifdef __linux__
+	unmapBuffers();
+	v4l2_requestbuffers request{};
+	request.count = count;
+	request.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	request.memory = V4L2_MEMORY_MMAP;
+	if (-1 == xioctl(fd, VIDIOC_REQBUFS, &request) || 0 == request.count) {
+		std::cerr << "❌ ERROR: " << path << " has no mmap buffers" << std::endl;
+		return {};
+	}
+
+	for (uint32_t i = 0; i < request.count; i++) {
+		v4l2_buffer buffer{};
+		buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		buffer.memory = V4L2_MEMORY_MMAP;
+		buffer.index = i;
+		if (-1 == xioctl(fd, VIDIOC_QUERYBUF, &buffer)) {
+			unmapBuffers();
+			return {};
+		}
+		void* addr = mmap(nullptr, buffer.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, buffer.m.offset);
+		if (MAP_FAILED == addr) {
+			std::cerr << "❌ ERROR: Could not map buffer " << i << " of " << path << std::endl;
+			unmapBuffers();
+			return {};
+		}
+		buffers.push_back({ static_cast<uint8_t*>(addr), buffer.length });
+	}
+	#endif
+	return buffers;
+}
+
+void V4l2KernelDevice::unmapBuffers() {
+	#ifdef __linux__
+	if (buffers.empty()) return;
+	for (const Buffer& buffer : buffers) {
+		munmap(buffer.data, buffer.length);
+	}
+	buffers.clear();
+	v4l2_requestbuffers release{};
+	release.count = 0;
+	release.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	release.memory = V4L2_MEMORY_MMAP;
+	xioctl(fd, VIDIOC_REQBUFS, &release);
+	#endif
+}
+
+bool V4l2KernelDevice::queue(int index) {
+	#ifndef __linux__
+	return false;
+	#else
+	v4l2_buffer buffer{};
+	buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	buffer.memory = V4L2_MEMORY_MMAP;
+	buffer.index = index;
+	return -1 != xioctl(fd, VIDIOC_QBUF, &buffer);
+	#endif
+}
+
+int V4l2KernelDevice::dequeue(int timeoutMs, size_t& bytesUsed) {
+	#ifndef __linux__
+	return -1;
+	#else
+	pollfd descriptor{ fd, POLLIN, 0 };
+	int ready;
+	do {
+		ready = poll(&descriptor, 1, timeoutMs);
+	} while (-1 == ready && EINTR == errno);
+	if (ready <= 0) return -1;
+
+	v4l2_buffer buffer{};
+	buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	buffer.memory = V4L2_MEMORY_MMAP;
+	if (-1 == xioctl(fd, VIDIOC_DQBUF, &buffer)) return -1;
+	bytesUsed = buffer.bytesused;
+	return buffer.index;
+	#endif
+}
+
+bool V4l2KernelDevice::streamOn() {
+	#ifndef __linux__
+	return false;
+	#else
+	v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	streaming = -1 != xioctl(fd, VIDIOC_STREAMON, &type);
+	return streaming;
+	#endif
+}
+
+void V4l2KernelDevice::streamOff() {
+	#ifdef __linux__
+	if (!streaming) return;
+	v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	xioctl(fd, VIDIOC_STREAMOFF, &type);
+	streaming = false;
+	#endif
+}
+
+// ---------------------------------------------------------------------------------------------------------------
+// V4l2FileDevice
+
+V4l2FileDevice::V4l2FileDevice(const std::string& path, const Format& format, double fps, Clock* clock)
+	: path(path), fileFormat(format), clock(clock) {
+	period = fps > 0.0 ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / fps))
+		: std::chrono::steady_clock::duration::zero();
+}
+
+bool V4l2FileDevice::open() {
+	file.open(path, std::ios::binary | std::ios::ate);
+	if (!file.is_open() || static_cast<size_t>(file.tellg()) < fileFormat.imageBytes) {
+		std::cerr << "❌ ERROR: " << path << " holds no " << fourccName(fileFormat.fourcc) << " frame of "
+			<< fileFormat.width << "x" << fileFormat.height << std::endl;
+		return false;
+	}
+	file.seekg(0);
+	return true;
+}
+
+bool V4l2FileDevice::setFormat(Format& format, int) {
+	format = fileFormat;
+	return true;
+}
+
+std::vector<V4l2Device::Buffer> V4l2FileDevice::mapBuffers(int count) {
+	storage.assign(count, std::vector<uint8_t>(fileFormat.imageBytes));
+	std::vector<Buffer> buffers;
+	for (std::vector<uint8_t>& memory : storage) {
+		buffers.push_back({ memory.data(), memory.size() });
+	}
+	return buffers;
+}
+
+bool V4l2FileDevice::queue(int index) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queued.push_back(index);
+	}
+	queuedCv.notify_one();
+	return true;
+}
+
+int V4l2FileDevice::queuedBuffers() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return static_cast<int>(queued.size());
+}
+
+int V4l2FileDevice::dequeue(int timeoutMs, size_t& bytesUsed) {
+	int index;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		if (!queuedCv.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return !queued.empty() || !streaming; }) || !streaming) {
+			return -1;
+		}
+		index = queued.front();
+		queued.pop_front();
+	}
+
+	// The camera delivers at its frame rate
+	if (period > std::chrono::steady_clock::duration::zero()) {
+		auto now = clock->now();
+		if (nextFrame > now) {
+			clock->sleepFor(nextFrame - now);
+		}
+		nextFrame = std::max(nextFrame, now) + period;
+	}
+
+	if (!file.read(reinterpret_cast<char*>(storage[index].data()), fileFormat.imageBytes)) {
+		file.clear();
+		file.seekg(0);
+		file.read(reinterpret_cast<char*>(storage[index].data()), fileFormat.imageBytes);
+	}
+	bytesUsed = fileFormat.imageBytes;
+	delivered++;
+	return index;
+}
+
+bool V4l2FileDevice::streamOn() {
+	streaming = true;
+	nextFrame = clock->now();
+	return true;
+}
+
+void V4l2FileDevice::streamOff() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		streaming = false;
+	}
+	queuedCv.notify_all();
+}
+
+// ---------------------------------------------------------------------------------------------------------------
+// V4l2Capture
+
+/// Device, buffers and the allocator of the frame views; lives until the capture and every frame are gone
+struct V4l2Capture::Shared : public cv::MatAllocator {
+	/// Kept by every frame view, gives its buffer back when the view's last copy is released
+	struct Lease {
+		std::shared_ptr<Shared> owner;
+		int index;
+	};
+
+	explicit Shared(std::unique_ptr<V4l2Device> device) : device(std::move(device)) {}
+
+	// New images made through a view's allocator (e.g. create() with another size) are ordinary images
+	cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step, cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override {
+		return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+	}
+
+	bool allocate(cv::UMatData* data, cv::AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const override {
+		return cv::Mat::getStdAllocator()->allocate(data, accessFlags, usageFlags);
+	}
+
+	void deallocate(cv::UMatData* data) const override {
+		Lease* lease = static_cast<Lease*>(data->userdata);
+		delete data;
+		lease->owner->requeue(lease->index);
+		delete lease;  // may be the last reference to this
+	}
+
+	void requeue(int index) {
+		buffersHeld.set(--inUse);
+		if (streaming) {
+			device->queue(index);
+		}
+	}
+
+	std::unique_ptr<V4l2Device> device;
+	std::vector<V4l2Device::Buffer> buffers;
+	V4l2Device::Format format;
+	bool zeroCopy = false;
+	std::atomic<bool> streaming{false};
+	std::atomic<int> inUse{0};
+};
+
+V4l2Capture::V4l2Capture(std::unique_ptr<V4l2Device> device) : shared(std::make_shared<Shared>(std::move(device))) {}
+
+V4l2Capture::~V4l2Capture() {
+	close();
+}
+
+bool V4l2Capture::open(int width, int height, int fps, int buffers) {
+	if (!shared || shared->streaming) return false;
+	V4l2Device& device = *shared->device;
+	if (!device.open()) return false;
+
+	// A luma plane of its own first: those frames need neither a conversion nor a copy
+	bool negotiated = false;
+	for (uint32_t fourcc : { V4l2Device::GREY, V4l2Device::YU12, V4l2Device::NV12, V4l2Device::YUYV }) {
+		V4l2Device::Format format = V4l2Device::makeFormat(fourcc, width, height);
+		if (device.setFormat(format, fps) && format.fourcc == fourcc) {
+			shared->format = format;
+			negotiated = true;
+			break;
+		}
+	}
+	if (!negotiated) {
+		std::cerr << "❌ ERROR: " << device.name() << " offers none of GREY, YU12, NV12 and YUYV" << std::endl;
+		return false;
+	}
+	shared->zeroCopy = V4l2Device::YUYV != shared->format.fourcc;
+
+	shared->buffers = device.mapBuffers(buffers);
+	if (shared->buffers.empty()) return false;
+	for (size_t i = 0; i < shared->buffers.size(); i++) {
+		if (!device.queue(static_cast<int>(i))) {
+			std::cerr << "❌ ERROR: Could not queue the buffers of " << device.name() << std::endl;
+			return false;
+		}
+	}
+	if (!device.streamOn()) {
+		std::cerr << "❌ ERROR: Could not start streaming from " << device.name() << std::endl;
+		return false;
+	}
+	shared->streaming = true;
+
+	std::cout << "✅ V4L2 capture from " << device.name() << ": " << V4l2Device::fourccName(shared->format.fourcc) << " "
+		<< shared->format.width << "x" << shared->format.height << ", " << shared->buffers.size() << " buffers"
+		<< (shared->zeroCopy ? ", zero copy" : "") << std::endl;
+	return true;
+}
+
+bool V4l2Capture::isOpened() const {
+	return shared && shared->streaming;
+}
+
+bool V4l2Capture::read(cv::Mat& frame, int timeoutMs) {
+	if (!isOpened()) return false;
+	const V4l2Device::Format& format = shared->format;
+
+	size_t bytesUsed = 0;
+	int index = shared->device->dequeue(timeoutMs, bytesUsed);
+	if (index < 0) {
+		if (shared->inUse >= static_cast<int>(shared->buffers.size())) {
+			starvedReads.inc();
+		}
+		return false;
+	}
+	if (bytesUsed < size_t(format.bytesPerLine) * format.height) {
+		shortFrames.inc();
+		shared->device->queue(index);
+		return false;
+	}
+	uint8_t* data = shared->buffers[index].data;
+
+	if (!shared->zeroCopy) {
+		// Only the luma of the packed pixels, into a new image: the previous one may still be in the pipeline
+		cv::Mat packed(format.height, format.width, CV_8UC2, data, format.bytesPerLine);
+		cv::Mat grey;
+		cv::cvtColor(packed, grey, cv::COLOR_YUV2GRAY_YUYV);
+		shared->device->queue(index);
+		frame = grey;
+		return true;
+	}
+
+	// The luma plane in place, with an allocator that requeues the buffer when the last copy goes
+	cv::Mat view(format.height, format.width, CV_8UC1, data, format.bytesPerLine);
+	cv::UMatData* u = new cv::UMatData(shared.get());
+	u->data = u->origdata = data;
+	u->size = size_t(format.bytesPerLine) * format.height;
+	u->refcount = 1;
+	u->userdata = new Shared::Lease{ shared, index };
+	view.u = u;
+	view.allocator = shared.get();
+	buffersHeld.set(++shared->inUse);
+	frame = view;
+	return true;
+}
+
+void V4l2Capture::close() {
+	if (!shared) return;
+	if (shared->streaming) {
+		shared->streaming = false;
+		shared->device->streamOff();
+	}
+	// Frames still held keep the buffers mapped
+	shared.reset();
+}
+
+V4l2Device::Format V4l2Capture::format() const {
+	return shared ? shared->format : V4l2Device::Format();
+}
+
+bool V4l2Capture::zeroCopy() const {
+	return shared && shared->zeroCopy;
+}
+
+int V4l2Capture::buffersInUse() const {
+	return shared ? shared->inUse.load() : 0;
+}
@@ -0,0 +1,243 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "clock.h"
+
+/// @brief Format code of four characters, as in linux/videodev2.h
+constexpr uint32_t v4l2Fourcc(char a, char b, char c, char d) {
+	return uint32_t(uint8_t(a)) | uint32_t(uint8_t(b)) << 8 | uint32_t(uint8_t(c)) << 16 | uint32_t(uint8_t(d)) << 24;
+}
+
+/**
+ * @brief A V4L2 capture device at the level of its streaming ioctls (format, mmap'd buffers, queue, dequeue),
+ * so @see V4l2Capture runs the same on a camera (@see V4l2KernelDevice) and on a stand-in (@see V4l2FileDevice).
+ *
+ * Buffers are queued back from the thread that releases a frame while the capture thread waits in
+ * @see dequeue(), so implementations must allow both at the same time.
+ */
+class V4l2Device
+{
+public:
+	/// @brief Pixel format of the frames
+	struct Format {
+		uint32_t fourcc = 0;
+		int width = 0;
+		int height = 0;
+		/// Bytes per row of the luma plane
+		int bytesPerLine = 0;
+		/// Bytes of a whole frame, chroma included
+		size_t imageBytes = 0;
+	};
+
+	/// @brief One driver buffer, mapped into our address space
+	struct Buffer {
+		uint8_t* data = nullptr;
+		size_t length = 0;
+	};
+
+	/// 8 bit luma only (monochrome and IR sensors)
+	static constexpr uint32_t GREY = v4l2Fourcc('G', 'R', 'E', 'Y');
+	/// Packed 4:2:2, luma and chroma interleaved
+	static constexpr uint32_t YUYV = v4l2Fourcc('Y', 'U', 'Y', 'V');
+	/// Planar 4:2:0, the luma plane first (what the Pi camera driver delivers natively)
+	static constexpr uint32_t YU12 = v4l2Fourcc('Y', 'U', '1', '2');
+	/// Semi-planar 4:2:0, the luma plane first
+	static constexpr uint32_t NV12 = v4l2Fourcc('N', 'V', '1', '2');
+
+	/// @brief Tightly packed format of that size (bytes per line and image bytes filled in), for stand-ins and tests.
+	static Format makeFormat(uint32_t fourcc, int width, int height);
+
+	/// @brief Four characters of a format code, e.g. "YUYV".
+	static std::string fourccName(uint32_t fourcc);
+
+	virtual ~V4l2Device() = default;
+
+	/// @brief Opens the device. @return False if it isn't there or can't capture.
+	virtual bool open() = 0;
+
+	/**
+	 * @brief Asks for a format and frame rate.
+	 * @param format Requested format, changed to the one the device will deliver (like VIDIOC_S_FMT).
+	 * @return False on error.
+	 */
+	virtual bool setFormat(Format& format, int fps) = 0;
+
+	/// @brief Allocates and maps `count` buffers (the device may give more or fewer), empty on failure.
+	virtual std::vector<Buffer> mapBuffers(int count) = 0;
+
+	/// @brief Hands a buffer to the device to be filled.
+	virtual bool queue(int index) = 0;
+
+	/**
+	 * @brief Waits for a filled buffer.
+	 * @param bytesUsed Receives the bytes of the frame in the buffer.
+	 * @return Index of the buffer, -1 on timeout or error.
+	 */
+	virtual int dequeue(int timeoutMs, size_t& bytesUsed) = 0;
+
+	virtual bool streamOn() = 0;
+
+	/// @brief Stops streaming; buffers stay mapped until the device is destroyed.
+	virtual void streamOff() = 0;
+
+	/// @brief Name in log messages.
+	virtual std::string name() const = 0;
+};
+
+/**
+ * @brief A camera behind a /dev/video node, with mmap'd driver buffers.
+ *
+ * Only available on Linux, on other systems @see open() returns false.
+ */
+class V4l2KernelDevice : public V4l2Device
+{
+public:
+	explicit V4l2KernelDevice(const std::string& path = "/dev/video0") : path(path) {}
+
+	/// @brief Stops streaming, unmaps the buffers and closes the device.
+	~V4l2KernelDevice() override;
+
+	V4l2KernelDevice(const V4l2KernelDevice&) = delete;
+	V4l2KernelDevice& operator=(const V4l2KernelDevice&) = delete;
+
+	bool open() override;
+	bool setFormat(Format& format, int fps) override;
+	std::vector<Buffer> mapBuffers(int count) override;
+	bool queue(int index) override;
+	int dequeue(int timeoutMs, size_t& bytesUsed) override;
+	bool streamOn() override;
+	void streamOff() override;
+	std::string name() const override { return path; }
+
+private:
+	/// Unmaps the buffers and frees them in the driver
+	void unmapBuffers();
+
+	std::string path;
+	int fd = -1;
+	std::vector<Buffer> buffers;
+	bool streaming = false;
+};
+
+/**
+ * @brief Stand-in device that plays raw frames from a file, for tests and benchmarks without a camera.
+ *
+ * The file holds whole frames of one format back to back (e.g. written from @see V4l2Device::makeFormat()
+ * sized buffers); it is played in a loop. Filling a buffer copies the next frame into it, standing in for the
+ * camera's DMA. Frames come at `fps` on the given clock, 0 delivers them as fast as they are asked for.
+ */
+class V4l2FileDevice : public V4l2Device
+{
+public:
+	V4l2FileDevice(const std::string& path, const Format& format, double fps = 30.0, Clock* clock = &Clock::steady());
+
+	bool open() override;
+	/// Only offers the format of the file
+	bool setFormat(Format& format, int fps) override;
+	std::vector<Buffer> mapBuffers(int count) override;
+	bool queue(int index) override;
+	int dequeue(int timeoutMs, size_t& bytesUsed) override;
+	bool streamOn() override;
+	void streamOff() override;
+	std::string name() const override { return path; }
+
+	/// @brief Buffers queued and waiting to be filled.
+	int queuedBuffers() const;
+
+	/// @brief Memory of a buffer, to check that frames point into it.
+	const uint8_t* bufferData(int index) const { return storage[index].data(); }
+
+	/// @brief Frames delivered so far.
+	uint64_t framesDelivered() const { return delivered; }
+
+private:
+	std::string path;
+	Format fileFormat;
+	std::chrono::steady_clock::duration period;
+	Clock* clock;
+
+	std::ifstream file;
+	std::vector<std::vector<uint8_t>> storage;
+	mutable std::mutex mutex;
+	std::condition_variable queuedCv;
+	std::deque<int> queued;
+	std::atomic<bool> streaming{false};
+	std::chrono::steady_clock::time_point nextFrame;
+	std::atomic<uint64_t> delivered{0};
+};
+
+/**
+ * @brief V4L2 capture that hands the pipeline the luma plane of the driver buffer, without a colour conversion or a copy.
+ *
+ * `cv::VideoCapture` dequeues the driver buffer, converts it to BGR and copies it into a new `cv::Mat`, and the
+ * detectors convert it back to grey. Here the capture asks for a format with a luma plane of its own (GREY, YU12
+ * or NV12, in that order) and wraps that plane of the mmap'd buffer in a grey `cv::Mat`. The Mat carries its own
+ * allocator, so the buffer goes back to the driver when the last copy of the Mat (ROIs and the copy waiting in
+ * `frame_queue` included) is released. Devices that only offer YUYV still skip the BGR round trip: the luma is
+ * picked out of the packed buffer into a new Mat and the buffer is requeued at once.
+ *
+ * A frame held by the pipeline holds its buffer, so the device needs more buffers than frames in flight; when
+ * they are all held, @see read() times out instead of overwriting a frame in use. Frames may outlive the capture,
+ * the buffers stay mapped until the last one is released.
+ *
+ * ### USAGE:
+ *      V4l2Capture capture(std::make_unique<V4l2KernelDevice>("/dev/video0"));
+ *      if (capture.open(640, 480, 30)) {
+ *          cv::Mat frame;
+ *          while (capture.read(frame)) {
+ *              ...                                 // CV_8UC1, a view of the driver buffer
+ *          }
+ *      }
+ */
+class V4l2Capture
+{
+public:
+	explicit V4l2Capture(std::unique_ptr<V4l2Device> device);
+
+	/// @brief Stops streaming; frames still held keep their buffers.
+	~V4l2Capture();
+
+	V4l2Capture(const V4l2Capture&) = delete;
+	V4l2Capture& operator=(const V4l2Capture&) = delete;
+
+	/**
+	 * @brief Opens the device, negotiates the format, maps and queues the buffers and starts streaming.
+	 * @param buffers Driver buffers; frames in flight in the pipeline plus two.
+	 * @return True if frames can be read.
+	 */
+	bool open(int width = 640, int height = 480, int fps = 30, int buffers = 4);
+
+	bool isOpened() const;
+
+	/**
+	 * @brief Waits for the next frame.
+	 * @param frame Receives the grey frame (CV_8UC1). With GREY, YU12 and NV12 it is a view of the driver buffer,
+	 * which is requeued when the last copy of the Mat is released.
+	 * @return False on timeout (also when every buffer is held by the pipeline) or error.
+	 */
+	bool read(cv::Mat& frame, int timeoutMs = 1000);
+
+	/// @brief Stops streaming; frames still held keep their buffers until they are released.
+	void close();
+
+	/// @brief Negotiated format.
+	V4l2Device::Format format() const;
+
+	/// @brief True if frames are views of the driver buffers (false for YUYV).
+	bool zeroCopy() const;
+
+	/// @brief Buffers held by frames that haven't been released yet.
+	int buffersInUse() const;
+
+private:
+	struct Shared;
+	std::shared_ptr<Shared> shared;
+};
@@ -0,0 +1,71 @@
+#include "videoReplay.h"
+#include <algorithm>
+#include <opencv2/videoio.hpp>
+
+using namespace std::chrono;
+
+ReplayResult replayVideo(const std::string& path, FrameProcessor& processor,
+	const SequentialSleepDetect::Params& params, bool keepSamples) {
+
+	ReplayResult result;
+	result.path = path;
+
+	cv::VideoCapture video(path);
+	if (!video.isOpened()) {
+		std::cerr << "❌ ERROR: Could not open video " << path << std::endl;
+		return result;
+	}
+	result.opened = true;
+
+	double fps = video.get(cv::CAP_PROP_FPS);
+	if (fps <= 0) fps = 30.0;  // Some containers don't store it, assume the camera rate
+
+	// Simulated time follows the video, so the decisions don't depend on how fast the frames are processed
+	SimulatedClock clock;
+	Clock* previousClock = processor.getClock();
+	processor.setClock(&clock);
+	processor.resetTracking();
+	bool previousDebugDisplay = processor.debugDisplayEnabled();
+	processor.setDebugDisplay(false);
+
+	SequentialSleepDetect detector(params);
+	std::vector<double> frameMs;
+	cv::Mat frame;
+	double lastVideoMs = 0;
+
+	while (video.read(frame)) {
+		// Prefer the container timestamp, fall back to the frame index
+		double videoMs = video.get(cv::CAP_PROP_POS_MSEC);
+		if (videoMs <= 0 && result.frames > 0) {
+			videoMs = result.frames * 1000.0 / fps;
+		}
+		lastVideoMs = videoMs;
+
+		clock.set(steady_clock::time_point(duration_cast<steady_clock::duration>(duration<double, std::milli>(videoMs))));
+
+		auto start = steady_clock::now();
+		processor.processFrame(frame);
+		frameMs.push_back(duration<double, std::milli>(steady_clock::now() - start).count());
+
+		const EyeSample& sample = processor.lastEyeSample();
+		detector.update(sample);
+		if (keepSamples) {
+			result.samples.push_back(sample);
+		}
+		result.frames++;
+	}
+
+	processor.setClock(previousClock);
+	processor.setDebugDisplay(previousDebugDisplay);
+	result.videoSeconds = lastVideoMs / 1000.0;
+	result.events = detector.events();
+
+	if (!frameMs.empty()) {
+		for (double ms : frameMs) result.processingMs += ms;
+		result.meanFrameMs = result.processingMs / frameMs.size();
+		std::sort(frameMs.begin(), frameMs.end());
+		result.p95FrameMs = frameMs[frameMs.size() * 95 / 100];
+		result.maxFrameMs = frameMs.back();
+	}
+	return result;
+}
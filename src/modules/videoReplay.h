@@ -0,0 +1,41 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "frameProcessor.h"
+#include "sequentialSleepDetect.h"
+
+/// @brief Outcome of running the detector over one recorded video
+struct ReplayResult {
+	std::string path;
+	/// False if the video could not be opened
+	bool opened = false;
+	int frames = 0;
+	/// Length of the video, from the frame timestamps
+	double videoSeconds = 0;
+	/// Time spent in processFrame over all frames
+	double processingMs = 0;
+	double meanFrameMs = 0;
+	double p95FrameMs = 0;
+	double maxFrameMs = 0;
+	/// Alarms raised by the decision engine, with timestamps relative to the start of the video
+	std::vector<SequentialSleepDetect::DetectionEvent> events;
+	/// Per-frame eye state samples, only filled if requested
+	std::vector<EyeSample> samples;
+};
+
+/**
+ * @brief Runs a recorded video through the same processFrame / SequentialSleepDetect path as the live pipeline.
+ *
+ * Frames are processed as fast as the CPU allows. The processor runs on a @see SimulatedClock that follows the
+ * video timestamps, so the microsleep gate and the decision engine see the same timing as they would have live
+ * and the decisions don't depend on the speed of the machine. The debug window is off during the replay (it is not
+ * thread-safe and would wait for a key on every frame) and restored afterwards.
+ *
+ * @param path Video file.
+ * @param processor Frame processor to use, owned by the caller so that parallel workers each have their own cascades.
+ * @param params Parameters of the decision engine.
+ * @param keepSamples Also return every per-frame sample.
+ * @return Events and timings of the run.
+ */
+ReplayResult replayVideo(const std::string& path, FrameProcessor& processor,
+	const SequentialSleepDetect::Params& params = SequentialSleepDetect::Params(), bool keepSamples = false);
@@ -0,0 +1,138 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include <omp.h>
+#include "../modules/videoReplay.h"
+#include "../modules/threadPlacement.h"
+
+// Globals the modules expect from the main program, unused in batch mode
+std::queue<TimedFrame> frame_queue;
+std::mutex frame_mutex;
+std::condition_variable frame_cv;
+bool processed = false;
+StatusChannel status_channel;
+
+namespace fs = std::filesystem;
+
+static bool isVideo(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == ".mp4" || ext == ".avi" || ext == ".mkv" || ext == ".mov" || ext == ".h264";
+}
+
+static void writeEvents(const ReplayResult& result, const fs::path& file) {
+    std::ofstream out(file);
+    if (!out) {
+        std::cerr << "❌ ERROR: Could not write " << file.string() << std::endl;
+        return;
+    }
+    out << "onset_ms,decision_ms,latency_ms,frames\n";
+    for (const auto& event : result.events) {
+        out << std::chrono::duration_cast<std::chrono::milliseconds>(event.onset.time_since_epoch()).count() << ','
+            << std::chrono::duration_cast<std::chrono::milliseconds>(event.decision.time_since_epoch()).count() << ','
+            << event.latencyMs << ',' << event.frames << '\n';
+    }
+}
+
+/**
+ * @brief Runs the detector over a directory of recorded drives, one video per worker, and reports the
+ * alarms of every file together with per-file timings and the overall throughput.
+ *
+ * Every worker owns its own FrameProcessor (and so its own cascades); OpenCV is limited to one thread per
+ * worker so the workers don't fight over the cores.
+ *
+ * ### USAGE:
+ *      wake-o-matic-batch recordings/                 # events next to the videos
+ *      wake-o-matic-batch recordings/ results/ -j 4   # events in results/, 4 workers
+ */
+int main(int argc, char** argv) {
+    std::vector<std::string> positional;
+    int workers = omp_get_max_threads();
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            workers = std::max(1, std::atoi(argv[++i]));
+        }
+        else {
+            positional.push_back(arg);
+        }
+    }
+
+    if (positional.empty()) {
+        std::cerr << "Usage: " << argv[0] << " <video directory> [output directory] [-j workers]" << std::endl;
+        return 1;
+    }
+
+    fs::path inputDir = positional[0];
+    fs::path outputDir = positional.size() > 1 ? fs::path(positional[1]) : inputDir;
+    std::error_code error;
+    fs::create_directories(outputDir, error);
+
+    std::vector<fs::path> videos;
+    for (const auto& entry : fs::directory_iterator(inputDir, error)) {
+        if (entry.is_regular_file() && isVideo(entry.path())) {
+            videos.push_back(entry.path());
+        }
+    }
+    if (videos.empty()) {
+        std::cerr << "❌ ERROR: No videos found in " << inputDir.string() << std::endl;
+        return 1;
+    }
+    std::sort(videos.begin(), videos.end());
+
+    ThreadPlacement::limitLibraryThreads(1);
+    workers = std::min<int>(workers, static_cast<int>(videos.size()));
+    std::cout << "✅ Analysing " << videos.size() << " videos with " << workers << " workers" << std::endl;
+
+    std::vector<ReplayResult> results(videos.size());
+    auto wallStart = std::chrono::steady_clock::now();
+
+    #pragma omp parallel num_threads(workers)
+    {
+        // Cascades are loaded once per worker, not once per video
+        std::unique_ptr<FrameProcessor> processor;
+        #pragma omp critical(loadCascades)
+        processor = std::make_unique<FrameProcessor>();
+        processor->setDebugDisplay(false);
+
+        #pragma omp for schedule(dynamic, 1)
+        for (int i = 0; i < static_cast<int>(videos.size()); i++) {
+            results[i] = replayVideo(videos[i].string(), *processor);
+            if (results[i].opened) {
+                writeEvents(results[i], outputDir / (videos[i].stem().string() + ".events.csv"));
+            }
+        }
+    }
+
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    long totalFrames = 0;
+    double totalVideoSeconds = 0;
+    int failed = 0;
+    for (const auto& result : results) {
+        if (!result.opened) {
+            failed++;
+            continue;
+        }
+        totalFrames += result.frames;
+        totalVideoSeconds += result.videoSeconds;
+        std::cout << fs::path(result.path).filename().string() << ": " << result.frames << " frames, "
+            << result.events.size() << " alarms, mean " << result.meanFrameMs << " ms, p95 " << result.p95FrameMs
+            << " ms, max " << result.maxFrameMs << " ms per frame" << std::endl;
+    }
+
+    std::cout << "✅ " << totalFrames << " frames (" << totalVideoSeconds << " s of video) in " << wallSeconds << " s: "
+        << (wallSeconds > 0 ? totalFrames / wallSeconds : 0) << " frames/s, "
+        << (wallSeconds > 0 ? totalVideoSeconds / wallSeconds : 0) << "x real time" << std::endl;
+    if (failed > 0) {
+        std::cerr << "⚠️ WARNING: " << failed << " videos could not be opened" << std::endl;
+    }
+    return failed > 0 ? 2 : 0;
+}
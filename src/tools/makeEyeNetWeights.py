@@ -0,0 +1,306 @@
+#!/usr/bin/env python3
+"""
+Generates src/modules/eyeNetWeights.h, the int8 weights of the eye-state net (see src/modules/eyeNet.h).
+
+No dependencies besides Python 3. The convolution filters are fixed feature detectors (dark pupil, bright
+glare, vertical iris edges, horizontal eyelid edges and lash line, local brightness, and combinations of them
+over the pooled maps). They are quantised to int8 per tensor, the activation scales are calibrated on
+synthetic eye crops, and the classifier head is fitted by logistic regression on the quantised features of
+those crops, simulating the integer arithmetic of the C++ kernel exactly. Weights generated this way are a
+placeholder: they don't carry over to real eyes (test/images/eyeClosed.jpg is classified as open).
+
+To ship weights trained on real crops instead, pass a JSON file with float tensors of the same shapes
+("conv1": 8x3x3, "conv2": 16x8x3x3, optional "conv1_bias"/"conv2_bias", "fc": 2x16 over the mean-pooled
+conv2 activations in float, "fc_bias": 2) and optionally a directory of labelled 24x24 PGM crops
+(open_*.pgm, closed_*.pgm) for calibration:
+
+    python3 src/tools/makeEyeNetWeights.py                        # built-in filters, synthetic calibration
+    python3 src/tools/makeEyeNetWeights.py --weights trained.json --crops crops/
+"""
+import argparse
+import json
+import math
+import os
+import random
+
+SIZE = 24        # input crop
+C1, O1, P1 = 8, 22, 11
+C2, O2 = 16, 9
+K1, K2 = 16, 80  # padded dot-product lengths (9 and 72 used)
+SHIFT = 24       # fixed-point requantisation
+
+
+def conv1_filters():
+    ring = [[1 / 8, 1 / 8, 1 / 8], [1 / 8, -1.0, 1 / 8], [1 / 8, 1 / 8, 1 / 8]]
+    sobel_x = [[-0.25, 0, 0.25], [-0.5, 0, 0.5], [-0.25, 0, 0.25]]
+    sobel_y = [[0.25, 0.5, 0.25], [0, 0, 0], [-0.25, -0.5, -0.25]]
+    line = [[0.5, 0.5, 0.5], [-1, -1, -1], [0.5, 0.5, 0.5]]
+    box = [[1 / 9] * 3 for _ in range(3)]
+    neg = lambda f: [[-v for v in row] for row in f]
+    # 0 dark blob, 1 bright blob, 2 right brighter, 3 left brighter, 4 top brighter, 5 bottom brighter, 6 dark line, 7 brightness
+    return [ring, neg(ring), sobel_x, neg(sobel_x), sobel_y, neg(sobel_y), line, box]
+
+
+def conv2_filters():
+    f = [[[[0.0] * 3 for _ in range(3)] for _ in range(C1)] for _ in range(C2)]
+    for k in range(8):  # local energy of every conv1 feature
+        for y in range(3):
+            for x in range(3):
+                f[k][k][y][x] = 1 / 9
+    f[8][3][1][0] = f[8][0][1][1] = f[8][2][1][2] = 1 / 3      # pupil flanked by iris edges
+    for x in range(3):
+        f[9][6][1][x] = 1 / 3                                   # lash line across the crop
+    for y in range(3):
+        for x in range(3):
+            f[10][4][y][x] = f[10][5][y][x] = 1 / 18            # horizontal edges
+            f[12][0][y][x] = 1 / 9
+            f[12][6][y][x] = -1 / 9                             # blob rather than line
+            f[13][2][y][x] = f[13][3][y][x] = 1 / 18            # vertical edges
+    f[11][1][1][1] = 1.0                                        # glare spot
+    f[14][7][1][1] = 1.0                                        # centre brightness
+    f[15][0][1][1] = 1.0                                        # centre darkness
+    return f
+
+
+# ---------------------------------------------------------------- synthetic crops
+
+def clamp(v, lo=0, hi=255):
+    return max(lo, min(hi, v))
+
+
+def synthetic_eye(rng, is_open):
+    skin = rng.uniform(90, 200)
+    img = [[skin] * SIZE for _ in range(SIZE)]
+    cx, cy = 11.5 + rng.uniform(-2, 2), 11.5 + rng.uniform(-2, 2)
+    if is_open:
+        a = rng.uniform(8, 11)
+        b = rng.uniform(2.5, 6)  # small b: squinting
+        sclera = clamp(skin + rng.uniform(20, 50))
+        iris = rng.uniform(20, 70)
+        r = rng.uniform(3.5, 5.5)
+        ix = cx + rng.uniform(-2, 2)
+        for y in range(SIZE):
+            for x in range(SIZE):
+                e = ((x - cx) / a) ** 2 + ((y - cy) / b) ** 2
+                if e <= 1:
+                    d = math.hypot(x - ix, y - cy)
+                    img[y][x] = iris - 15 if d < 0.45 * r else iris if d < r else sclera
+                elif e <= 1.35 and y < cy:
+                    img[y][x] = clamp(skin - 60)  # upper lid and lashes
+        if rng.random() < 0.5:
+            gx, gy = int(ix) - 1, int(cy) - 1
+            for y in range(gy, gy + 2):
+                for x in range(gx, gx + 2):
+                    img[y][x] = 250  # IR reflection on the cornea
+    else:
+        k = rng.uniform(0.5, 1.5)
+        lid = rng.uniform(20, 70)
+        thick = rng.choice([1, 2])
+        for x in range(SIZE):
+            yl = cy + k * (x - cx) ** 2 / 40
+            for y in range(SIZE):
+                if 0 <= y - yl < thick:
+                    img[y][x] = lid
+                elif y - yl >= thick:
+                    img[y][x] = clamp(skin - 10)
+            if rng.random() < 0.3 and 0 <= int(yl) + thick + 1 < SIZE:
+                img[int(yl) + thick][x] = lid  # lashes
+    if rng.random() < 0.3:  # glasses frame
+        if rng.random() < 0.5:
+            row = rng.randint(1, 3)
+            for x in range(SIZE):
+                img[row][x] = 40
+        else:
+            col = rng.randint(1, 2)
+            for y in range(SIZE):
+                img[y][col] = 40
+    if rng.random() < 0.3:  # glare on the glasses
+        gx, gy = rng.randint(0, SIZE - 3), rng.randint(0, SIZE - 3)
+        for y in range(gy, gy + 3):
+            for x in range(gx, gx + 3):
+                img[y][x] = 255
+    noise = rng.uniform(0, 8)
+    return [[int(clamp(round(v + rng.uniform(-noise, noise)))) for v in row] for row in img]
+
+
+def read_pgm(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    parts = data.split(maxsplit=4)
+    w, h = int(parts[1]), int(parts[2])
+    pixels = parts[4][:w * h] if parts[0] == b'P5' else [int(v) for v in parts[4].split()]
+    return [[pixels[y * w + x] for x in range(w)] for y in range(h)]
+
+
+# ---------------------------------------------------------------- integer forward pass (same as the C++ kernel)
+
+def preprocess(img):
+    total = sum(sum(row) for row in img)
+    mean = (total + SIZE * SIZE // 2) // (SIZE * SIZE)
+    return [[max(-127, min(127, (p - mean) >> 1)) for p in row] for row in img]
+
+
+def requant(acc, mult):
+    return (acc * mult + (1 << (SHIFT - 1))) >> SHIFT
+
+
+def conv1_acc(x, w, b):
+    out = []
+    for c in range(C1):
+        plane = []
+        for y in range(O1):
+            row = []
+            for xx in range(O1):
+                acc = b[c]
+                for ky in range(3):
+                    for kx in range(3):
+                        acc += w[c][ky * 3 + kx] * x[y + ky][xx + kx]
+                row.append(acc)
+            plane.append(row)
+        out.append(plane)
+    return out
+
+
+def pool(planes):
+    return [[[max(p[2 * y][2 * x], p[2 * y][2 * x + 1], p[2 * y + 1][2 * x], p[2 * y + 1][2 * x + 1])
+              for x in range(P1)] for y in range(P1)] for p in planes]
+
+
+def conv2_acc(x, w, b):
+    out = []
+    for c in range(C2):
+        plane = []
+        for y in range(O2):
+            for xx in range(O2):
+                acc = b[c]
+                for ci in range(C1):
+                    for ky in range(3):
+                        for kx in range(3):
+                            acc += w[c][ci * 9 + ky * 3 + kx] * x[ci][y + ky][xx + kx]
+                plane.append(acc)
+        out.append(plane)
+    return out
+
+
+def relu8(v):
+    return max(0, min(127, v))
+
+
+# ---------------------------------------------------------------- quantisation
+
+def quantise(values):
+    scale = max(abs(v) for v in values) / 127 or 1.0
+    return [int(round(v / scale)) for v in values], scale
+
+
+def percentile_abs(values, q=0.999):
+    s = sorted(abs(v) for v in values)
+    return s[min(len(s) - 1, int(q * len(s)))] or 1.0
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--weights', help='JSON with float tensors (default: built-in filters)')
+    parser.add_argument('--crops', help='directory of open_*.pgm / closed_*.pgm crops (default: synthetic)')
+    parser.add_argument('--samples', type=int, default=400, help='synthetic crops for calibration and the head')
+    parser.add_argument('--output', default=os.path.join(here, '..', 'modules', 'eyeNetWeights.h'))
+    args = parser.parse_args()
+
+    trained = json.load(open(args.weights)) if args.weights else {}
+    f1 = trained.get('conv1', conv1_filters())
+    f2 = trained.get('conv2', conv2_filters())
+    b1f = trained.get('conv1_bias', [0.0] * C1)
+    b2f = trained.get('conv2_bias', [0.0] * C2)
+
+    if args.crops:
+        crops = []
+        for name in sorted(os.listdir(args.crops)):
+            if name.endswith('.pgm') and name.split('_')[0] in ('open', 'closed'):
+                crops.append((read_pgm(os.path.join(args.crops, name)), name.startswith('open')))
+    else:
+        rng = random.Random(24)
+        crops = [(synthetic_eye(rng, i % 2 == 0), i % 2 == 0) for i in range(args.samples)]
+    inputs = [(preprocess(img), label) for img, label in crops]
+
+    s_in = 2.0  # preprocess halves the pixel difference to the mean
+    w1, s_w1 = quantise([v for f in f1 for row in f for v in row])
+    w1 = [w1[c * 9:(c + 1) * 9] for c in range(C1)]
+    b1 = [int(round(b / (s_in * s_w1))) for b in b1f]
+
+    acc1 = [conv1_acc(x, w1, b1) for x, _ in inputs]
+    s_a1 = percentile_abs([v * s_in * s_w1 for a in acc1 for p in a for r in p for v in r]) / 127
+    m1 = int(round(s_in * s_w1 / s_a1 * (1 << SHIFT)))
+    act1 = [pool([[[relu8(requant(v, m1)) for v in r] for r in p] for p in a]) for a in acc1]
+
+    w2, s_w2 = quantise([v for f in f2 for ci in f for row in ci for v in row])
+    w2 = [w2[c * 72:(c + 1) * 72] for c in range(C2)]
+    b2 = [int(round(b / (s_a1 * s_w2))) for b in b2f]
+
+    acc2 = [conv2_acc(a, w2, b2) for a in act1]
+    s_a2 = percentile_abs([v * s_a1 * s_w2 for a in acc2 for p in a for v in p]) / 127
+    m2 = int(round(s_a1 * s_w2 / s_a2 * (1 << SHIFT)))
+    features = [[sum(relu8(requant(v, m2)) for v in p) for p in a] for a in acc2]  # sum pooling, as the kernel
+    labels = [1.0 if label else 0.0 for _, label in inputs]
+
+    if 'fc' in trained:
+        # Trained head works on mean-pooled float activations, fold the pooling and the scale in
+        fc = [[w * s_a2 / (O2 * O2) for w in row] for row in trained['fc']]
+        fcb = trained.get('fc_bias', [0.0, 0.0])
+    else:
+        # Logistic regression on standardised features, then folded back onto the raw sums
+        n = len(features[0])
+        mu = [sum(f[i] for f in features) / len(features) for i in range(n)]
+        sd = [math.sqrt(sum((f[i] - mu[i]) ** 2 for f in features) / len(features)) or 1.0 for i in range(n)]
+        z = [[(f[i] - mu[i]) / sd[i] for i in range(n)] for f in features]
+        w, b = [0.0] * n, 0.0
+        for _ in range(2000):
+            gw, gb = [0.0] * n, 0.0
+            for zi, yi in zip(z, labels):
+                p = 1 / (1 + math.exp(-max(-30, min(30, b + sum(wj * zj for wj, zj in zip(w, zi))))))
+                for j in range(n):
+                    gw[j] += (p - yi) * zi[j]
+                gb += p - yi
+            w = [wj - 0.5 * (g / len(z) + 1e-3 * wj) for wj, g in zip(w, gw)]
+            b -= 0.5 * gb / len(z)
+        fc = [[w[i] / sd[i] for i in range(n)], [0.0] * n]
+        fcb = [b - sum(w[i] * mu[i] / sd[i] for i in range(n)), 0.0]
+
+    correct = 0
+    for f, y in zip(features, labels):
+        logit = sum(a * v for a, v in zip(fc[0], f)) + fcb[0] - sum(a * v for a, v in zip(fc[1], f)) - fcb[1]
+        correct += (logit > 0) == (y > 0.5)
+    accuracy = correct / len(features)
+
+    def ints(values):
+        return ', '.join(str(v) for v in values)
+
+    def floats(values):
+        text = ['%.9g' % v for v in values]
+        return ', '.join(t + ('f' if '.' in t or 'e' in t else '.0f') for t in text)
+
+    with open(args.output, 'w') as out:
+        out.write('#pragma once\n#include <cstdint>\n\n')
+        out.write('// Generated by src/tools/makeEyeNetWeights.py, do not edit.\n')
+        out.write('// %s, calibrated on %d %s crops, accuracy %.3f on them.\n\n' % (
+            'trained weights' if args.weights else 'built-in filters',
+            len(crops), 'labelled' if args.crops else 'synthetic', accuracy))
+        out.write('namespace EyeNetWeights {\n\n')
+        out.write('/// Fixed-point shift of the requantisation multipliers\nconstexpr int SHIFT = %d;\n\n' % SHIFT)
+        out.write('/// Conv 3x3, 1 -> %d channels, taps padded to %d\nalignas(16) constexpr int8_t conv1[%d][%d] = {\n' % (C1, K1, C1, K1))
+        for c in range(C1):
+            out.write('\t{ %s },\n' % ints(w1[c] + [0] * (K1 - 9)))
+        out.write('};\nconstexpr int32_t conv1Bias[%d] = { %s };\nconstexpr int64_t conv1Mult = %d;\n\n' % (C1, ints(b1), m1))
+        out.write('/// Conv 3x3, %d -> %d channels, taps (channel, row, column) padded to %d\nalignas(16) constexpr int8_t conv2[%d][%d] = {\n' % (C1, C2, K2, C2, K2))
+        for c in range(C2):
+            out.write('\t{ %s },\n' % ints(w2[c] + [0] * (K2 - 72)))
+        out.write('};\nconstexpr int32_t conv2Bias[%d] = { %s };\nconstexpr int64_t conv2Mult = %d;\n\n' % (C2, ints(b2), m2))
+        out.write('/// Open and closed logits from the summed conv2 activations\nconstexpr float fc[2][%d] = {\n' % C2)
+        for row in fc:
+            out.write('\t{ %s },\n' % floats(row))
+        out.write('};\nconstexpr float fcBias[2] = { %s };\n\n}\n' % floats(fcb))
+    print('wrote %s, accuracy %.3f on %d crops' % (args.output, accuracy, len(crops)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,232 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <omp.h>
+#include "../modules/videoReplay.h"
+#include "../modules/parameterSweep.h"
+#include "../modules/threadPlacement.h"
+
+// Globals the modules expect from the main program, unused in sweep mode
+std::queue<TimedFrame> frame_queue;
+std::mutex frame_mutex;
+std::condition_variable frame_cv;
+bool processed = false;
+StatusChannel status_channel;
+
+namespace fs = std::filesystem;
+
+/// One swept parameter and the values it takes
+struct Axis {
+    std::string key;
+    std::vector<double> values;
+};
+
+// Default grid around the values the detector shipped with; the cascade parameters decide the speed,
+// the blob parameters the accuracy
+static std::vector<Axis> defaultGrid() {
+    return {
+        { "face.scaleFactor", { 1.1, 1.2, 1.3 } },
+        { "face.minNeighbors", { 2, 3 } },
+        { "face.minSize", { 100, 140 } },
+        { "eyes.scaleFactor", { 1.1, 1.2 } },
+        { "eyes.minNeighbors", { 3, 4 } },
+        { "eyes.minSize", { 20, 30 } },
+        { "blob.minArea", { 100, 150 } },
+        { "blob.minCircularity", { 0.1, 0.3 } },
+        { "blob.minConvexity", { 0.8, 0.87 } },
+    };
+}
+
+static bool isVideo(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == ".mp4" || ext == ".avi" || ext == ".mkv" || ext == ".mov" || ext == ".h264";
+}
+
+// "key=v1,v2,v3" replaces the values of that axis (or adds it)
+static bool parseAxis(const std::string& text, std::vector<Axis>& grid) {
+    size_t equals = text.find('=');
+    if (std::string::npos == equals) return false;
+    Axis axis{ text.substr(0, equals), {} };
+    DetectionParams probe;
+    if (!probe.set(axis.key, 0)) return false;
+    std::stringstream values(text.substr(equals + 1));
+    std::string value;
+    while (std::getline(values, value, ',')) {
+        axis.values.push_back(std::atof(value.c_str()));
+    }
+    if (axis.values.empty()) return false;
+    auto existing = std::find_if(grid.begin(), grid.end(), [&](const Axis& a) { return a.key == axis.key; });
+    if (existing != grid.end()) *existing = axis;
+    else grid.push_back(axis);
+    return true;
+}
+
+// Configuration number `index` of the grid, the first axis changing fastest
+static DetectionParams gridPoint(const std::vector<Axis>& grid, size_t index) {
+    DetectionParams params;
+    for (const Axis& axis : grid) {
+        params.set(axis.key, axis.values[index % axis.values.size()]);
+        index /= axis.values.size();
+    }
+    return params;
+}
+
+static void writeSweep(const std::vector<SweepPoint>& points, const std::vector<size_t>& front, const fs::path& file) {
+    std::ofstream out(file);
+    if (!out) {
+        std::cerr << "❌ ERROR: Could not write " << file.string() << std::endl;
+        return;
+    }
+    for (const std::string& key : DetectionParams::keys()) out << key << ',';
+    out << "fps,accuracy,missed_alarms,false_alarms,mean_latency_ms,pareto\n";
+    for (size_t i = 0; i < points.size(); i++) {
+        const SweepPoint& p = points[i];
+        for (const std::string& key : DetectionParams::keys()) out << p.params.get(key) << ',';
+        out << p.fps << ',' << p.score.accuracy() << ',' << (p.score.microsleeps - p.score.detected) << ','
+            << p.score.falseAlarms << ',' << p.score.meanLatencyMs() << ','
+            << (std::find(front.begin(), front.end(), i) != front.end() ? 1 : 0) << '\n';
+    }
+}
+
+/**
+ * @brief Sweeps the cascade and blob parameters over a labelled corpus of recorded drives and exports the
+ * chosen configuration for the runtime.
+ *
+ * Every video needs a `<video>.labels.csv` next to it (@see loadLabels). Each configuration of the grid is
+ * replayed over the whole corpus; workers run configurations in parallel, each with its own FrameProcessor.
+ * The Pareto front of fps (per core) against frame accuracy, alarm errors and alarm latency is printed, all
+ * points are written to `sweep.csv`, and the configuration picked from the front (@see chooseConfiguration)
+ * is saved where `wake-o-matic-main` loads it at startup.
+ *
+ * ### USAGE:
+ *      wake-o-matic-sweep corpus/                                # grid of defaultGrid(), writes wake-o-matic.conf
+ *      wake-o-matic-sweep corpus/ -j 4 -o tuned.conf
+ *      wake-o-matic-sweep corpus/ --axis face.scaleFactor=1.05,1.1,1.2,1.4 --tolerance 0.01
+ */
+int main(int argc, char** argv) {
+    std::vector<std::string> positional;
+    std::vector<Axis> grid = defaultGrid();
+    std::string output = "wake-o-matic.conf";
+    double tolerance = 0.02;
+    int workers = omp_get_max_threads();
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            workers = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "-o" && i + 1 < argc) {
+            output = argv[++i];
+        }
+        else if (arg == "--tolerance" && i + 1 < argc) {
+            tolerance = std::atof(argv[++i]);
+        }
+        else if (arg == "--axis" && i + 1 < argc) {
+            if (!parseAxis(argv[++i], grid)) {
+                std::cerr << "❌ ERROR: Bad axis " << argv[i] << ", expected key=v1,v2,..." << std::endl;
+                return 1;
+            }
+        }
+        else {
+            positional.push_back(arg);
+        }
+    }
+
+    if (positional.empty()) {
+        std::cerr << "Usage: " << argv[0] << " <corpus directory> [-j workers] [-o config] [--tolerance accuracy] [--axis key=v1,v2,...]" << std::endl;
+        return 1;
+    }
+
+    fs::path corpusDir = positional[0];
+    std::error_code error;
+    std::vector<fs::path> videos;
+    std::vector<std::vector<LabelledInterval>> labels;
+    for (const auto& entry : fs::directory_iterator(corpusDir, error)) {
+        if (!entry.is_regular_file() || !isVideo(entry.path())) continue;
+        fs::path labelFile = entry.path().parent_path() / (entry.path().stem().string() + ".labels.csv");
+        if (!fs::exists(labelFile)) {
+            std::cerr << "⚠️ WARNING: " << entry.path().filename().string() << " has no labels, skipped" << std::endl;
+            continue;
+        }
+        videos.push_back(entry.path());
+    }
+    if (videos.empty()) {
+        std::cerr << "❌ ERROR: No labelled videos found in " << corpusDir.string() << std::endl;
+        return 1;
+    }
+    std::sort(videos.begin(), videos.end());
+    for (const auto& video : videos) {
+        labels.push_back(loadLabels((video.parent_path() / (video.stem().string() + ".labels.csv")).string()));
+    }
+
+    size_t configurations = 1;
+    for (const Axis& axis : grid) configurations *= axis.values.size();
+
+    ThreadPlacement::limitLibraryThreads(1);
+    workers = std::min<int>(workers, static_cast<int>(configurations));
+    std::cout << "✅ Sweeping " << configurations << " configurations over " << videos.size() << " videos with "
+        << workers << " workers" << std::endl;
+
+    std::vector<SweepPoint> points(configurations);
+    auto wallStart = std::chrono::steady_clock::now();
+
+    #pragma omp parallel num_threads(workers)
+    {
+        // Cascades are loaded once per worker, the parameters only change how they are applied
+        std::unique_ptr<FrameProcessor> processor;
+        #pragma omp critical(loadCascades)
+        processor = std::make_unique<FrameProcessor>();
+        processor->setDebugDisplay(false);
+
+        #pragma omp for schedule(dynamic, 1)
+        for (int c = 0; c < static_cast<int>(configurations); c++) {
+            SweepPoint& point = points[c];
+            point.params = gridPoint(grid, c);
+            processor->setDetectionParams(point.params);
+
+            long frames = 0;
+            double processingMs = 0;
+            for (size_t v = 0; v < videos.size(); v++) {
+                ReplayResult result = replayVideo(videos[v].string(), *processor, SequentialSleepDetect::Params(), true);
+                frames += result.frames;
+                processingMs += result.processingMs;
+                point.score.add(scoreReplay(result.samples, result.events, labels[v]));
+            }
+            point.fps = processingMs > 0 ? frames * 1000.0 / processingMs : 0;
+        }
+    }
+
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    std::vector<size_t> front = paretoFront(points);
+    std::sort(front.begin(), front.end(), [&](size_t a, size_t b) { return points[a].fps > points[b].fps; });
+
+    std::cout << "✅ Swept in " << wallSeconds << " s, Pareto front (" << front.size() << " of " << configurations << "):" << std::endl;
+    for (size_t i : front) {
+        const SweepPoint& p = points[i];
+        std::cout << "  " << p.fps << " fps, accuracy " << p.score.accuracy() << ", "
+            << (p.score.microsleeps - p.score.detected) << " missed / " << p.score.falseAlarms << " false alarms, latency "
+            << p.score.meanLatencyMs() << " ms  [face " << p.params.face.scaleFactor << '/' << p.params.face.minNeighbors << '/'
+            << p.params.face.minSize << ", eyes " << p.params.eyes.scaleFactor << '/' << p.params.eyes.minNeighbors << '/'
+            << p.params.eyes.minSize << ", blob area " << p.params.blob.minArea << " circ " << p.params.blob.minCircularity
+            << " conv " << p.params.blob.minConvexity << "]" << std::endl;
+    }
+    writeSweep(points, front, fs::path(output).parent_path() / "sweep.csv");
+
+    const SweepPoint& chosen = points[chooseConfiguration(points, front, tolerance)];
+    std::ostringstream comment;
+    comment << "wake-o-matic-sweep over " << videos.size() << " videos: " << chosen.fps << " fps, accuracy "
+        << chosen.score.accuracy() << ", mean alarm latency " << chosen.score.meanLatencyMs() << " ms";
+    if (!chosen.params.save(output, comment.str())) {
+        return 1;
+    }
+    std::cout << "✅ Chose " << chosen.fps << " fps at accuracy " << chosen.score.accuracy() << ", saved to " << output << std::endl;
+    return 0;
+}
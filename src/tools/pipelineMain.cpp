@@ -0,0 +1,88 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "../modules/pipelinePolicies.h"
+
+// Globals the action state machine expects from the main program
+std::mutex action_mutex;
+std::condition_variable action_cv;
+
+// The variant is fixed when building (cmake -DPIPELINE_MAJORITY_DECISION=ON), not chosen at runtime
+#ifdef PIPELINE_MAJORITY_DECISION
+using Decision = MajorityDecision<30>;
+#else
+using Decision = SequentialDecision;
+#endif
+
+using LivePipeline = Pipeline<CameraSource, GreyPreprocess, CascadeDetector, BlobEyeClassifier, Decision, ActionMachineSink>;
+using ReplayPipeline = Pipeline<VideoFileSource, GreyPreprocess, CascadeDetector, BlobEyeClassifier, Decision, NullSink>;
+
+// Same tuned parameters as wake-o-matic-main, the built-in defaults if there is no file
+template <class P>
+static void configure(P& pipeline) {
+    DetectionParams params;
+    if (params.load("wake-o-matic.conf")) {
+        std::cout << "✅ Detection parameters loaded from wake-o-matic.conf" << std::endl;
+    }
+    pipeline.detector.configure(params);
+    pipeline.classifier.configure(params);
+}
+
+static const char* name(DriverState state) {
+    switch (state) {
+    case DriverState::Asleep: return "asleep";
+    case DriverState::Awake: return "awake";
+    case DriverState::NoFace: return "no face";
+    }
+    return "?";
+}
+
+/**
+ * @brief Detector built from compile-time policies (@see Pipeline), single threaded and without a display.
+ *
+ * ⚠️ Not a replacement for wake-o-matic-main in a vehicle: it shares the detection parameters (wake-o-matic.conf)
+ * but has no low-light stage, no eye result cache, no per-frame deadlines and no stall watchdog, so a camera or
+ * detector that hangs leaves the driver without an alarm and without a warning. Use it for replays and for
+ * comparing decision rules.
+ *
+ * ### USAGE:
+ *      wake-o-matic-pipeline                # live camera, alarms through the speaker
+ *      wake-o-matic-pipeline drive.mp4      # replay, prints the driver state changes
+ */
+int main(int argc, char** argv) {
+    try {
+        if (argc > 1) {
+            ReplayPipeline pipeline;
+            configure(pipeline);
+            if (!pipeline.source.open(argv[1])) {
+                std::cerr << "❌ ERROR: Could not open " << argv[1] << std::endl;
+                return 1;
+            }
+            DriverState previous = DriverState::Awake;
+            while (pipeline.step()) {
+                if (pipeline.state() != previous) {
+                    previous = pipeline.state();
+                    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(pipeline.observation().captured.time_since_epoch()).count();
+                    std::cout << ms << " ms: " << name(previous) << std::endl;
+                }
+            }
+            std::cout << "✅ Replay finished after " << pipeline.source.frames << " frames" << std::endl;
+            return 0;
+        }
+
+        LivePipeline pipeline;
+        configure(pipeline);
+        if (!pipeline.source.open()) {
+            std::cerr << "❌ ERROR: Unable to open camera" << std::endl;
+            return 1;
+        }
+        std::cout << "✅ Camera started" << std::endl;
+        while (pipeline.step()) {}
+        std::cerr << "❌ ERROR: Camera stopped delivering frames" << std::endl;
+        return 1;
+    }
+    catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
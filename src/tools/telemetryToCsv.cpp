@@ -0,0 +1,35 @@
+#include <iostream>
+#include <fstream>
+#include "../modules/telemetry.h"
+
+/**
+ * @brief Converts a binary telemetry log written by wake-o-matic-main to CSV.
+ *
+ * ### USAGE:
+ *      wake-o-matic-telemetry-csv telemetry.womt > telemetry.csv
+ *      wake-o-matic-telemetry-csv telemetry.womt telemetry.csv
+ */
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <telemetry.womt> [output.csv]" << std::endl;
+        return 1;
+    }
+
+    std::vector<TelemetryRecord> records;
+    bool complete = TelemetryReader::readAll(argv[1], records);
+
+    if (argc > 2) {
+        std::ofstream out(argv[2]);
+        if (!out) {
+            std::cerr << "❌ ERROR: Could not write " << argv[2] << std::endl;
+            return 1;
+        }
+        TelemetryReader::writeCsv(records, out);
+    }
+    else {
+        TelemetryReader::writeCsv(records, std::cout);
+    }
+
+    std::cerr << records.size() << " records converted" << std::endl;
+    return complete ? 0 : 2;
+}
@@ -0,0 +1,606 @@
+#include "bench.h"
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <cstdio>
+#include "../../src/modules/frameProcessor.h"
+#include "../../src/modules/blackBoxRecorder.h"
+#include "../../src/modules/pipeline.h"
+#include "../../src/modules/eyeNet.h"
+#include "../../src/modules/eyeCache.h"
+#include "../../src/modules/lowLight.h"
+#include "../../src/modules/fatigueAnalytics.h"
+#include "../../src/modules/v4l2Capture.h"
+#include "../../src/modules/statusChannel.h"
+#include "../../src/modules/sequentialSleepDetect.h"
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if __has_include(<opencv2/core/utils/allocator_stats.hpp>)
+    #include <opencv2/core/utils/allocator_stats.hpp>
+    #define HAVE_CV_ALLOCATOR_STATS
+#endif
+
+// Every operator new in the bench executable is counted (std containers); OpenCV images use their own allocator
+static std::atomic<uint64_t> heapAllocations{0};
+
+void* operator new(std::size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+AllocationCount countAllocations() {
+    AllocationCount count;
+    count.heap = heapAllocations.load();
+    #ifdef HAVE_CV_ALLOCATOR_STATS
+    count.opencv = static_cast<uint64_t>(cv::getAllocatorStatistics().getNumberOfAllocations());
+    #endif
+    return count;
+}
+
+BenchResult timeIt(const std::string& name, int iterations, const std::function<void()>& fn) {
+    for (int i = 0; i < std::min(iterations, 10); i++) {
+        fn();  // warm-up
+    }
+
+    std::vector<double> samples(iterations);
+    for (int i = 0; i < iterations; i++) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        samples[i] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    BenchResult result;
+    result.name = name;
+    result.iterations = iterations;
+    for (double s : samples) result.meanUs += s / iterations;
+    std::sort(samples.begin(), samples.end());
+    result.p50Us = samples[iterations / 2];
+    result.p99Us = samples[std::min(iterations - 1, iterations * 99 / 100)];
+    return result;
+}
+
+void printResult(const BenchResult& r) {
+    std::printf("%-40s %8d iters  mean %10.1f us  p50 %10.1f us  p99 %10.1f us\n",
+        r.name.c_str(), r.iterations, r.meanUs, r.p50Us, r.p99Us);
+}
+
+cv::Mat loadBenchImage(const std::string& name) {
+    cv::Mat image = cv::imread(std::string(TEST_IMAGES_DIR) + name);
+    if (image.empty()) {
+        std::cerr << "ERROR: Unable to load " << name << ". Check TEST_IMAGES_DIR!" << std::endl;
+        std::exit(1);
+    }
+    return image;
+}
+
+void benchProcessFrame() {
+    FrameProcessor processor;
+    processor.setDebugDisplay(false);
+    cv::Mat face = loadBenchImage("face_openeyes.jpg");
+    cv::resize(face, face, cv::Size(640, 480));
+    printResult(timeIt("FrameProcessor::processFrame 640x480", 50, [&] {
+        cv::Mat frame = face.clone();
+        processor.processFrame(frame);
+    }));
+}
+
+void benchBlackBoxRecorder() {
+    BlackBoxRecorder::Config config;
+    config.path = "bench_blackbox.ring";
+    config.seconds = 10;
+
+    BlackBoxRecorder recorder;
+    if (!recorder.open(config)) {
+        std::cerr << "Skipping black-box recorder benchmark." << std::endl;
+        return;
+    }
+
+    cv::Mat face = loadBenchImage("face_openeyes.jpg");
+    cv::resize(face, face, cv::Size(640, 480));
+    auto now = std::chrono::steady_clock::now();
+    printResult(timeIt("BlackBoxRecorder::record 640x480->320x240", 2000, [&] {
+        recorder.record(face, now);
+    }));
+
+    config.width = 640;
+    config.height = 480;
+    recorder.open(config);
+    printResult(timeIt("BlackBoxRecorder::record 640x480 full", 2000, [&] {
+        recorder.record(face, now);
+    }));
+
+    recorder.close();
+    std::remove(config.path.c_str());
+}
+
+void benchFrameAllocations() {
+    FrameProcessor processor;
+    processor.setDebugDisplay(false);
+    cv::Mat face = loadBenchImage("face_openeyes.jpg");
+    cv::resize(face, face, cv::Size(640, 480));
+
+    // First frame: scratch vectors and the frame arena are still empty
+    cv::Mat frame = face.clone();
+    AllocationCount before = countAllocations();
+    processor.processFrame(frame);
+    AllocationCount first = countAllocations();
+
+    for (int i = 0; i < 20; i++) {
+        face.copyTo(frame);
+        processor.processFrame(frame);
+    }
+
+    // Steady state: regions come from the arena, the vectors keep their capacity
+    const int frames = 100;
+    AllocationCount start = countAllocations();
+    for (int i = 0; i < frames; i++) {
+        face.copyTo(frame);
+        processor.processFrame(frame);
+    }
+    AllocationCount end = countAllocations();
+
+    const FrameArena& arena = processor.frameArena();
+    std::printf("%-40s first frame %6llu heap / %6llu OpenCV allocs, steady state %8.1f heap / %8.1f OpenCV allocs per frame\n",
+        "FrameProcessor::processFrame allocations",
+        static_cast<unsigned long long>(first.heap - before.heap), static_cast<unsigned long long>(first.opencv - before.opencv),
+        static_cast<double>(end.heap - start.heap) / frames, static_cast<double>(end.opencv - start.opencv) / frames);
+    std::printf("%-40s capacity %zu bytes, high water %zu bytes, %llu grows\n", "FrameArena",
+        arena.capacity(), arena.highWater(), static_cast<unsigned long long>(arena.overflows()));
+    #ifndef HAVE_CV_ALLOCATOR_STATS
+    std::printf("(OpenCV allocation statistics are not available in this OpenCV build)\n");
+    #endif
+}
+
+// 🚀 Trivial stages, so that the cost of calling them dominates: one face, one eye, open when the pixel is bright
+namespace dispatch {
+
+struct Source {
+    cv::Mat image = cv::Mat(4, 4, CV_8UC1, cv::Scalar(200));
+    std::chrono::steady_clock::time_point time;
+    bool next(cv::Mat& frame, std::chrono::steady_clock::time_point& captured) { frame = image; captured = time; return true; }
+};
+struct Preprocess {
+    const cv::Mat& apply(const cv::Mat& frame) { return frame; }
+};
+struct Detector {
+    std::vector<cv::Rect> faceRects{ cv::Rect(0, 0, 4, 4) };
+    std::vector<cv::Rect> eyeRects{ cv::Rect(1, 1, 2, 2) };
+    const std::vector<cv::Rect>& faces(const cv::Mat&) { return faceRects; }
+    const std::vector<cv::Rect>& eyes(const cv::Mat&) { return eyeRects; }
+};
+struct Classifier {
+    EyeState classify(const cv::Mat& eye) { return eye.at<uchar>(0, 0) > 100 ? EyeState::Open : EyeState::Closed; }
+};
+struct Decision {
+    int closedFrames = 0;
+    DriverState update(const EyeObservation& o) {
+        closedFrames = EyeState::Closed == o.state ? closedFrames + 1 : 0;
+        return closedFrames > 45 ? DriverState::Asleep : DriverState::Awake;
+    }
+};
+struct Sink {
+    int alarms = 0;
+    void act(DriverState state) { alarms += DriverState::Asleep == state; }
+};
+
+// The same stages behind interfaces, chosen at runtime, as with Camera::SceneCallback and int status codes
+struct IPreprocess { virtual ~IPreprocess() = default; virtual const cv::Mat& apply(const cv::Mat& frame) = 0; };
+struct IDetector { virtual ~IDetector() = default; virtual const std::vector<cv::Rect>& faces(const cv::Mat&) = 0; virtual const std::vector<cv::Rect>& eyes(const cv::Mat&) = 0; };
+struct IClassifier { virtual ~IClassifier() = default; virtual int classify(const cv::Mat& eye) = 0; };
+struct IDecision { virtual ~IDecision() = default; virtual int update(int status, float confidence) = 0; };
+struct ISink { virtual ~ISink() = default; virtual void act(int status) = 0; };
+
+struct VPreprocess : IPreprocess { Preprocess p; const cv::Mat& apply(const cv::Mat& f) override { return p.apply(f); } };
+struct VDetector : IDetector { Detector d; const std::vector<cv::Rect>& faces(const cv::Mat& m) override { return d.faces(m); } const std::vector<cv::Rect>& eyes(const cv::Mat& m) override { return d.eyes(m); } };
+struct VClassifier : IClassifier { int classify(const cv::Mat& eye) override { return eye.at<uchar>(0, 0) > 100 ? AWAKE : SLEEPING; } };
+struct VDecision : IDecision {
+    int closedFrames = 0;
+    int update(int status, float) override { closedFrames = SLEEPING == status ? closedFrames + 1 : 0; return closedFrames > 45 ? SLEEPING : AWAKE; }
+};
+struct VSink : ISink { int alarms = 0; void act(int status) override { alarms += SLEEPING == status; } };
+
+struct VirtualPipeline {
+    IPreprocess* preprocess;
+    IDetector* detector;
+    IClassifier* classifier;
+    IDecision* decision;
+    ISink* sink;
+
+    int process(const cv::Mat& input) {
+        const cv::Mat& image = preprocess->apply(input);
+        int status = NOFACE;
+        float confidence = 0.0f;
+        const std::vector<cv::Rect>& faces = detector->faces(image);
+        if (!faces.empty()) {
+            int eyesFound = 0;
+            int eyesOpen = 0;
+            for (const cv::Rect& face : faces) {
+                cv::Mat faceImage = image(face);
+                for (const cv::Rect& eye : detector->eyes(faceImage)) {
+                    eyesFound++;
+                    if (AWAKE == classifier->classify(faceImage(eye))) eyesOpen++;
+                }
+            }
+            status = eyesOpen > 0 ? AWAKE : SLEEPING;
+            confidence = eyesFound > 0 ? static_cast<float>(eyesOpen) / eyesFound : 0.0f;
+        }
+        int state = decision->update(status, confidence);
+        sink->act(state);
+        return state;
+    }
+};
+
+}
+
+void benchPipelineDispatch() {
+    const int frames = 1000000;
+
+    Pipeline<dispatch::Source, dispatch::Preprocess, dispatch::Detector, dispatch::Classifier, dispatch::Decision, dispatch::Sink> composed;
+    BenchResult typed = timeIt("Pipeline<...> 1M frames, trivial stages", 20, [&] {
+        for (int i = 0; i < frames; i++) composed.step();
+    });
+
+    // Stages picked at runtime so the compiler can't devirtualise the calls
+    dispatch::VPreprocess preprocess;
+    dispatch::VDetector detector;
+    dispatch::VClassifier classifier;
+    dispatch::VDecision decision;
+    dispatch::VSink sink;
+    volatile int pick = 0;
+    dispatch::IPreprocess* preprocesses[] = { &preprocess };
+    dispatch::IDetector* detectors[] = { &detector };
+    dispatch::IClassifier* classifiers[] = { &classifier };
+    dispatch::IDecision* decisions[] = { &decision };
+    dispatch::ISink* sinks[] = { &sink };
+    dispatch::VirtualPipeline virtualPipeline{ preprocesses[pick], detectors[pick], classifiers[pick], decisions[pick], sinks[pick] };
+    dispatch::Source source;
+    BenchResult dynamic = timeIt("Virtual stages 1M frames, trivial stages", 20, [&] {
+        cv::Mat frame;
+        std::chrono::steady_clock::time_point captured;
+        for (int i = 0; i < frames; i++) {
+            source.next(frame, captured);
+            virtualPipeline.process(frame);
+        }
+    });
+
+    printResult(typed);
+    printResult(dynamic);
+    std::printf("%-40s %8.2f ns per frame removed by compile-time composition\n", "Pipeline dispatch overhead",
+        (dynamic.p50Us - typed.p50Us) * 1000.0 / frames);
+}
+
+void benchEyeClassifiers() {
+    // Eye crops at the size the eye cascade finds them in a 640x480 frame
+    cv::Mat openEye = loadBenchImage("eyeOpen.jpg");
+    cv::Mat closedEye = loadBenchImage("eyeClosed.jpg");
+    cv::resize(openEye, openEye, cv::Size(60, 40), 0, 0, cv::INTER_AREA);
+    cv::resize(closedEye, closedEye, cv::Size(60, 40), 0, 0, cv::INTER_AREA);
+
+    EyeStatus blobs;
+    printResult(timeIt("EyeStatus::detect per eye", 2000, [&] {
+        blobs.detect(openEye);
+    }));
+
+    EyeNet net;
+    printResult(timeIt(std::string("EyeNet per eye (") + EyeNetKernel::name() + ")", 2000, [&] {
+        net.classify(openEye);
+    }));
+
+    std::vector<cv::Mat> pair = { openEye, closedEye };
+    std::vector<EyeNet::Result> results;
+    BenchResult batch = timeIt("EyeNet both eyes in one call", 2000, [&] {
+        net.classify(pair, results);
+    });
+    printResult(batch);
+    std::printf("%-40s %8.1f us per eye, open %.2f / closed %.2f confidence\n", "EyeNet batched", batch.p50Us / 2,
+        results[0].confidence, results[1].confidence);
+
+    net.setScalar(true);
+    printResult(timeIt("EyeNet per eye (scalar)", 2000, [&] {
+        net.classify(openEye);
+    }));
+
+    // Motion gate in front of either classifier: a hit costs the thumbnail and one SAD
+    EyeCache cache(4.0f, std::numeric_limits<int>::max());
+    EyeCache::Entry entry;
+    size_t slot;
+    cv::Rect where(200, 150, openEye.cols, openEye.rows);
+    if (!cache.lookup(openEye, where, entry, slot)) {
+        cache.store(slot, entry);
+    }
+    printResult(timeIt("EyeCache lookup per eye (hit)", 2000, [&] {
+        cache.lookup(openEye, where, entry, slot);
+        cache.endFrame();
+    }));
+}
+
+void benchLowLight() {
+    // Night frame: the test face at a quarter of its brightness, as the IR camera delivers it
+    cv::Mat face = loadBenchImage("face_openeyes.jpg");
+    cv::resize(face, face, cv::Size(640, 480));
+    cv::Mat dark, grey, out;
+    face.convertTo(dark, CV_8U, 0.25);
+    cv::cvtColor(dark, grey, cv::COLOR_BGR2GRAY);
+
+    printResult(timeIt("LowLightEnhancer::measure 640x480", 2000, [&] {
+        LowLightEnhancer::measure(dark);
+    }));
+
+    LowLightEnhancer enhancer;
+    const LowLightKernel::Isa best = LowLightKernel::detected();
+    std::vector<LowLightKernel::Isa> sets = { LowLightKernel::SCALAR };
+    if (LowLightKernel::AVX2 == best) sets.push_back(LowLightKernel::SSE41);
+    if (LowLightKernel::SCALAR != best) sets.push_back(best);
+    for (LowLightKernel::Isa isa : sets) {
+        LowLightKernel::use(isa);
+        printResult(timeIt(std::string("LowLightEnhancer::enhance 640x480 (") + LowLightKernel::name(isa) + ")", 500, [&] {
+            enhancer.enhance(grey, out);
+        }));
+    }
+    LowLightKernel::use(best);
+
+    // OpenCV's own denoise and CLAHE for comparison
+    cv::Ptr<cv::CLAHE> clahe = cv::createCLAHE(3.0, cv::Size(8, 8));
+    cv::Mat blurred;
+    printResult(timeIt("cv::GaussianBlur 3x3 + cv::CLAHE 640x480", 500, [&] {
+        cv::GaussianBlur(grey, blurred, cv::Size(3, 3), 0);
+        clahe->apply(blurred, out);
+    }));
+
+    // What it saves in the cascades on a dark frame
+    DetectionParams params;
+    for (bool enabled : { false, true }) {
+        params.lowLight.enabled = enabled;
+        FrameProcessor processor(params);
+        processor.setDebugDisplay(false);
+        printResult(timeIt(std::string("processFrame dark 640x480, low-light ") + (enabled ? "on" : "off"), 50, [&] {
+            cv::Mat frame = dark.clone();
+            processor.processFrame(frame);
+        }));
+    }
+}
+
+void benchFatigueAnalytics() {
+    // A 30 fps shift with a blink every 4 s, long enough that the 5 min window is full
+    const std::chrono::microseconds period(33333);
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    int frame = 0;
+    auto nextSample = [&] {
+        EyeSample sample{ frame % 120 < 6 ? SLEEPING : AWAKE, 1.0f, t0 + frame * period };
+        frame++;
+        return sample;
+    };
+
+    FatigueAnalytics fatigue;
+    printResult(timeIt("FatigueAnalytics::update (all windows)", 20000, [&] {
+        fatigue.update(nextSample());
+    }));
+
+    // The naive way: keep 5 min of samples and rescan them for every window on every sample
+    std::deque<EyeSample> history;
+    double perclos = 0.0;
+    frame = 0;
+    printResult(timeIt("rescan 5 min history (all windows)", 20000, [&] {
+        EyeSample sample = nextSample();
+        history.push_back(sample);
+        while (sample.timestamp - history.front().timestamp > std::chrono::minutes(5)) {
+            history.pop_front();
+        }
+        for (int w = 0; w < FatigueAnalytics::WINDOW_COUNT; w++) {
+            auto since = sample.timestamp - std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(FatigueAnalytics::windowSeconds(FatigueAnalytics::Window(w))));
+            int closed = 0, face = 0;
+            for (auto it = history.rbegin(); it != history.rend() && it->timestamp > since; ++it) {
+                closed += SLEEPING == it->status;
+                face += NOFACE != it->status;
+            }
+            perclos += face ? double(closed) / face : 0.0;
+        }
+    }));
+    if (perclos < 0.0) std::cout << perclos << std::endl;  // keep the scan
+}
+
+void benchCapture() {
+    // One 640x480 frame, as a YUYV webcam and a GREY sensor deliver it
+    cv::Mat face = loadBenchImage("face_openeyes.jpg");
+    cv::resize(face, face, cv::Size(640, 480));
+    cv::Mat grey;
+    cv::cvtColor(face, grey, cv::COLOR_BGR2GRAY);
+    std::vector<uint8_t> yuyv(640 * 480 * 2, 128);
+    for (int y = 0; y < 480; y++) {
+        for (int x = 0; x < 640; x++) {
+            yuyv[(y * 640 + x) * 2] = grey.at<uchar>(y, x);
+        }
+    }
+    std::ofstream("bench_capture_yuyv.raw", std::ios::binary).write(reinterpret_cast<const char*>(yuyv.data()), yuyv.size());
+    std::ofstream("bench_capture_grey.raw", std::ios::binary).write(reinterpret_cast<const char*>(grey.data), grey.total());
+
+    // What cv::VideoCapture and the detectors do with every frame of a YUYV camera
+    cv::Mat packed(480, 640, CV_8UC2, yuyv.data());
+    printResult(timeIt("VideoCapture path YUYV->BGR->grey", 500, [&] {
+        cv::Mat bgr, out;
+        cv::cvtColor(packed, bgr, cv::COLOR_YUV2BGR_YUYV);
+        cv::cvtColor(bgr, out, cv::COLOR_BGR2GRAY);
+    }));
+
+    // The stand-in copies the frame into the buffer (the camera's DMA), that is included
+    for (uint32_t fourcc : { V4l2Device::GREY, V4l2Device::YUYV }) {
+        std::string file = V4l2Device::GREY == fourcc ? "bench_capture_grey.raw" : "bench_capture_yuyv.raw";
+        V4l2Capture capture(std::make_unique<V4l2FileDevice>(file, V4l2Device::makeFormat(fourcc, 640, 480), 0.0));
+        if (!capture.open(640, 480, 30)) continue;
+        printResult(timeIt("V4l2Capture::read " + V4l2Device::fourccName(fourcc) + " (stand-in)", 500, [&] {
+            cv::Mat frame;
+            capture.read(frame);
+        }));
+    }
+    std::remove("bench_capture_yuyv.raw");
+    std::remove("bench_capture_grey.raw");
+
+    // On a camera both paths wait for the frame, so compare the CPU time they spend per frame
+    const int frames = 90;
+    auto cpuUsPerFrame = [&](const std::function<bool(cv::Mat&)>& read) {
+        std::clock_t start = std::clock();
+        cv::Mat frame;
+        int framesRead = 0;
+        for (int i = 0; i < frames; i++) {
+            framesRead += read(frame) ? 1 : 0;
+        }
+        return framesRead > 0 ? 1e6 * (std::clock() - start) / CLOCKS_PER_SEC / framesRead : -1.0;
+    };
+    cv::VideoCapture videoCapture(0, cv::CAP_V4L2);
+    if (!videoCapture.isOpened()) {
+        std::cout << "No camera at /dev/video0, skipping the live capture comparison" << std::endl;
+        return;
+    }
+    videoCapture.set(cv::CAP_PROP_FRAME_WIDTH, 640);
+    videoCapture.set(cv::CAP_PROP_FRAME_HEIGHT, 480);
+    double videoCaptureUs = cpuUsPerFrame([&](cv::Mat& frame) {
+        cv::Mat bgr;
+        if (!videoCapture.read(bgr)) return false;
+        cv::cvtColor(bgr, frame, cv::COLOR_BGR2GRAY);
+        return true;
+    });
+    videoCapture.release();
+    std::printf("%-40s %8d frames  cpu %10.1f us/frame\n", "cv::VideoCapture /dev/video0 + grey", frames, videoCaptureUs);
+
+    V4l2Capture capture(std::make_unique<V4l2KernelDevice>("/dev/video0"));
+    if (capture.open(640, 480, 30)) {
+        double v4l2Us = cpuUsPerFrame([&](cv::Mat& frame) { return capture.read(frame); });
+        std::printf("%-40s %8d frames  cpu %10.1f us/frame\n", ("V4l2Capture /dev/video0 " + V4l2Device::fourccName(capture.format().fourcc)).c_str(), frames, v4l2Us);
+    }
+}
+
+namespace {
+    // The status path before the lock-free channel: the consumer holds the lock while it runs the decision engine
+    // on every queued sample, and producers wait for it
+    struct MutexStatusQueue {
+        std::queue<EyeSample> queue;
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool loading = false;
+
+        void push(const EyeSample& sample) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                queue.push(sample);
+            }
+            cv.notify_one();
+        }
+
+        template <typename Consume>
+        size_t drain(Consume&& consume) {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait_for(lock, std::chrono::milliseconds(100), [&] { return !queue.empty(); });
+            loading = true;
+            size_t taken = 0;
+            for (; !queue.empty(); taken++) {
+                consume(queue.front());
+                queue.pop();
+            }
+            loading = false;
+            return taken;
+        }
+    };
+
+    struct ChannelRun {
+        double samplesPerSecond = 0;
+        /// Longest single push call (waiting for the lock included, retries of a full channel not)
+        double maxPushUs = 0;
+        /// Pushes that found the channel full and were retried
+        uint64_t fullRetries = 0;
+    };
+
+    // Every producer pushes `perProducer` samples flat out (a pool of detector workers), one consumer runs
+    // SequentialSleepDetect on each of them
+    template <typename Push, typename Drain>
+    ChannelRun runProducers(int producers, int perProducer, Push&& push, Drain&& drain) {
+        using namespace std::chrono;
+        std::vector<double> maxPushUs(producers, 0.0);
+        std::atomic<uint64_t> retries{0};
+        std::atomic<bool> go{false};
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; p++) {
+            threads.emplace_back([&, p] {
+                while (!go) std::this_thread::yield();
+                auto t0 = steady_clock::now();
+                for (int i = 0; i < perProducer; i++) {
+                    EyeSample sample{ i % 90 < 5 ? 0 : 1, 0.9f, t0 + microseconds(33333) * i };
+                    while (true) {
+                        auto begin = steady_clock::now();
+                        bool pushed = push(sample);
+                        maxPushUs[p] = std::max(maxPushUs[p], duration<double, std::micro>(steady_clock::now() - begin).count());
+                        if (pushed) break;
+                        retries++;
+                        std::this_thread::yield();  // The consumer catches up; the live pipeline would drop the sample
+                    }
+                }
+            });
+        }
+
+        SequentialSleepDetect detector;
+        const size_t total = static_cast<size_t>(producers) * perProducer;
+        size_t consumed = 0;
+        auto start = steady_clock::now();
+        go = true;
+        while (consumed < total) {
+            consumed += drain(detector);
+        }
+        double seconds = duration<double>(steady_clock::now() - start).count();
+        for (std::thread& thread : threads) thread.join();
+
+        ChannelRun run;
+        run.samplesPerSecond = total / seconds;
+        run.maxPushUs = *std::max_element(maxPushUs.begin(), maxPushUs.end());
+        run.fullRetries = retries;
+        return run;
+    }
+}
+
+void benchStatusChannel() {
+    const int perProducer = 200000;
+    for (int producers : { 1, 2, 4 }) {
+        MutexStatusQueue mutexQueue;
+        ChannelRun locked = runProducers(producers, perProducer,
+            [&](const EyeSample& sample) { mutexQueue.push(sample); return true; },
+            [&](SequentialSleepDetect& detector) {
+                return mutexQueue.drain([&](const EyeSample& sample) { detector.update(sample); });
+            });
+
+        StatusChannel channel;
+        std::vector<EyeSample> batch;
+        batch.reserve(channel.capacity());
+        ChannelRun lockFree = runProducers(producers, perProducer,
+            [&](const EyeSample& sample) { return channel.push(sample); },
+            [&](SequentialSleepDetect& detector) {
+                channel.waitAndDrain(batch, std::chrono::milliseconds(100));
+                for (const EyeSample& sample : batch) detector.update(sample);
+                return batch.size();
+            });
+
+        std::printf("%-40s %10.0f samples/s  max push %8.1f us\n", ("std::queue + mutex, " + std::to_string(producers) + " producer(s)").c_str(),
+            locked.samplesPerSecond, locked.maxPushUs);
+        std::printf("%-40s %10.0f samples/s  max push %8.1f us  %llu full retries  %.2fx\n",
+            ("StatusChannel, " + std::to_string(producers) + " producer(s)").c_str(), lockFree.samplesPerSecond, lockFree.maxPushUs,
+            static_cast<unsigned long long>(lockFree.fullRetries), lockFree.samplesPerSecond / locked.samplesPerSecond);
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/// @brief Timing statistics of one benchmark
+struct BenchResult {
+    std::string name;
+    int iterations = 0;
+    double meanUs = 0;
+    double p50Us = 0;
+    double p99Us = 0;
+};
+
+/// @brief Allocations made so far by operator new (std containers) and by OpenCV's allocator (images)
+struct AllocationCount {
+    uint64_t heap = 0;
+    /// Stays 0 if OpenCV doesn't keep allocation statistics
+    uint64_t opencv = 0;
+};
+
+/// @brief Current allocation counters of the bench executable
+AllocationCount countAllocations();
+
+/// @brief Runs a function repeatedly (after a short warm-up) and collects its timing statistics
+/// @param name Name printed with the result
+/// @param iterations Number of timed runs
+/// @param fn Function to time
+/// @return Timing statistics
+BenchResult timeIt(const std::string& name, int iterations, const std::function<void()>& fn);
+
+/// @brief Prints a benchmark result as one line
+void printResult(const BenchResult& result);
+
+/// @brief Loads an image from test/images, exits if it is missing
+cv::Mat loadBenchImage(const std::string& name);
+
+/// @brief Reference cost of the detection path: FrameProcessor::processFrame on a face image
+void benchProcessFrame();
+
+/// @brief Per-frame cost of the black-box recorder on 640x480 camera frames
+void benchBlackBoxRecorder();
+
+/// @brief Allocations per processFrame call, on the first frame and once the scratch buffers have settled
+void benchFrameAllocations();
+
+/// @brief Per-frame cost of calling the stages through interfaces versus a compile-time composed Pipeline (trivial stages)
+void benchPipelineDispatch();
+
+/// @brief Per-eye latency of the blob detector against the int8 eye-state net (vector and scalar kernel, single and batched) and of a motion-gate hit
+void benchEyeClassifiers();
+
+/// @brief Low-light stage on a dark 640x480 frame: each kernel set against OpenCV's blur and CLAHE, and detection time with the stage off and on
+void benchLowLight();
+
+/// @brief Per-sample cost of the streaming fatigue windows against recomputing PERCLOS of every window from the raw 5 min history
+void benchFatigueAnalytics();
+
+/// @brief Per-frame cost of getting a grey 640x480 frame: the cv::VideoCapture path (YUYV to BGR to grey) against the V4L2 capture (GREY view, YUYV luma) on the stand-in device, and CPU time per frame of both on /dev/video0 if there is a camera
+void benchCapture();
+
+/// @brief Throughput of the lock-free status channel against the mutex-guarded queue it replaced, with 1, 2 and 4 producer threads feeding one consumer that runs the decision engine, and the longest time a producer was held up
+void benchStatusChannel();
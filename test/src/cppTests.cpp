@@ -1,11 +1,21 @@
 #include "cppTests.h"
 #include <cassert>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <thread>
 #include "../../src/modules/sleepDetect.h"
 #ifdef _WIN32
     #include <windows.h>
     #define sleep(x) Sleep(1000 * (x))  // Windows uses Sleep(ms)
 #else
     #include <unistd.h>  // Unix/Linux systems
+    #include <sys/socket.h>
+    #include <sys/un.h>
 #endif
 
 
@@ -16,9 +26,860 @@ bool test_action_activated_by_state_sleeping(){
     return true;
 }
 
+bool test_action_latency_bounded(){
+    ActionStateMachine myAction;
+    myAction.changeState(SLEEPING);
+    for (int i = 0; i < 50 && myAction.getLatency().count < 1; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    myAction.changeState(AWAKE);
+    for (int i = 0; i < 50 && myAction.getLatency().count < 2; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ActionStateMachine::Latency latency = myAction.getLatency();
+    assertm((latency.count == 2),"ActionStateMachine did not act on both state changes");
+    assertm((latency.maxMs < 100),"ActionStateMachine took longer than 100 ms to start or cancel an action");
+    return true;
+}
+
 bool test_action_deactivated_by_state_awake(){
     ActionStateMachine myAction;
     myAction.changeState(1);
     assertm((myAction.getState() != 0),"ActionStateMachine.changeState(1) did not work");
     return true;
-}
\ No newline at end of file
+}
+
+//helper that builds a sample of a clip recorded at 30 fps
+static EyeSample clipSample(int frame, bool open) {
+    EyeSample sample;
+    sample.status = open ? AWAKE : SLEEPING;
+    sample.openConfidence = open ? 1.0f : 0.0f;
+    sample.timestamp = std::chrono::steady_clock::time_point(std::chrono::milliseconds(frame * 1000 / 30));
+    return sample;
+}
+
+bool test_sequential_detect_microsleep_faster_than_threshold(){
+    SequentialSleepDetect detector;
+    int frame = 0;
+    for (; frame < 30; frame++) {
+        detector.update(clipSample(frame, true));
+    }
+    for (; frame < 90; frame++) {
+        detector.update(clipSample(frame, false));
+    }
+    assertm((detector.status() == SLEEPING),"SequentialSleepDetect did not detect a 2 s eye closure");
+    assertm((detector.events().size() == 1),"SequentialSleepDetect raised more than one alarm for a single closure");
+    assertm((detector.events()[0].latencyMs < 1500),"SequentialSleepDetect was not faster than the 1.5 s threshold");
+    return true;
+}
+
+bool test_sequential_detect_ignores_blinks(){
+    SequentialSleepDetect detector;
+    //ten blinks of 300 ms, three seconds apart
+    for (int frame = 0; frame < 900; frame++) {
+        bool open = (frame % 90) >= 9;
+        detector.update(clipSample(frame, open));
+    }
+    assertm((detector.status() == AWAKE),"SequentialSleepDetect reports a blinking driver as asleep");
+    assertm((detector.events().empty()),"SequentialSleepDetect raised an alarm on a blink");
+    return true;
+}
+
+bool test_thread_placement_reports_cpu_time(){
+    ThreadPlacement::configure(ThreadPlacement::DETECTOR, { {0}, 1, -1 });
+    std::thread worker([] {
+        ThreadPlacement::Scope placement(ThreadPlacement::DETECTOR);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    });
+    worker.join();
+    ThreadPlacement::configure(ThreadPlacement::DETECTOR, {});
+
+    std::ostringstream report;
+    ThreadPlacement::report(report);
+    assertm((report.str().find("detector thread CPU time") != std::string::npos),"ThreadPlacement did not report the CPU time of the detector thread");
+    return true;
+}
+
+bool test_deadline_counts_misses(){
+    Deadline::resetCounters();
+    auto now = std::chrono::steady_clock::now();
+    auto budget = Deadline::budget(Deadline::DETECT);
+    bool withinBudget = !Deadline::expired(Deadline::DETECT, now - budget / 2, now);
+    bool pastBudget = Deadline::expired(Deadline::DETECT, now - budget * 2, now);
+    assertm((withinBudget),"Deadline expired a frame within its budget");
+    assertm((pastBudget),"Deadline did not expire a frame past its budget");
+    assertm((Deadline::misses(Deadline::DETECT) == 1),"Deadline miss was not counted");
+    assertm((Deadline::checked(Deadline::DETECT) == 2),"Deadline checks were not counted");
+    assertm((Deadline::misses(Deadline::QUEUE) == 0),"Deadline miss was counted for the wrong stage");
+    return true;
+}
+
+bool test_stall_watchdog_flags_degraded(){
+    std::atomic<int> changes{0};
+    StallWatchdog watchdog(std::chrono::milliseconds(40), [&](bool) { changes++; });
+    watchdog.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(120));
+    assertm((watchdog.isDegraded()),"StallWatchdog did not flag a stall");
+    for (int i = 0; i < 10; i++) {
+        watchdog.feed();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    assertm((!watchdog.isDegraded()),"StallWatchdog did not recover after fresh decisions");
+    assertm((changes == 2 && watchdog.stallCount() == 1),"StallWatchdog reported the wrong number of state changes");
+    watchdog.stop();
+    return true;
+}
+
+//compares every field, the struct has padding so memcmp can't be used
+static bool sameTelemetry(const TelemetryRecord& a, const TelemetryRecord& b) {
+    return a.timestampUs == b.timestampUs && a.processingUs == b.processingUs &&
+        a.faceX == b.faceX && a.faceY == b.faceY && a.faceWidth == b.faceWidth && a.faceHeight == b.faceHeight &&
+        a.faces == b.faces && a.eyes == b.eyes && a.eyesOpen == b.eyesOpen && a.keypoints == b.keypoints &&
+        a.confidence == b.confidence && a.rawStatus == b.rawStatus && a.gatedStatus == b.gatedStatus;
+}
+
+bool test_telemetry_round_trip(){
+    std::remove("test_telemetry.womt");
+    std::vector<TelemetryRecord> written;
+    {
+        TelemetryWriter writer;
+        bool opened = writer.open("test_telemetry.womt");
+        assertm(opened,"TelemetryWriter could not open its file");
+        //more than one block, with a face that moves and disappears
+        for (int i = 0; i < 600; i++) {
+            TelemetryRecord record;
+            record.timestampUs = 1000000000LL + i * 33333;
+            record.processingUs = 20000 + (i % 7) * 100;
+            bool face = (i % 100) < 90;
+            record.faces = face ? 1 : 0;
+            record.faceX = face ? 200 + (i % 5) : 0;
+            record.faceY = face ? 120 - (i % 3) : 0;
+            record.faceWidth = face ? 180 : 0;
+            record.faceHeight = face ? 180 : 0;
+            record.eyes = face ? 2 : 0;
+            record.eyesOpen = face && (i % 30) > 3 ? 2 : 0;
+            record.keypoints = record.eyesOpen;
+            record.confidence = record.eyesOpen ? 255 : 0;
+            record.rawStatus = face ? (record.eyesOpen ? 1 : 0) : -1;
+            record.gatedStatus = face ? 1 : -1;
+            writer.log(record);
+            written.push_back(record);
+        }
+        writer.close();
+        assertm((writer.dropped() == 0),"TelemetryWriter dropped records");
+    }
+
+    std::vector<TelemetryRecord> read;
+    bool readOk = TelemetryReader::readAll("test_telemetry.womt", read);
+    assertm(readOk,"TelemetryReader could not read the file");
+    assertm((read.size() == written.size()),"TelemetryReader did not read all records");
+    for (size_t i = 0; i < read.size(); i++) {
+        assertm((sameTelemetry(read[i], written[i])),"TelemetryReader decoded a different record");
+    }
+
+    {
+        std::ifstream file("test_telemetry.womt", std::ios::binary | std::ios::ate);
+        assertm((file.tellg() < static_cast<std::streamoff>(written.size() * 16)),"Telemetry file is larger than 16 bytes per frame");
+    }
+
+    //a block torn by a power cut: 100 records announced, 4 bytes written
+    {
+        std::ofstream file("test_telemetry.womt", std::ios::binary | std::ios::app);
+        const uint8_t torn[] = { 100, 0, 0, 0, 4, 0, 0, 0, 0, 0, 0, 0 };
+        file.write(reinterpret_cast<const char*>(torn), sizeof(torn));
+    }
+    bool tornOk = TelemetryReader::readAll("test_telemetry.womt", read);
+    assertm((!tornOk),"TelemetryReader accepted a torn block");
+    assertm((read.size() == written.size()),"TelemetryReader kept rows of a torn block");
+
+    //a garbage block header must not be taken as an allocation size
+    std::vector<TelemetryRecord> none;
+    uint8_t payload[4] = {};
+    bool garbageOk = TelemetryReader::decodeBlock(payload, 0xFFFFFFF0u, 0xFFFFFFF0u, none);
+    assertm((!garbageOk && none.empty()),"TelemetryReader decoded an implausible block");
+    std::remove("test_telemetry.womt");
+    return true;
+}
+//runs one second of a microsleep clip paced by the given clock, stamping each sample with the clock
+//or, when replaying, with the recorded time of the frame
+static std::vector<SequentialSleepDetect::DetectionEvent> pacedClip(Clock& clock, std::vector<Clock::time_point>& times, bool replay) {
+    SequentialSleepDetect detector;
+    SimulatedClock* simulated = dynamic_cast<SimulatedClock*>(&clock);
+    for (int frame = 0; frame < 30; frame++) {
+        if (replay && nullptr != simulated) simulated->set(times[frame]);
+        EyeSample sample;
+        sample.status = frame < 5 ? AWAKE : SLEEPING;
+        sample.openConfidence = frame < 5 ? 1.0f : 0.0f;
+        sample.timestamp = clock.now();
+        if (!replay) times.push_back(sample.timestamp);
+        detector.update(sample);
+        clock.sleepFor(std::chrono::milliseconds(33));
+    }
+    return detector.events();
+}
+
+bool test_simulated_clock_replay_is_identical(){
+    std::vector<Clock::time_point> times;
+    auto start = std::chrono::steady_clock::now();
+    auto live = pacedClip(Clock::steady(), times, false);
+    double liveMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    SimulatedClock clock;
+    start = std::chrono::steady_clock::now();
+    auto replayed = pacedClip(clock, times, true);
+    double replayMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    assertm((live.size() == 1),"Paced clip did not raise the alarm");
+    assertm((replayed.size() == live.size()),"Replay raised a different number of alarms");
+    for (size_t i = 0; i < live.size(); i++) {
+        assertm((replayed[i].onset == live[i].onset && replayed[i].decision == live[i].decision
+            && replayed[i].latencyMs == live[i].latencyMs && replayed[i].frames == live[i].frames),"Replay decision differs from the live run");
+    }
+    assertm((replayMs * 10 < liveMs),"Simulated clock did not skip the pacing waits");
+
+    SimulatedClock paced;
+    paced.sleepFor(std::chrono::seconds(2));
+    assertm((paced.now() == Clock::time_point(std::chrono::seconds(2))),"SimulatedClock did not advance on sleepFor");
+    return true;
+}
+
+bool test_frame_arena_settles_without_heap(){
+    FrameArena arena(64 * 1024);
+    //a frame that needs more than the initial buffer spills onto the heap once, then the buffer has grown
+    for (int frame = 0; frame < 5; frame++) {
+        cv::Mat face = arena.mat(200, 200, CV_8UC3);
+        cv::Mat eye = arena.mat(40, 60, CV_8UC3);
+        std::pmr::vector<int> counts(arena.resource());
+        counts.resize(100);
+        assertm((face.isContinuous() && eye.data != face.data),"FrameArena handed out overlapping memory");
+        assertm((arena.used() >= 200 * 200 * 3 + 40 * 60 * 3),"FrameArena did not count its allocations");
+        arena.reset();
+    }
+    assertm((arena.overflows() == 1),"FrameArena did not settle after growing once");
+    assertm((arena.capacity() >= arena.highWater()),"FrameArena did not grow to the high-water mark");
+    assertm((arena.used() == 0),"FrameArena reset did not release the frame");
+    return true;
+}
+
+//fake stages: one face and one eye whenever the frame isn't empty, the eye is open when it is bright
+struct FakeDetector {
+    std::vector<cv::Rect> faceRects{ cv::Rect(0, 0, 8, 8) };
+    std::vector<cv::Rect> eyeRects{ cv::Rect(2, 2, 4, 4) };
+    std::vector<cv::Rect> none;
+    const std::vector<cv::Rect>& faces(const cv::Mat& image) { return image.empty() ? none : faceRects; }
+    const std::vector<cv::Rect>& eyes(const cv::Mat&) { return eyeRects; }
+};
+struct BrightEyeClassifier {
+    EyeState classify(const cv::Mat& eye) { return cv::mean(eye)[0] > 100 ? EyeState::Open : EyeState::Closed; }
+};
+struct RecordingSink {
+    std::vector<DriverState> states;
+    void act(DriverState state) { states.push_back(state); }
+};
+
+bool test_pipeline_policies_typed_states(){
+    static_assert(toStatus(DriverState::Asleep) == SLEEPING && toStatus(DriverState::Awake) == AWAKE && toStatus(EyeState::NoFace) == NOFACE);
+    static_assert(toDriverState(SLEEPING) == DriverState::Asleep && toDriverState(42) == DriverState::NoFace);
+
+    Pipeline<StillImageSource, GreyPreprocess, FakeDetector, BrightEyeClassifier, MajorityDecision<30>, RecordingSink> pipeline;
+    pipeline.source.image = cv::Mat(8, 8, CV_8UC3, cv::Scalar(200, 200, 200));
+    pipeline.source.remaining = 30;
+    while (pipeline.step()) {}
+    assertm((pipeline.observation().state == EyeState::Open && pipeline.observation().openConfidence == 1.0f),"Pipeline did not see the open eye");
+    assertm((pipeline.state() == DriverState::Awake),"Pipeline did not decide awake on open eyes");
+
+    pipeline.source.image = cv::Mat(8, 8, CV_8UC3, cv::Scalar(20, 20, 20));
+    pipeline.source.remaining = 30;
+    while (pipeline.step()) {}
+    assertm((pipeline.state() == DriverState::Asleep),"Pipeline did not decide asleep on closed eyes");
+    assertm((pipeline.sink.states.size() == 60 && pipeline.sink.states.back() == DriverState::Asleep),"Sink did not get every decision");
+    assertm((pipeline.observation().captured == std::chrono::steady_clock::time_point(std::chrono::microseconds(59 * 33333))),"Pipeline lost the capture time");
+    return true;
+}
+
+#ifndef _WIN32
+//minimal scraper: one HTTP request over the Unix socket, returns the whole response
+static std::string scrapeUnixSocket(const std::string& path){
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    if (fd < 0 || 0 != connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address))) {
+        if (fd >= 0) close(fd);
+        return "";
+    }
+    const char request[] = "GET /metrics HTTP/1.0\r\nHost: localhost\r\n\r\n";
+    send(fd, request, sizeof(request) - 1, 0);
+    std::string response;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) response.append(buffer, n);
+    close(fd);
+    return response;
+}
+#endif
+
+bool test_metrics_prometheus_scrape(){
+    Counter& scrapes = Metrics::counter("test_scrapes_total", "Test counter", "kind=\"unit\"");
+    Gauge& depth = Metrics::gauge("test_depth", "Test gauge");
+    Histogram& latency = Metrics::histogram("test_latency_ms", "Test histogram", { 1, 10, 100 });
+    scrapes.inc(3);
+    assertm((&Metrics::counter("test_scrapes_total", "Test counter", "kind=\"unit\"") == &scrapes),"Registering a metric twice created a second one");
+    depth.set(7);
+    latency.observe(0.5);
+    latency.observe(10);
+    latency.observe(250);
+
+    std::string text = Metrics::text();
+    assertm((text.find("# TYPE test_scrapes_total counter\ntest_scrapes_total{kind=\"unit\"} 3\n") != std::string::npos),"Counter missing from the exposition");
+    assertm((text.find("test_depth 7\n") != std::string::npos),"Gauge missing from the exposition");
+    assertm((text.find("test_latency_ms_bucket{le=\"1\"} 1\n") != std::string::npos
+        && text.find("test_latency_ms_bucket{le=\"10\"} 2\n") != std::string::npos
+        && text.find("test_latency_ms_bucket{le=\"+Inf\"} 3\n") != std::string::npos
+        && text.find("test_latency_ms_sum 260.5\n") != std::string::npos
+        && text.find("test_latency_ms_count 3\n") != std::string::npos),"Histogram buckets are not cumulative");
+
+    #ifndef _WIN32
+    MetricsServer server;
+    MetricsServer::Config config;
+    config.unixPath = "/tmp/wake-o-matic-test.metrics";
+    bool started = server.start(config);
+    assertm((started),"Metrics server did not start");
+    std::string response = scrapeUnixSocket(config.unixPath);
+    assertm((response.rfind("HTTP/1.0 200 OK", 0) == 0 && response.find("test_depth 7\n") != std::string::npos),"Scrape did not return the metrics");
+    assertm((server.scrapes() == 1),"Metrics server did not count the scrape");
+    server.stop();
+    #endif
+    return true;
+}
+
+bool test_parameter_sweep_front_and_config(){
+    //one second open, a blink, then a microsleep the replay raises its alarm for after 900 ms, plus one false alarm
+    std::vector<LabelledInterval> labels = { { 0, 999, LabelledInterval::OPEN_EYES }, { 1000, 1299, LabelledInterval::CLOSED_EYES },
+        { 1300, 2999, LabelledInterval::MICROSLEEP } };
+    std::vector<EyeSample> samples;
+    for (int ms = 0; ms < 3000; ms += 100) {
+        int status = ms < 1000 ? AWAKE : SLEEPING;
+        if (ms == 500) status = SLEEPING;  //one wrong frame
+        samples.push_back({ status, status == AWAKE ? 1.0f : 0.0f, std::chrono::steady_clock::time_point(std::chrono::milliseconds(ms)) });
+    }
+    SequentialSleepDetect::DetectionEvent alarm;
+    alarm.decision = std::chrono::steady_clock::time_point(std::chrono::milliseconds(2200));
+    SequentialSleepDetect::DetectionEvent falseAlarm;
+    falseAlarm.decision = std::chrono::steady_clock::time_point(std::chrono::milliseconds(600));
+    ReplayScore score = scoreReplay(samples, { falseAlarm, alarm }, labels);
+    assertm((score.labelledFrames == 30 && score.correctFrames == 29),"Frame accuracy not scored against the labels");
+    assertm((score.microsleeps == 1 && score.detected == 1 && score.falseAlarms == 1 && score.meanLatencyMs() == 900),"Alarms not matched to the microsleep");
+
+    //fast and inaccurate, slow and accurate, and one that is worse than the second in everything
+    std::vector<SweepPoint> points(3);
+    points[0].fps = 40; points[0].score = { 100, 90, 1, 1, 0, 500 };
+    points[1].fps = 20; points[1].score = { 100, 99, 1, 1, 0, 400 };
+    points[2].fps = 15; points[2].score = { 100, 95, 1, 1, 0, 600 };
+    points[0].params.face.scaleFactor = 1.3;
+    std::vector<size_t> front = paretoFront(points);
+    assertm((front == std::vector<size_t>({ 0, 1 })),"Pareto front kept a dominated configuration");
+    assertm((chooseConfiguration(points, front, 0.02) == 1 && chooseConfiguration(points, front, 0.1) == 0),"Wrong configuration chosen from the front");
+
+    const char* path = "test_detection_params.conf";
+    DetectionParams tuned = points[0].params;
+    tuned.blob.minArea = 120;
+    tuned.eyes.minNeighbors = 3;
+    bool saved = tuned.save(path, "test");
+    assertm((saved),"Could not save the configuration");
+    DetectionParams loaded;
+    bool loadedOk = loaded.load(path);
+    assertm((loadedOk),"Could not load the configuration");
+    std::remove(path);
+    for (const std::string& key : DetectionParams::keys()) {
+        assertm((std::abs(loaded.get(key) - tuned.get(key)) < 1e-6),"Configuration changed on the round trip");
+    }
+    bool missingLoaded = DetectionParams().load("does_not_exist.conf");
+    assertm((!missingLoaded),"Loading a missing configuration succeeded");
+    return true;
+}
+
+//24x24 grey eye crop drawn like the calibration crops of makeEyeNetWeights.py, from a different seed
+static cv::Mat syntheticEye(std::mt19937& rng, bool open){
+    auto uniform = [&](double lo, double hi) { return std::uniform_real_distribution<double>(lo, hi)(rng); };
+    auto clampPixel = [](double v) { return std::max(0.0, std::min(255.0, v)); };
+    const int size = 24;
+    std::vector<double> img(size * size, uniform(90, 200));
+    double skin = img[0];
+    double cx = 11.5 + uniform(-2, 2), cy = 11.5 + uniform(-2, 2);
+    if (open) {
+        double a = uniform(8, 11), b = uniform(2.5, 6);
+        double sclera = clampPixel(skin + uniform(20, 50)), iris = uniform(20, 70), r = uniform(3.5, 5.5);
+        double ix = cx + uniform(-2, 2);
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                double e = std::pow((x - cx) / a, 2) + std::pow((y - cy) / b, 2);
+                double d = std::hypot(x - ix, y - cy);
+                if (e <= 1) img[y * size + x] = d < 0.45 * r ? iris - 15 : d < r ? iris : sclera;
+                else if (e <= 1.35 && y < cy) img[y * size + x] = clampPixel(skin - 60);
+            }
+        }
+        if (uniform(0, 1) < 0.5) {
+            for (int y = int(cy) - 1; y < int(cy) + 1; y++)
+                for (int x = int(ix) - 1; x < int(ix) + 1; x++) img[y * size + x] = 250;
+        }
+    }
+    else {
+        double k = uniform(0.5, 1.5), lid = uniform(20, 70);
+        int thick = uniform(0, 1) < 0.5 ? 1 : 2;
+        for (int x = 0; x < size; x++) {
+            double yl = cy + k * (x - cx) * (x - cx) / 40;
+            for (int y = 0; y < size; y++) {
+                if (y - yl >= 0 && y - yl < thick) img[y * size + x] = lid;
+                else if (y - yl >= thick) img[y * size + x] = clampPixel(skin - 10);
+            }
+        }
+    }
+    if (uniform(0, 1) < 0.3) {  //glasses frame
+        int line = 1 + int(uniform(0, 2.99));
+        for (int i = 0; i < size; i++) img[line * size + i] = 40;
+    }
+    if (uniform(0, 1) < 0.3) {  //glare on the glasses
+        int gx = int(uniform(0, size - 3)), gy = int(uniform(0, size - 3));
+        for (int y = gy; y < gy + 3; y++)
+            for (int x = gx; x < gx + 3; x++) img[y * size + x] = 255;
+    }
+    cv::Mat eye(size, size, CV_8UC1);
+    double noise = uniform(0, 8);
+    for (int i = 0; i < size * size; i++) eye.data[i] = static_cast<uchar>(clampPixel(std::round(img[i] + uniform(-noise, noise))));
+    return eye;
+}
+
+//checks the kernels and the batching; the accuracy check is on the synthetic crops the built-in weights were fitted to,
+//it says nothing about real eyes (the built-in weights are a placeholder, see DetectionParams::useEyeNet)
+bool test_eye_net_classifies_synthetic_eyes(){
+    std::mt19937 rng(7);
+    EyeNet net;
+    EyeNet scalar;
+    scalar.setScalar(true);
+    int correct = 0;
+    const int crops = 200;
+    for (int i = 0; i < crops; i++) {
+        bool open = i % 2 == 0;
+        cv::Mat eye = syntheticEye(rng, open);
+        EyeNet::Result result = net.classify(eye);
+        assertm((result.confidence == scalar.classify(eye).confidence),"Vector and scalar kernel disagree");
+        assertm((result.confidence >= 0.0f && result.confidence <= 1.0f),"Confidence is not a probability");
+        if (result.open == open) correct++;
+    }
+    assertm((correct >= crops * 9 / 10),"Eye net misclassified more than one in ten synthetic eyes");
+
+    //both eyes in one call give the same answers as one at a time, also for BGR crops of another size
+    cv::Mat left, right;
+    cv::resize(syntheticEye(rng, true), left, cv::Size(60, 40), 0, 0, cv::INTER_AREA);
+    cv::cvtColor(syntheticEye(rng, false), right, cv::COLOR_GRAY2BGR);
+    std::vector<EyeNet::Result> results;
+    net.classify({ left, right }, results);
+    assertm((results.size() == 2 && results[0].confidence == net.classify(left).confidence
+        && results[1].confidence == net.classify(right).confidence),"Batched results differ from single ones");
+
+    int8_t a[32], b[32];
+    for (int i = 0; i < 32; i++) { a[i] = static_cast<int8_t>(i * 37 - 127); b[i] = static_cast<int8_t>(127 - i * 29 % 255); }
+    assertm((EyeNetKernel::dot(a, b, 32) == EyeNetKernel::dotScalar(a, b, 32)),"Vector dot product is wrong");
+    return true;
+}
+
+//one eye over time: fixed look, lid closed by `closure` (0 open, 1 shut), sensor noise per frame
+static cv::Mat eyeFrame(std::mt19937& rng, double closure, int shiftY){
+    auto uniform = [&](double lo, double hi) { return std::uniform_real_distribution<double>(lo, hi)(rng); };
+    const int size = 24;
+    const double skin = 150, cx = 11.5, cy = 11.5 + shiftY;
+    std::vector<double> img(size * size, skin);
+    if (closure < 0.8) {
+        double a = 10, b = 5 * (1 - closure), r = 4.5;
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                double e = std::pow((x - cx) / a, 2) + std::pow((y - cy) / b, 2);
+                double d = std::hypot(x - cx, y - cy);
+                if (e <= 1) img[y * size + x] = d < 2 ? 30 : d < r ? 50 : 190;
+                else if (e <= 1.35 && y < cy) img[y * size + x] = 90;
+            }
+        }
+    }
+    else {
+        for (int x = 0; x < size; x++) {
+            double yl = cy + (x - cx) * (x - cx) / 40;
+            for (int y = 0; y < size; y++) {
+                if (y - yl >= 0 && y - yl < 2) img[y * size + x] = 45;
+                else if (y - yl >= 2) img[y * size + x] = 140;
+            }
+        }
+    }
+    cv::Mat eye(size, size, CV_8UC1);
+    for (int i = 0; i < size * size; i++) eye.data[i] = static_cast<uchar>(std::max(0.0, std::min(255.0, std::round(img[i] + uniform(-3, 3)))));
+    return eye;
+}
+
+bool test_eye_cache_keeps_blink_onsets(){
+    uint8_t a[300], b[300];
+    for (int i = 0; i < 300; i++) { a[i] = static_cast<uint8_t>(i * 7); b[i] = static_cast<uint8_t>(255 - i * 3); }
+    assertm((EyeCacheKernel::sad(a, b, 300) == EyeCacheKernel::sadScalar(a, b, 300)),"Vector SAD is wrong");
+
+    //300 frames: a blink every 30 frames, the head drifting by a pixel, a slow closure at the end
+    const int frames = 300;
+    std::vector<double> closure(frames, 0.0);
+    const double blink[] = { 0.4, 1.0, 1.0, 0.4 };
+    for (int start = 20; start + 4 < 240; start += 30) {
+        for (int i = 0; i < 4; i++) closure[start + i] = blink[i];
+    }
+    for (int i = 250; i < frames; i++) closure[i] = std::min(1.0, (i - 250) * 0.04);
+
+    std::mt19937 rng(11);
+    EyeNet net;
+    EyeCache cache;
+    std::vector<bool> full, gated;
+    for (int i = 0; i < frames; i++) {
+        int shift = (i / 50) % 2;
+        cv::Mat eye = eyeFrame(rng, closure[i], shift);
+        cv::Rect where(200 + shift, 150 + shift, 24, 24);
+        bool open = net.classify(eye).open;
+        full.push_back(open);
+
+        EyeCache::Entry entry;
+        size_t slot;
+        if (!cache.lookup(eye, where, entry, slot)) {
+            entry.open = open;
+            cache.store(slot, entry);
+        }
+        cache.endFrame();
+        gated.push_back(entry.open);
+    }
+
+    int onsets = 0;
+    for (int i = 1; i < frames; i++) {
+        if (full[i - 1] && !full[i]) {
+            onsets++;
+            assertm((!gated[i] || (i + 1 < frames && !gated[i + 1])),"Blink onset delayed by more than one frame");
+        }
+    }
+    assertm((onsets >= 8),"Replay has too few blinks for the eye net");
+    assertm((cache.hitRate() > 0.5),"Motion gate reused too few results");
+    assertm((cache.hits() + cache.misses() == frames),"Every lookup counts as a hit or a miss");
+
+    //an eye that moved elsewhere is a new eye, a disabled cache never hits
+    EyeCache::Entry entry;
+    size_t slot;
+    cv::Mat eye = eyeFrame(rng, 0.0, 0);
+    assertm((!cache.lookup(eye, cv::Rect(400, 150, 24, 24), entry, slot)),"Cache matched an eye at another position");
+    EyeCache off(0.0f);
+    for (int i = 0; i < 3; i++) {
+        assertm((!off.lookup(eye, cv::Rect(200, 150, 24, 24), entry, slot)),"Disabled cache reused a result");
+        off.store(slot, entry);
+        off.endFrame();
+    }
+    return true;
+}
+
+//grey frame of the given brightness: soft gradient, a darker blob like a face, sensor noise
+static cv::Mat greyFrame(int width, int height, int level, int spread, int noise, unsigned seed){
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> jitter(-noise, noise);
+    cv::Mat frame(height, width, CV_8UC1);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            double blob = std::hypot(x - width / 2.0, y - height / 2.0) < height / 3.0 ? -spread / 2.0 : 0.0;
+            double v = level + spread * (x / static_cast<double>(width) - 0.5) + blob + jitter(rng);
+            frame.at<uchar>(y, x) = static_cast<uchar>(std::max(0.0, std::min(255.0, v)));
+        }
+    }
+    return frame;
+}
+
+bool test_low_light_stage(){
+    //odd sizes, so the vector loops have tails
+    cv::Mat dark = greyFrame(203, 117, 30, 24, 6, 5);
+    LowLightEnhancer enhancer;
+    cv::Mat reference, out;
+    LowLightKernel::use(LowLightKernel::SCALAR);
+    enhancer.enhance(dark, reference);
+    const LowLightKernel::Isa sets[] = { LowLightKernel::SSE41, LowLightKernel::AVX2, LowLightKernel::NEON };
+    for (LowLightKernel::Isa isa : sets) {
+        LowLightKernel::use(isa);
+        enhancer.enhance(dark, out);
+        bool same = out.rows == reference.rows && out.cols == reference.cols;
+        for (int y = 0; same && y < out.rows; y++) {
+            same = 0 == std::memcmp(out.ptr<uchar>(y), reference.ptr<uchar>(y), out.cols);
+        }
+        assertm((same),"Vector low-light kernel differs from the scalar one");
+    }
+    LowLightKernel::use(LowLightKernel::detected());
+
+    LowLightEnhancer::Stats before = LowLightEnhancer::measure(dark);
+    LowLightEnhancer::Stats after = LowLightEnhancer::measure(reference);
+    assertm((after.contrast > 1.5 * before.contrast && after.mean > before.mean),"Low-light stage did not raise the contrast");
+
+    //bright frames pass through, dark ones are enhanced; once on, it stays on until the frame is clearly brighter
+    LowLightParams params;
+    LowLightEnhancer stage(params);
+    cv::Mat bgr;
+    cv::cvtColor(greyFrame(160, 120, 130, 120, 4, 6), bgr, cv::COLOR_GRAY2BGR);
+    bool enhanced = stage.process(bgr, out);
+    assertm((!enhanced && !stage.isActive()),"Low-light stage switched on for a bright frame");
+    enhanced = stage.process(dark, out);
+    assertm((enhanced && out.type() == CV_8UC1 && stage.enhancedFrames() == 1),"Low-light stage skipped a dark frame");
+    cv::Mat dusk;
+    for (int level = static_cast<int>(params.maxBrightness); LowLightEnhancer::measure(dusk).mean < params.maxBrightness + 3; level++) {
+        dusk = greyFrame(160, 120, level, 120, 4, 7);  //just above the threshold, well below the switch-off point
+    }
+    enhanced = stage.process(dusk, out);
+    assertm((enhanced),"Low-light stage flickered off around the threshold");
+    enhanced = LowLightEnhancer(params).process(dusk, out);
+    assertm((!enhanced),"Low-light stage switched on above the threshold");
+    enhanced = stage.process(bgr, out);
+    assertm((!enhanced),"Low-light stage stayed on for a bright frame");
+    params.enabled = false;
+    stage.setParams(params);
+    enhanced = stage.process(dark, out);
+    assertm((!enhanced),"Disabled low-light stage enhanced a frame");
+    return true;
+}
+
+bool test_startup_orchestrator(){
+    StartupOrchestrator startup;
+    auto slowPhase = [] { std::this_thread::sleep_for(std::chrono::milliseconds(150)); return true; };
+    startup.launch("camera", ThreadPlacement::CAPTURE, slowPhase);
+    startup.launch("classifiers", ThreadPlacement::DETECTOR, slowPhase);
+    startup.launch("audio", ThreadPlacement::ACTION, [] () -> bool { throw std::runtime_error("no sound card"); });
+    bool allOk = startup.wait();
+    assertm((!allOk),"A phase that threw counted as a success");
+    assertm((startup.elapsedMs() < 280),"Launched phases did not run concurrently");
+
+    bool warmedUp = startup.run("warm-up", [] { return true; });
+    bool checked = startup.run("check", [] { return false; });
+    assertm((warmedUp && !checked),"Sequential phases reported the wrong outcome");
+    std::vector<StartupOrchestrator::Phase> phases = startup.phases();
+    assertm((phases.size() == 5 && phases[0].name == "camera" && phases[0].concurrent && !phases[3].concurrent),"Phases missing from the breakdown");
+    assertm((phases[0].ok && phases[0].durationMs() >= 140 && !phases[2].ok && phases[2].error == "no sound card"),"Phase timing or error lost");
+    assertm((phases[3].startMs >= phases[1].endMs),"Sequential phase started before the launched ones finished");
+
+    assertm((startup.firstDecisionMs() < 0),"First decision recorded before there was one");
+    startup.markFirstDecision();
+    double first = startup.firstDecisionMs();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    startup.markFirstDecision();
+    assertm((first > 0 && startup.firstDecisionMs() == first),"First decision time was overwritten");
+
+    std::ostringstream report;
+    startup.report(report);
+    assertm((report.str().find("no sound card") != std::string::npos && report.str().find("first valid decision") != std::string::npos),"Report lacks the failure or the first decision");
+    return true;
+}
+
+bool test_fatigue_analytics_windows(){
+    FatigueAnalytics fatigue;
+    assertm((fatigue.window(FatigueAnalytics::ONE_MINUTE).seconds == 0),"Empty analytics reported a window");
+
+    //30 fps, a 6 frame (200 ms) blink every 4 s: 15 blinks/min and 5 % PERCLOS
+    const std::chrono::microseconds period(33333);
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    const int frames = 20 * 60 * 30;
+    const int longClosureAt = 18 * 60 * 30;
+    const int noFaceFrom = 10 * 60 * 30;
+    for (int i = 0; i < frames; i++) {
+        int status = i % 120 < 6 ? SLEEPING : AWAKE;
+        if (i >= longClosureAt && i < longClosureAt + 60) status = SLEEPING;  //2 s
+        if (i >= noFaceFrom && i < noFaceFrom + 900) status = NOFACE;          //30 s, blinks and all
+        fatigue.update({ status, 1.0f, t0 + i * period });
+        if (i == 2 * 60 * 30 + 6) {
+            FatigueAnalytics::WindowStats second = fatigue.window(FatigueAnalytics::ONE_SECOND);
+            assertm((second.blinks == 1 && std::abs(second.meanBlinkMs - 200) < 1),"1 s window missed the blink that just ended");
+        }
+        if (i == noFaceFrom + 900) {
+            FatigueAnalytics::WindowStats lost = fatigue.window(FatigueAnalytics::ONE_MINUTE);
+            assertm((std::abs(lost.faceSeconds - 30) < 0.5 && std::abs(lost.perclos - 0.05) < 0.01),"Time without a face counted towards PERCLOS");
+        }
+    }
+
+    FatigueAnalytics::WindowStats minute = fatigue.window(FatigueAnalytics::ONE_MINUTE);
+    assertm((std::abs(minute.seconds - 60) < 1.01),"60 s window covers the wrong time");
+    assertm((std::abs(minute.blinksPerMinute - 15) < 1.5 && std::abs(minute.meanBlinkMs - 200) < 1),"Wrong blink rate or duration over 60 s");
+    assertm((minute.longClosures == 0 && std::abs(minute.perclos - 0.05) < 0.005),"Wrong PERCLOS over 60 s");
+    FatigueAnalytics::WindowStats tenSeconds = fatigue.window(FatigueAnalytics::TEN_SECONDS);
+    assertm((tenSeconds.blinks >= 2 && tenSeconds.blinks <= 3),"Wrong blink count over 10 s");
+    FatigueAnalytics::WindowStats fiveMinutes = fatigue.window(FatigueAnalytics::FIVE_MINUTES);
+    assertm((fiveMinutes.longClosures == 1 && std::abs(fiveMinutes.blinksPerMinute - 15) < 1.5),"5 min window lost the long closure");
+    assertm((fiveMinutes.perclos > 0.05 && fiveMinutes.perclos < 0.06 && std::abs(fiveMinutes.seconds - 300) < 10.01),"Wrong PERCLOS over 5 min");
+
+    //a closure in progress only counts once the eyes open again
+    std::chrono::steady_clock::time_point t = t0 + frames * period;
+    for (int i = 0; i < 30; i++) {
+        fatigue.update({ SLEEPING, 1.0f, t + i * period });
+    }
+    assertm((std::abs(fatigue.currentClosureMs() - 29 * 33.333) < 1 && fatigue.window(FatigueAnalytics::FIVE_MINUTES).longClosures == 1),"Closure in progress miscounted");
+
+    //after a pause longer than every window nothing old is left
+    fatigue.update({ AWAKE, 1.0f, t + std::chrono::minutes(10) });
+    FatigueAnalytics::WindowStats resumed = fatigue.window(FatigueAnalytics::FIVE_MINUTES);
+    assertm((resumed.blinks == 0 && resumed.longClosures == 1 && resumed.faceSeconds < 0.5),"Windows kept samples from before the pause");
+
+    std::string scrape = Metrics::text();
+    assertm((scrape.find("wakeomatic_perclos{window=\"60s\"}") != std::string::npos),"PERCLOS gauge not exported");
+    return true;
+}
+
+//raw frames of one format back to back, frame i filled with luma i*10+1 (and chroma 128)
+static void writeRawFrames(const char* path, const V4l2Device::Format& format, int frames){
+    std::ofstream file(path, std::ios::binary);
+    for (int i = 0; i < frames; i++) {
+        std::vector<char> frame(format.imageBytes, char(128));
+        for (int y = 0; y < format.height; y++) {
+            for (int x = 0; x < format.width; x++) {
+                if (V4l2Device::YUYV == format.fourcc) frame[y * format.bytesPerLine + 2 * x] = char(i * 10 + 1);
+                else frame[y * format.bytesPerLine + x] = char(i * 10 + 1);
+            }
+        }
+        file.write(frame.data(), frame.size());
+    }
+}
+
+bool test_v4l2_capture_stand_in(){
+    const char* path = "test_v4l2_grey.raw";
+    V4l2Device::Format grey = V4l2Device::makeFormat(V4l2Device::GREY, 64, 48);
+    writeRawFrames(path, grey, 3);
+
+    SimulatedClock clock;
+    auto device = std::make_unique<V4l2FileDevice>(path, grey, 30.0, &clock);
+    V4l2FileDevice* standIn = device.get();
+    auto capture = std::make_unique<V4l2Capture>(std::move(device));
+    bool ok = capture->open(64, 48, 30, 3);
+    assertm((ok && capture->format().fourcc == V4l2Device::GREY && capture->zeroCopy()),"Stand-in did not open as a GREY device");
+
+    cv::Mat frame;
+    ok = capture->read(frame);
+    assertm((ok && frame.type() == CV_8UC1 && frame.cols == 64 && frame.rows == 48 && frame.at<uchar>(47, 63) == 1),"Wrong first frame");
+    assertm((frame.data == standIn->bufferData(0) && capture->buffersInUse() == 1 && standIn->queuedBuffers() == 2),"Frame is not a view of the driver buffer");
+
+    //ROIs and copies (like the one in frame_queue) keep the buffer, the last one gives it back
+    cv::Mat roi = frame(cv::Rect(8, 8, 16, 16));
+    cv::Mat queuedCopy = frame;
+    frame.release();
+    queuedCopy.release();
+    assertm((capture->buffersInUse() == 1 && roi.at<uchar>(0, 0) == 1),"Buffer given back while a ROI still used it");
+    roi.release();
+    assertm((capture->buffersInUse() == 0 && standIn->queuedBuffers() == 3),"Released buffer was not requeued");
+
+    //all buffers held: the capture waits instead of overwriting them
+    std::vector<cv::Mat> held(3);
+    for (cv::Mat& m : held) {
+        ok = capture->read(m);
+        assertm((ok),"Capture failed with free buffers");
+    }
+    assertm((held[0].at<uchar>(0, 0) == 11 && held[1].at<uchar>(0, 0) == 21 && held[2].at<uchar>(0, 0) == 1),"Stand-in did not loop over its frames");
+    ok = capture->read(frame, 20);
+    assertm((!ok && capture->buffersInUse() == 3),"Capture overwrote a held buffer");
+    held[1].release();
+    ok = capture->read(frame);
+    assertm((ok && frame.data == standIn->bufferData(2) && frame.at<uchar>(0, 0) == 11),"Requeued buffer was not refilled");
+    assertm((standIn->framesDelivered() == 5 && std::abs(std::chrono::duration<double, std::milli>(clock.now().time_since_epoch()).count() - 4 * 1000.0 / 30) < 1),"Stand-in is not paced at its frame rate");
+
+    //frames outlive the capture
+    capture.reset();
+    assertm((frame.at<uchar>(10, 10) == 11 && held[0].at<uchar>(0, 0) == 11),"Frames lost their buffers with the capture");
+    frame.release();
+    held.clear();
+    std::remove(path);
+
+    //a YUYV-only device: the luma is picked out and the buffer goes straight back
+    path = "test_v4l2_yuyv.raw";
+    V4l2Device::Format yuyv = V4l2Device::makeFormat(V4l2Device::YUYV, 32, 16);
+    writeRawFrames(path, yuyv, 2);
+    auto yuyvDevice = std::make_unique<V4l2FileDevice>(path, yuyv, 0.0);
+    V4l2FileDevice* yuyvStandIn = yuyvDevice.get();
+    V4l2Capture packed(std::move(yuyvDevice));
+    ok = packed.open(32, 16, 30, 2);
+    assertm((ok && packed.format().fourcc == V4l2Device::YUYV && !packed.zeroCopy()),"Did not fall back to YUYV");
+    ok = packed.read(frame);
+    assertm((ok && frame.type() == CV_8UC1 && frame.cols == 32 && frame.at<uchar>(15, 31) == 1),"Wrong luma from YUYV");
+    assertm((packed.buffersInUse() == 0 && yuyvStandIn->queuedBuffers() == 2),"YUYV buffer was not requeued at once");
+    std::remove(path);
+
+    ok = V4l2Capture(std::make_unique<V4l2FileDevice>("missing.raw", grey)).open();
+    assertm((!ok),"Opened a missing file");
+    return true;
+}
+
+bool test_status_channel_batches(){
+    StatusChannel channel(8);
+    std::vector<EyeSample> batch;
+    auto t0 = std::chrono::steady_clock::now();
+    auto begin = std::chrono::steady_clock::now();
+    size_t taken = channel.waitAndDrain(batch, std::chrono::milliseconds(20));
+    assertm((taken == 0 && std::chrono::steady_clock::now() - begin >= std::chrono::milliseconds(20)),"Waiting on an idle channel did not time out");
+
+    //one batch, oldest first, confidence and timestamp carried along
+    for (int i = 0; i < 5; i++) {
+        bool pushed = channel.push({ AWAKE, i / 10.0f, t0 + std::chrono::milliseconds(i) });
+        assertm((pushed),"Push failed with free slots");
+    }
+    taken = channel.drain(batch);
+    assertm((taken == 5 && batch.front().timestamp == t0 && batch.back().openConfidence == 0.4f),"Batch lost samples or their order");
+    taken = channel.drain(batch);
+    assertm((taken == 0 && batch.empty()),"Drained samples were delivered twice");
+
+    //full: the newest sample is dropped, the producer doesn't wait
+    for (int i = 0; i < 8; i++) channel.push({ SLEEPING, 0.0f, t0 });
+    bool pushed = channel.push({ SLEEPING, 0.0f, t0 });
+    assertm((!pushed && channel.dropped() == 1),"Full channel did not drop");
+    taken = channel.drain(batch);
+    pushed = channel.push({ AWAKE, 1.0f, t0 });
+    assertm((taken == 8 && pushed),"Slots were not freed by the drain");
+    channel.clear();
+
+    //4 producers against one consumer: every sample once, in order per producer
+    const int producers = 4;
+    const int perProducer = 20000;
+    StatusChannel shared(64);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p] {
+            for (int i = 0; i < perProducer; i++) {
+                //status carries the producer, the timestamp the sequence number; a full channel is retried here only
+                while (!shared.push({ p, 1.0f, t0 + std::chrono::microseconds(i) })) std::this_thread::yield();
+            }
+        });
+    }
+    std::vector<int> next(producers, 0);
+    int received = 0;
+    bool ordered = true;
+    while (received < producers * perProducer) {
+        shared.waitAndDrain(batch, std::chrono::milliseconds(100));
+        for (const EyeSample& sample : batch) {
+            int sequence = static_cast<int>(std::chrono::duration_cast<std::chrono::microseconds>(sample.timestamp - t0).count());
+            ordered = ordered && sample.status >= 0 && sample.status < producers && sequence == next[sample.status];
+            if (sample.status >= 0 && sample.status < producers) next[sample.status] = sequence + 1;
+            received++;
+        }
+    }
+    for (std::thread& thread : threads) thread.join();
+    taken = shared.drain(batch);
+    assertm((ordered && received == producers * perProducer && taken == 0),"Samples lost, duplicated or reordered across producers");
+    return true;
+}
+
+bool test_frame_queue_callback_never_blocks(){
+    {
+        std::lock_guard<std::mutex> lock(frame_mutex);
+        frame_queue = std::queue<TimedFrame>();
+        processed = true;
+    }
+    SimulatedClock clock;
+    FrameQueueCallback callback;
+    callback.clock = &clock;
+    const size_t frames = FrameQueueCallback::MAX_QUEUE_SIZE + 2;
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < frames; i++) {
+        callback.nextScene(cv::Mat(4, 4, CV_8UC1, cv::Scalar(i)));
+        clock.advance(std::chrono::milliseconds(33));
+    }
+    bool quick = std::chrono::steady_clock::now() - begin < std::chrono::milliseconds(100);
+    std::lock_guard<std::mutex> lock(frame_mutex);
+    assertm((quick && callback.dropped() == 2 && frame_queue.size() == FrameQueueCallback::MAX_QUEUE_SIZE),"Camera callback waited for the processing thread or kept too many frames");
+    assertm((frame_queue.front().frame.at<uchar>(0, 0) == 2 && frame_queue.front().captured == clock.now() - std::chrono::milliseconds(33 * 3)),"Camera callback dropped the wrong frames");
+    frame_queue = std::queue<TimedFrame>();
+    return true;
+}
@@ -1,6 +1,23 @@
 #pragma once
 #include <stdlib.h>
 #include "../../src/modules/actionStateMachine.h"
+#include "../../src/modules/sequentialSleepDetect.h"
+#include "../../src/modules/threadPlacement.h"
+#include "../../src/modules/deadline.h"
+#include "../../src/modules/telemetry.h"
+#include "../../src/modules/clock.h"
+#include "../../src/modules/frameArena.h"
+#include "../../src/modules/pipelinePolicies.h"
+#include "../../src/modules/metricsServer.h"
+#include "../../src/modules/parameterSweep.h"
+#include "../../src/modules/eyeNet.h"
+#include "../../src/modules/eyeCache.h"
+#include "../../src/modules/lowLight.h"
+#include "../../src/modules/startup.h"
+#include "../../src/modules/fatigueAnalytics.h"
+#include "../../src/modules/v4l2Capture.h"
+#include "../../src/modules/statusChannel.h"
+#include "../../src/modules/frameProcessor.h"
 
 #define assertm(exp, msg) assert(((void)msg, exp))
 
@@ -10,4 +27,84 @@ bool test_action_activated_by_state_sleeping();
 
 /// @brief Creates action object and checks that it deactivates by state change to AWAKE
 /// @return True if test completed
-bool test_action_deactivated_by_state_awake();
\ No newline at end of file
+bool test_action_deactivated_by_state_awake();
+
+/// @brief Replays a synthetic 30 fps microsleep clip and checks that the sequential test raises the alarm before the 1.5 s fixed threshold
+/// @return True if test completed
+bool test_sequential_detect_microsleep_faster_than_threshold();
+
+/// @brief Replays synthetic 30 fps blinks and checks that the sequential test does not raise an alarm
+/// @return True if test completed
+bool test_sequential_detect_ignores_blinks();
+
+/// @brief Checks that the action thread reacts to a state change (alarm start and cancel) within a bounded latency
+/// @return True if test completed
+bool test_action_latency_bounded();
+
+/// @brief Runs a thread inside a placement scope (falling back gracefully without privileges) and checks that its CPU time is reported
+/// @return True if test completed
+bool test_thread_placement_reports_cpu_time();
+
+/// @brief Checks that frames older than a stage budget are reported as expired and counted as misses
+/// @return True if test completed
+bool test_deadline_counts_misses();
+
+/// @brief Checks that the stall watchdog flags a degraded state without fresh decisions and restores it when fed
+/// @return True if test completed
+bool test_stall_watchdog_flags_degraded();
+
+/// @brief Writes telemetry records through the background writer and checks that the reader decodes them unchanged
+/// @return True if test completed
+bool test_telemetry_round_trip();
+
+/// @brief Runs a paced clip on the steady clock, replays its timestamps on a simulated clock and checks that the decisions are identical and the replay skips the waits
+/// @return True if test completed
+bool test_simulated_clock_replay_is_identical();
+
+/// @brief Allocates frame-sized scratch from a too small arena and checks that it grows once and then serves every frame from its buffer
+/// @return True if test completed
+bool test_frame_arena_settles_without_heap();
+
+/// @brief Composes a pipeline from fake detector stages and the majority vote and checks that the typed states reach the sink
+/// @return True if test completed
+bool test_pipeline_policies_typed_states();
+
+/// @brief Updates a counter, gauge and histogram and scrapes them in Prometheus text format over the metrics Unix socket
+/// @return True if test completed
+bool test_metrics_prometheus_scrape();
+
+/// @brief Scores a labelled replay, checks the Pareto front and the chosen configuration, and round-trips it through the config file
+/// @return True if test completed
+bool test_parameter_sweep_front_and_config();
+
+/// @brief Classifies synthetic open and closed eye crops (with glare, glasses and squints) and checks that the vector kernel, the scalar kernel and batching agree
+/// @return True if test completed
+bool test_eye_net_classifies_synthetic_eyes();
+
+/// @brief Replays a synthetic eye sequence (noise, head drift, blinks, a slow closure) through the eye net with and without the motion gate, checks the hit rate and that no blink onset is delayed by more than one frame
+/// @return True if test completed
+bool test_eye_cache_keeps_blink_onsets();
+
+/// @brief Checks that every low-light kernel the CPU supports matches the scalar one bit for bit, that the stage raises the contrast of a dark frame and that it only switches on (with hysteresis) for dark or flat frames
+/// @return True if test completed
+bool test_low_light_stage();
+
+/// @brief Runs startup phases through the orchestrator: launched phases overlap, failures and exceptions are reported, the first decision is only recorded once
+/// @return True if test completed
+bool test_startup_orchestrator();
+
+/// @brief Feeds a 20 minute synthetic shift at 30 fps (regular blinks, a long closure, a lost face, a pause) and checks blink rate, blink duration, long closures and PERCLOS of every window
+/// @return True if test completed
+bool test_fatigue_analytics_windows();
+
+/// @brief Captures GREY and YUYV frames from the file-backed V4L2 stand-in: grey frames are views of the driver buffers that go back to the device when their last copy is released, the capture starves instead of overwriting held frames, frames outlive the capture, YUYV frames carry the luma
+/// @return True if test completed
+bool test_v4l2_capture_stand_in();
+
+/// @brief Pushes samples into the status channel from several producer threads while one consumer drains batches: nothing is lost or duplicated, each producer's samples stay in order, a full channel drops instead of blocking, an idle wait times out
+/// @return True if test completed
+bool test_status_channel_batches();
+
+/// @brief Queues more frames than `frame_queue` holds with nothing taking them: the camera callback returns at once, keeps the newest frames and counts the dropped ones
+/// @return True if test completed
+bool test_frame_queue_callback_never_blocks();
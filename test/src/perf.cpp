@@ -0,0 +1,277 @@
+#include "perf.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <thread>
+#include "../../src/modules/frameProcessor.h"
+#include "../../src/modules/sequentialSleepDetect.h"
+
+using namespace std::chrono;
+
+static const int PERF_FPS = 30;
+
+const std::vector<PerfSequence>& perfSequences() {
+    static const std::vector<PerfSequence> sequences = [] {
+        PerfSequence blink;
+        blink.name = "blink";
+        blink.labels = {
+            { 0, 2000, LabelledInterval::OPEN_EYES },
+            { 2000, 2300, LabelledInterval::CLOSED_EYES },
+            { 2300, 4000, LabelledInterval::OPEN_EYES },
+            { 4000, 4300, LabelledInterval::CLOSED_EYES },
+            { 4300, 6000, LabelledInterval::OPEN_EYES },
+        };
+
+        PerfSequence microsleep;
+        microsleep.name = "microsleep";
+        microsleep.labels = {
+            { 0, 2000, LabelledInterval::OPEN_EYES },
+            { 2000, 5000, LabelledInterval::MICROSLEEP },
+            { 5000, 6000, LabelledInterval::OPEN_EYES },
+        };
+
+        PerfSequence faceLost;
+        faceLost.name = "face_lost";
+        faceLost.labels = {
+            { 0, 2000, LabelledInterval::OPEN_EYES },
+            { 2000, 4000, LabelledInterval::NO_FACE },
+            { 4000, 6000, LabelledInterval::OPEN_EYES },
+        };
+        return std::vector<PerfSequence>{ blink, microsleep, faceLost };
+    }();
+    return sequences;
+}
+
+//label of the frame shown at `ms`
+static LabelledInterval::Label labelAt(const PerfSequence& sequence, double ms) {
+    for (const LabelledInterval& interval : sequence.labels) {
+        if (ms >= interval.startMs && ms < interval.endMs) return interval.label;
+    }
+    return LabelledInterval::OPEN_EYES;
+}
+
+static int frameCount(const PerfSequence& sequence) {
+    return static_cast<int>(sequence.labels.back().endMs * PERF_FPS / 1000);
+}
+
+static double frameMs(int frame) {
+    return 1000.0 * frame / PERF_FPS;
+}
+
+PerfReplay replaySequence(const PerfSequence& sequence, const SyntheticScene& scene) {
+    FrameQueueCallback callback;
+    FrameProcessor processor;
+    processor.setDebugDisplay(false);
+    SequentialSleepDetect detector;
+
+    {
+        std::lock_guard<std::mutex> lock(frame_mutex);
+        frame_queue = std::queue<TimedFrame>();
+        processed = true;
+    }
+    status_channel.clear();
+
+    // Warm up like main, so the first frames of the sequence don't pay for the cold start
+    cv::Mat warmUp = scene.render(0, PERF_FPS, LabelledInterval::OPEN_EYES);
+    processor.start(warmUp);
+    processor.waitUntilWarm(seconds(10));
+
+    const int frames = frameCount(sequence);
+    auto period = duration_cast<steady_clock::duration>(duration<double>(1.0 / PERF_FPS));
+    auto start = steady_clock::now() + milliseconds(50);
+    std::atomic<bool> generating{true};
+
+    // 🚀 Camera stand-in: one frame per period
+    std::thread generator([&] {
+        for (int i = 0; i < frames; i++) {
+            cv::Mat frame = scene.render(i, PERF_FPS, labelAt(sequence, frameMs(i)));
+            std::this_thread::sleep_until(start + i * period);
+            callback.nextScene(frame);
+        }
+        generating = false;
+    });
+
+    // 🚀 Decision side, as in main; samples are kept relative to the start for scoring
+    PerfReplay replay;
+    double microsleepStartMs = -1;
+    for (const LabelledInterval& interval : sequence.labels) {
+        if (LabelledInterval::MICROSLEEP == interval.label) {
+            microsleepStartMs = interval.startMs;
+            break;
+        }
+    }
+    std::vector<EyeSample> samples;
+    std::vector<double> latencies;
+    int decision = AWAKE;
+    std::vector<EyeSample> batch;
+    auto drain = [&] {
+        status_channel.waitAndDrain(batch, milliseconds(100));
+        auto now = steady_clock::now();
+        for (EyeSample sample : batch) {
+            latencies.push_back(duration<double, std::milli>(now - sample.timestamp).count());
+            int previous = decision;
+            decision = detector.update(sample);
+            if (SLEEPING == decision && SLEEPING != previous && replay.alarmLatencyMs < 0 && microsleepStartMs >= 0) {
+                replay.alarmLatencyMs = duration<double, std::milli>(now - start).count() - microsleepStartMs;
+            }
+            sample.timestamp = steady_clock::time_point(sample.timestamp - start);
+            samples.push_back(sample);
+        }
+    };
+    while (generating) {
+        drain();
+    }
+    generator.join();
+    auto drainUntil = steady_clock::now() + milliseconds(500);
+    while (steady_clock::now() < drainUntil) {
+        drain();
+    }
+    processor.stop();
+
+    std::vector<SequentialSleepDetect::DetectionEvent> events = detector.events();
+    for (SequentialSleepDetect::DetectionEvent& event : events) {
+        event.onset = steady_clock::time_point(event.onset - start);
+        event.decision = steady_clock::time_point(event.decision - start);
+    }
+    replay.score = scoreReplay(samples, events, sequence.labels);
+    replay.frames = static_cast<int>(samples.size());
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        replay.p95LatencyMs = latencies[std::min(latencies.size() - 1, latencies.size() * 95 / 100)];
+    }
+    return replay;
+}
+
+bool checkReplay(const PerfSequence& sequence, const PerfReplay& replay, std::ostream& out) {
+    bool ok = true;
+    char line[256];
+    auto check = [&](bool passed, const char* text) {
+        out << (passed ? "✅ " : "❌ ") << sequence.name << ": " << text << std::endl;
+        ok = ok && passed;
+    };
+
+    std::snprintf(line, sizeof(line), "%d of %d frames reached the decision engine, p95 capture to decision %.1f ms",
+        replay.frames, frameCount(sequence), replay.p95LatencyMs);
+    check(replay.frames >= frameCount(sequence) * 9 / 10, line);
+
+    std::snprintf(line, sizeof(line), "eye state matches the labels on %.1f %% of the frames (at least %.1f %%)",
+        100.0 * replay.score.accuracy(), 100.0 * sequence.minAccuracy);
+    check(replay.score.accuracy() >= sequence.minAccuracy, line);
+
+    std::snprintf(line, sizeof(line), "%d false alarm(s)", replay.score.falseAlarms);
+    check(0 == replay.score.falseAlarms, line);
+
+    if (replay.score.microsleeps > 0) {
+        std::snprintf(line, sizeof(line), "%d of %d microsleep(s) raised the alarm", replay.score.detected, replay.score.microsleeps);
+        check(replay.score.detected == replay.score.microsleeps, line);
+        std::snprintf(line, sizeof(line), "alarm %.0f ms after the eyes closed (at most %.0f ms)", replay.alarmLatencyMs, sequence.maxAlarmLatencyMs);
+        check(replay.alarmLatencyMs >= 0 && replay.alarmLatencyMs <= sequence.maxAlarmLatencyMs, line);
+    }
+    return ok;
+}
+
+double calibrationMs() {
+    cv::Mat image(480, 640, CV_8UC1);
+    cv::RNG rng(4242);
+    rng.fill(image, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(255));
+    cv::Mat blurred, equalised, small, sum;
+
+    double best = std::numeric_limits<double>::max();
+    for (int run = 0; run < 7; run++) {
+        auto begin = steady_clock::now();
+        for (int i = 0; i < 10; i++) {
+            cv::GaussianBlur(image, blurred, cv::Size(5, 5), 0);
+            cv::equalizeHist(blurred, equalised);
+            cv::resize(equalised, small, cv::Size(320, 240), 0, 0, cv::INTER_LINEAR);
+            cv::integral(equalised, sum);
+        }
+        best = std::min(best, duration<double, std::milli>(steady_clock::now() - begin).count());
+    }
+    return best;
+}
+
+double frameCost(const PerfSequence& sequence, const SyntheticScene& scene, double calibration) {
+    FrameProcessor processor;
+    processor.setDebugDisplay(false);
+    const int frames = frameCount(sequence);
+    std::vector<cv::Mat> rendered;
+    for (int i = 0; i < frames; i++) {
+        rendered.push_back(scene.render(i, PERF_FPS, labelAt(sequence, frameMs(i))));
+    }
+
+    double best = std::numeric_limits<double>::max();
+    for (int pass = 0; pass < 3; pass++) {
+        processor.resetTracking();
+        double passMs = 0;
+        for (cv::Mat& frame : rendered) {
+            auto begin = steady_clock::now();
+            processor.processFrame(frame);
+            passMs += duration<double, std::milli>(steady_clock::now() - begin).count();
+        }
+        best = std::min(best, passMs);
+    }
+    return best / frames / calibration;
+}
+
+std::map<std::string, double> loadBaseline(const std::string& path) {
+    std::map<std::string, double> baseline;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        size_t equals = line.find('=');
+        if (equals == std::string::npos) continue;
+        std::string key, value;
+        std::istringstream(line.substr(0, equals)) >> key;
+        std::istringstream(line.substr(equals + 1)) >> value;
+        if (key.empty() || value.empty()) continue;
+        try {
+            baseline[key] = std::stod(value);
+        }
+        catch (const std::exception&) {
+            std::cerr << "⚠️ WARNING: Ignoring baseline line \"" << line << "\"" << std::endl;
+        }
+    }
+    return baseline;
+}
+
+bool saveBaseline(const std::string& path, const std::map<std::string, double>& baseline) {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "❌ ERROR: Could not write " << path << std::endl;
+        return false;
+    }
+    file << "# Performance baseline of wake-o-matic-perf (CTest label \"perf\")\n"
+         << "# <sequence>.frameCost: processing time of one frame divided by the calibration loop time.\n"
+         << "# tolerance: allowed increase over the baseline (0.25 = 25 %) before the gate fails.\n"
+         << "# Record on the reference machine with: wake-o-matic-perf throughput --update-baseline\n";
+    for (const auto& [key, value] : baseline) {
+        file << key << " = " << value << "\n";
+    }
+    return static_cast<bool>(file);
+}
+
+CostCheck checkFrameCost(const std::string& key, double cost, const std::map<std::string, double>& baseline, double tolerance, std::ostream& out) {
+    char line[256];
+    auto entry = baseline.find(key);
+    if (entry == baseline.end()) {
+        std::snprintf(line, sizeof(line), "❌ %s = %.4f, no baseline entry (record one on the reference machine with --update-baseline)", key.c_str(), cost);
+        out << line << std::endl;
+        return CostCheck::NO_BASELINE;
+    }
+    double change = cost / entry->second - 1.0;
+    bool passed = change <= tolerance;
+    std::snprintf(line, sizeof(line), "%s %s = %.4f, baseline %.4f (%+.1f %%, at most %+.1f %%)", passed ? "✅" : "❌", key.c_str(), cost,
+        entry->second, 100.0 * change, 100.0 * tolerance);
+    out << line;
+    if (change < -tolerance) {
+        out << ", faster than the baseline: consider recording a new one";
+    }
+    out << std::endl;
+    return passed ? CostCheck::WITHIN : CostCheck::REGRESSED;
+}
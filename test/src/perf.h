@@ -0,0 +1,73 @@
+#pragma once
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "soak.h"
+#include "../../src/modules/parameterSweep.h"
+
+/// @brief A short labelled sequence and what the pipeline must get right on it
+struct PerfSequence {
+    std::string name;
+    /// Ground truth, back to back from 0 ms
+    std::vector<LabelledInterval> labels;
+    /// Share of labelled frames whose eye state must match the label
+    double minAccuracy = 0.8;
+    /// Longest time from the first closed-eye frame of a microsleep to the alarm, capture to decision
+    /// (the sequential test alarms after about 450 ms; the rest is headroom for the frame pipeline)
+    double maxAlarmLatencyMs = 700;
+};
+
+/// @brief The sequences the performance gates replay: blinks, a microsleep and a lost face
+const std::vector<PerfSequence>& perfSequences();
+
+/// @brief Outcome of replaying a sequence in real time through the pipeline
+struct PerfReplay {
+    ReplayScore score;
+    /// Capture of the first microsleep frame to the alarm leaving the decision engine, -1 without an alarm
+    double alarmLatencyMs = -1;
+    /// Capture to decision latency of the frames
+    double p95LatencyMs = 0;
+    int frames = 0;
+};
+
+/**
+ * @brief Replays a sequence at 30 fps through FrameQueueCallback, the FrameProcessor thread and
+ * SequentialSleepDetect, like the live pipeline (and @see runSoak()).
+ */
+PerfReplay replaySequence(const PerfSequence& sequence, const SyntheticScene& scene);
+
+/**
+ * @brief Checks correctness, false alarms and alarm latency of a replay against the sequence.
+ * @param out Receives one line per check.
+ * @return True if all checks passed.
+ */
+bool checkReplay(const PerfSequence& sequence, const PerfReplay& replay, std::ostream& out);
+
+/**
+ * @brief Time of a fixed image-processing workload (blur, histogram equalisation, resize, integral image of a
+ * 640x480 frame), the fastest of several runs. Frame costs are divided by it so they compare across machines.
+ */
+double calibrationMs();
+
+/**
+ * @brief Processing cost of one frame of the sequence, run flat out on this thread, in units of @see calibrationMs().
+ * Fastest of three passes over the rendered sequence.
+ */
+double frameCost(const PerfSequence& sequence, const SyntheticScene& scene, double calibration);
+
+/// @brief Baseline of the normalised frame costs: `key = value` lines, `#` comments; empty if the file can't be read
+std::map<std::string, double> loadBaseline(const std::string& path);
+
+/// @brief Writes the baseline, comments first.
+bool saveBaseline(const std::string& path, const std::map<std::string, double>& baseline);
+
+/// @brief Outcome of a frame cost check.
+enum class CostCheck { WITHIN, REGRESSED, NO_BASELINE };
+
+/**
+ * @brief Compares a frame cost with its baseline entry.
+ * @return REGRESSED if it is more than `tolerance` above the baseline, NO_BASELINE without an entry (after saying how to
+ * record one); only WITHIN passes the gate.
+ */
+CostCheck checkFrameCost(const std::string& key, double cost, const std::map<std::string, double>& baseline, double tolerance, std::ostream& out);
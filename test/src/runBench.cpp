@@ -0,0 +1,31 @@
+#include <iostream>
+#include "bench.h"
+#include "../../src/modules/frameProcessor.h"
+
+//queue, mutex and cv of the camera callback, channel from the frame processor to the decision side
+std::queue<TimedFrame> frame_queue;
+std::mutex frame_mutex;
+std::condition_variable frame_cv;
+bool processed = true;
+StatusChannel status_channel;
+
+/**
+ * @brief Benchmark runner
+ * Times the pipeline stages on the images in test/images. Not part of CTest since the
+ * numbers depend on the machine; run `wake-o-matic-bench` by hand and compare.
+ */
+int main() {
+    std::cout << "Benchmarks started!" << std::endl;
+
+    benchProcessFrame();
+    benchFrameAllocations();
+    benchPipelineDispatch();
+    benchEyeClassifiers();
+    benchLowLight();
+    benchBlackBoxRecorder();
+    benchFatigueAnalytics();
+    benchCapture();
+    benchStatusChannel();
+
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <iostream>
+#include <string>
+#include "perf.h"
+#include "../../src/modules/frameProcessor.h"
+#include "../../src/modules/threadPlacement.h"
+
+//queue, mutex and cv of the camera callback, channel from the frame processor to the decision side
+std::queue<TimedFrame> frame_queue;
+std::mutex frame_mutex;
+std::condition_variable frame_cv;
+bool processed = true;
+StatusChannel status_channel;
+
+#ifndef PERF_BASELINE_PATH
+#define PERF_BASELINE_PATH "test/perf/baseline.conf"
+#endif
+
+/**
+ * @brief Performance regression gates, registered with CTest under the label "perf".
+ *
+ * The sequences are replayed in real time through the whole pipeline: the eye state must match the labels,
+ * blinks and a lost face must not raise the alarm and a microsleep must raise it within its latency bound.
+ * `throughput` runs every sequence flat out and compares the cost of a frame, divided by a calibration loop so it
+ * carries across machines, with test/perf/baseline.conf; it fails if a cost grew by more than the tolerance or if a
+ * sequence has no baseline entry.
+ *
+ * ### USAGE:
+ *      ctest -L perf                                       # all gates
+ *      wake-o-matic-perf microsleep                        # one sequence
+ *      wake-o-matic-perf throughput --update-baseline      # record the frame costs of this build
+ */
+int main(int argc, char** argv) {
+    std::string gate = "all";
+    std::string baselinePath = PERF_BASELINE_PATH;
+    bool updateBaseline = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--baseline" && i + 1 < argc) {
+            baselinePath = argv[++i];
+        }
+        else if (arg == "--update-baseline") {
+            updateBaseline = true;
+        }
+        else if (arg.rfind("--", 0) != 0) {
+            gate = arg;
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [blink|microsleep|face_lost|throughput|all] [--baseline PATH] [--update-baseline]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Same library thread limits as wake-o-matic-main
+    ThreadPlacement::limitLibraryThreads(2);
+
+    SyntheticScene scene(640, 480);
+    bool ok = true;
+    bool known = false;
+
+    for (const PerfSequence& sequence : perfSequences()) {
+        if (gate != "all" && gate != sequence.name) continue;
+        known = true;
+        std::cout << "✅ Replaying " << sequence.name << std::endl;
+        PerfReplay replay = replaySequence(sequence, scene);
+        ok = checkReplay(sequence, replay, std::cout) && ok;
+    }
+
+    if (gate == "all" || gate == "throughput") {
+        known = true;
+        std::map<std::string, double> baseline = loadBaseline(baselinePath);
+        double tolerance = baseline.count("tolerance") ? baseline["tolerance"] : 0.25;
+        double calibration = calibrationMs();
+        std::cout << "✅ Calibration loop: " << calibration << " ms" << std::endl;
+
+        for (const PerfSequence& sequence : perfSequences()) {
+            std::string key = sequence.name + ".frameCost";
+            double cost = frameCost(sequence, scene, calibration);
+            if (updateBaseline) {
+                std::cout << "✅ " << key << " = " << cost << std::endl;
+                baseline[key] = cost;
+            }
+            else {
+                CostCheck result = checkFrameCost(key, cost, baseline, tolerance, std::cout);
+                ok = CostCheck::WITHIN == result && ok;
+            }
+        }
+
+        if (updateBaseline) {
+            baseline["tolerance"] = tolerance;
+            if (!saveBaseline(baselinePath, baseline)) return 1;
+            std::cout << "✅ Baseline written to " << baselinePath << std::endl;
+        }
+    }
+
+    if (!known) {
+        std::cerr << "❌ ERROR: Unknown gate \"" << gate << "\"" << std::endl;
+        return 1;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "soak.h"
+#include "../../src/modules/frameProcessor.h"
+#include "../../src/modules/threadPlacement.h"
+
+//queue, mutex and cv of the camera callback, channel from the frame processor to the decision side
+std::queue<TimedFrame> frame_queue;
+std::mutex frame_mutex;
+std::condition_variable frame_cv;
+bool processed = true;
+StatusChannel status_channel;
+
+/**
+ * @brief Soak / stress test of the live pipeline with synthetic frames.
+ *
+ * Not registered with CTest: a run takes minutes to hours and the limits depend on the machine.
+ *
+ * ### USAGE:
+ *      wake-o-matic-soak                                  # 30 fps 640x480 for 60 s
+ *      wake-o-matic-soak --fps 120 --size 1280x720 --seconds 28800 --report 60   # 8 hour shift
+ *      wake-o-matic-soak --sweep                          # 20 s at each rate and resolution
+ */
+int main(int argc, char** argv) {
+    SoakConfig config;
+    bool sweep = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--fps" && hasValue) {
+            config.fps = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--size" && hasValue) {
+            if (2 != std::sscanf(argv[++i], "%dx%d", &config.width, &config.height)) {
+                std::cerr << "❌ ERROR: --size expects WIDTHxHEIGHT" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--seconds" && hasValue) {
+            config.seconds = std::atof(argv[++i]);
+        }
+        else if (arg == "--report" && hasValue) {
+            config.reportSeconds = std::atof(argv[++i]);
+        }
+        else if (arg == "--sweep") {
+            sweep = true;
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--fps N] [--size WxH] [--seconds S] [--report S] [--sweep]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Same library thread limits as wake-o-matic-main
+    ThreadPlacement::limitLibraryThreads(2);
+
+    if (!sweep) {
+        std::cout << "✅ Soak test: " << config.fps << " fps " << config.width << "x" << config.height
+            << " for " << config.seconds << " s" << std::endl;
+        SoakReport total = runSoak(config, std::cout);
+        std::cout << "Total:" << std::endl;
+        printSoakReport(total, std::cout);
+        return 0;
+    }
+
+    // Where does frame dropping start, and how does latency grow with resolution?
+    const int rates[] = { 15, 30, 60, 90, 120 };
+    const cv::Size sizes[] = { cv::Size(640, 480), cv::Size(1280, 720) };
+    config.seconds = 20;
+    config.reportSeconds = 20;
+
+    std::vector<std::string> names;
+    std::vector<SoakReport> reports;
+    for (const auto& size : sizes) {
+        for (int fps : rates) {
+            config.fps = fps;
+            config.width = size.width;
+            config.height = size.height;
+            std::string name = std::to_string(fps) + " fps " + std::to_string(size.width) + "x" + std::to_string(size.height);
+            std::cout << "✅ " << name << std::endl;
+            reports.push_back(runSoak(config, std::cout));
+            names.push_back(name);
+        }
+    }
+
+    std::cout << "Summary:" << std::endl;
+    for (size_t i = 0; i < reports.size(); i++) {
+        std::cout << names[i] << ": ";
+        printSoakReport(reports[i], std::cout);
+    }
+    return 0;
+}
@@ -1,82 +1,104 @@
-#include<iostream>
-#include<opencv2/highgui/highgui.hpp>
-#include<opencv2/imgproc/imgproc.hpp>
-#include<opencv2/objdetect/objdetect.hpp>
-#include "../../src/modules/eyeStatus.h"
-#include "../../src/modules/camera.h" //https://github.com/berndporr/opencv-camera-callback
-#include <opencv2/opencv.hpp>
-#include "../../src/modules/frameProcessor.h"
-#include "../../src/modules/sleepDetect.h"
-#include "../../src/modules/actionStateMachine.h"
-#include "tests.h"
-#include "cppTests.h"
-
-//uncomment for testing on actual device, commented out for github CI since the github server does not have access to camera, so the test would always fail
-//#define CAMERA_TEST_ON
-#define ACTION_LOGGIN_TEST_ON
-
-using namespace std;
-using namespace cv;
-
-//queue, mutex and cv for raw frames
-std::queue<Mat> frame_queue;
-std::mutex frame_mutex;
-std::condition_variable frame_cv;
-bool processed = 1;
-
-//queue, mutex and cv for status of the eyes 
-std::queue<int> status_queue;
-std::mutex status_mutex;
-std::condition_variable status_cv;
-bool loading = 0;			//flag that represents that the value
-
-//mutex and cv for action stateMachine
-std::mutex action_mutex;
-std::condition_variable action_cv;
-
-//variable holding the current sleep status (-1 no face, 0 asleep, 1 awake)
-int sleepStatus = NOFACE;
-
-//defines a SceneCallback structure with the required callback for the camera class
-struct MyCallback : Camera::SceneCallback {
-
-	// Locks the mutex and pushes the frame into the queue, then unlocks it and notify the other thread
-	void nextScene(const cv::Mat& frame) {
-
-		std::unique_lock<std::mutex> lock(frame_mutex);
-		frame_cv.wait(lock, [] { return processed; });  // Wait until new data is available
-		frame_queue.push(frame);
-
-		//std::cout << "Pushed frame. " << std::endl;
-
-		processed = 0; // resets the processed flag
-		lock.unlock();
-		frame_cv.notify_one();  // Notify the consumer thread that new data is available
-	}
-};
-
-
-/**
- * @brief Test runner
- * Optional run_test program to execute each test method. 
- * Alternatively, CTest can be configured to compile individual tests 
- * and run the test methods directly.
- */
-int main() {
-    std::cout << "Tests started!" << std::endl;
-
-	#ifdef CAMERA_TEST_ON
-	cameraTest();
-	#endif
-	
-	eyeStatusTest();
-
-	frameProcessorTest();
-	#ifdef ACTION_LOGGING_TEST_ON
-    test_action_activated_by_state_sleeping();
-	test_action_deactivated_by_state_awake();
-	#endif
-
-    std::cout << "Tests (4) succeeded!" << std::endl;
-    return 0; // You can put a 1 here to see later that it would generate an error
-}
+#include<iostream>
+#include<opencv2/highgui/highgui.hpp>
+#include<opencv2/imgproc/imgproc.hpp>
+#include<opencv2/objdetect/objdetect.hpp>
+#include "../../src/modules/eyeStatus.h"
+#include "../../src/modules/camera.h" //https://github.com/berndporr/opencv-camera-callback
+#include <opencv2/opencv.hpp>
+#include "../../src/modules/frameProcessor.h"
+#include "../../src/modules/sleepDetect.h"
+#include "../../src/modules/actionStateMachine.h"
+#include "tests.h"
+#include "cppTests.h"
+
+//uncomment for testing on actual device, commented out for github CI since the github server does not have access to camera, so the test would always fail
+//#define CAMERA_TEST_ON
+//uncomment for testing on actual device, the action tests unmute the mixer and play the alarm through aplay
+//#define ACTION_LOGGING_TEST_ON
+
+using namespace std;
+using namespace cv;
+
+//queue, mutex and cv for raw frames
+std::queue<TimedFrame> frame_queue;
+std::mutex frame_mutex;
+std::condition_variable frame_cv;
+bool processed = 1;
+
+//channel for status of the eyes
+StatusChannel status_channel;
+
+//mutex and cv for action stateMachine
+std::mutex action_mutex;
+std::condition_variable action_cv;
+
+//variable holding the current sleep status (-1 no face, 0 asleep, 1 awake)
+int sleepStatus = NOFACE;
+
+//defines a SceneCallback structure with the required callback for the camera class
+struct MyCallback : Camera::SceneCallback {
+
+	// Locks the mutex and pushes the frame into the queue, then unlocks it and notify the other thread
+	void nextScene(const cv::Mat& frame) {
+
+		std::unique_lock<std::mutex> lock(frame_mutex);
+		frame_cv.wait(lock, [] { return processed; });  // Wait until new data is available
+		frame_queue.push({ frame, std::chrono::steady_clock::now() });
+
+		//std::cout << "Pushed frame. " << std::endl;
+
+		processed = 0; // resets the processed flag
+		lock.unlock();
+		frame_cv.notify_one();  // Notify the consumer thread that new data is available
+	}
+};
+
+
+/**
+ * @brief Test runner
+ * Optional run_test program to execute each test method. 
+ * Alternatively, CTest can be configured to compile individual tests 
+ * and run the test methods directly.
+ */
+int main() {
+    std::cout << "Tests started!" << std::endl;
+
+	#ifdef CAMERA_TEST_ON
+	cameraTest();
+	#endif
+	
+	eyeStatusTest();
+
+	frameProcessorTest();
+	blackBoxRecorderTest();
+	frameExportTest();
+	frameExportDropTest();
+
+	test_sequential_detect_microsleep_faster_than_threshold();
+	test_sequential_detect_ignores_blinks();
+	test_thread_placement_reports_cpu_time();
+	test_deadline_counts_misses();
+	test_stall_watchdog_flags_degraded();
+	test_telemetry_round_trip();
+	test_simulated_clock_replay_is_identical();
+	test_frame_arena_settles_without_heap();
+	test_pipeline_policies_typed_states();
+	test_metrics_prometheus_scrape();
+	test_parameter_sweep_front_and_config();
+	test_eye_net_classifies_synthetic_eyes();
+	test_eye_cache_keeps_blink_onsets();
+	test_low_light_stage();
+	test_startup_orchestrator();
+	test_fatigue_analytics_windows();
+	test_v4l2_capture_stand_in();
+	test_status_channel_batches();
+	test_frame_queue_callback_never_blocks();
+	#ifdef ACTION_LOGGING_TEST_ON
+    test_action_activated_by_state_sleeping();
+	test_action_deactivated_by_state_awake();
+	test_action_latency_bounded();
+	#endif
+
+    std::cout << "Tests (4) succeeded!" << std::endl;
+    return 0; // You can put a 1 here to see later that it would generate an error
+}
@@ -0,0 +1,236 @@
+#include "soak.h"
+#include "bench.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include "../../src/modules/frameProcessor.h"
+#include "../../src/modules/metrics.h"
+#include "../../src/modules/sequentialSleepDetect.h"
+
+#ifdef __linux__
+    #include <unistd.h>
+#endif
+
+using namespace std::chrono;
+
+SyntheticScene::SyntheticScene(int width, int height) {
+    // Fixed seed, every run sees the same background
+    background.create(height, width, CV_8UC3);
+    cv::RNG rng(12345);
+    rng.fill(background, cv::RNG::UNIFORM, cv::Scalar::all(40), cv::Scalar::all(90));
+    cv::GaussianBlur(background, background, cv::Size(9, 9), 0);
+
+    // Face fills 60% of the frame height, like a driver sitting in front of the dashboard camera
+    cv::Mat open = loadBenchImage("face_openeyes.jpg");
+    cv::Mat closed = loadBenchImage("face_closedeyes.jpg");
+    int faceHeight = std::min(height * 6 / 10, width * 6 / 10);
+    cv::Size faceSize(faceHeight * open.cols / open.rows, faceHeight);
+    cv::resize(open, faceOpen, faceSize, 0, 0, cv::INTER_AREA);
+    cv::resize(closed, faceClosed, faceSize, 0, 0, cv::INTER_AREA);
+}
+
+bool SyntheticScene::eyesOpen(uint64_t frameIndex, int fps) {
+    double t = static_cast<double>(frameIndex) / fps;
+    if (std::fmod(t, 30.0) >= 28.0) return false;  // Microsleep: 2 s closure every 30 s
+    return std::fmod(t, 3.0) >= 0.3;               // Blink: 300 ms every 3 s
+}
+
+cv::Mat SyntheticScene::render(uint64_t frameIndex, int fps) const {
+    return render(frameIndex, fps, eyesOpen(frameIndex, fps) ? LabelledInterval::OPEN_EYES : LabelledInterval::CLOSED_EYES);
+}
+
+cv::Mat SyntheticScene::render(uint64_t frameIndex, int fps, LabelledInterval::Label label) const {
+    if (LabelledInterval::NO_FACE == label) {
+        return background.clone();
+    }
+    double t = static_cast<double>(frameIndex) / fps;
+    const cv::Mat& face = LabelledInterval::OPEN_EYES == label ? faceOpen : faceClosed;
+
+    // Slow drift around the centre, as a driver's head moves
+    int freeX = background.cols - face.cols;
+    int freeY = background.rows - face.rows;
+    int x = freeX / 2 + static_cast<int>(freeX / 4 * std::sin(2 * CV_PI * t / 4.0));
+    int y = freeY / 2 + static_cast<int>(freeY / 4 * std::sin(2 * CV_PI * t / 6.0));
+
+    cv::Mat frame = background.clone();
+    face.copyTo(frame(cv::Rect(x, y, face.cols, face.rows)));
+    return frame;
+}
+
+long currentRssKb() {
+    #ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    long pages = 0, residentPages = 0;
+    if (statm >> pages >> residentPages) {
+        return residentPages * (sysconf(_SC_PAGESIZE) / 1024);
+    }
+    #endif
+    return -1;
+}
+
+//rates of one interval (or of the whole run)
+static SoakReport summarise(uint64_t processed, double seconds, uint64_t generated, uint64_t captureMissed,
+    uint64_t queueDropped, uint64_t deadlineDropped) {
+    SoakReport report;
+    report.elapsedSeconds = seconds;
+    report.generated = generated;
+    report.captureMissed = captureMissed;
+    report.queueDropped = queueDropped;
+    report.deadlineDropped = deadlineDropped;
+    report.processed = processed;
+    report.throughputFps = seconds > 0 ? processed / seconds : 0;
+    uint64_t slots = generated + captureMissed;
+    report.dropRate = slots > 0 ? 1.0 - static_cast<double>(std::min<uint64_t>(processed, slots)) / slots : 0;
+    report.rssKb = currentRssKb();
+    return report;
+}
+
+//exact latency percentiles of one report interval
+static void percentiles(std::vector<double>& latencies, SoakReport& report) {
+    if (latencies.empty()) return;
+    std::sort(latencies.begin(), latencies.end());
+    size_t n = latencies.size();
+    report.p50Ms = latencies[n / 2];
+    report.p95Ms = latencies[std::min(n - 1, n * 95 / 100)];
+    report.p99Ms = latencies[std::min(n - 1, n * 99 / 100)];
+    report.maxMs = latencies.back();
+}
+
+//latency percentiles of the whole run from a fixed-bucket histogram: the upper bound of the bucket holding the percentile
+static void percentiles(const Histogram& latencies, uint64_t n, double maxMs, SoakReport& report) {
+    if (0 == n) return;
+    auto at = [&](uint64_t rank) {
+        uint64_t seen = 0;
+        for (size_t i = 0; i < latencies.bounds().size(); i++) {
+            seen += latencies.bucket(i);
+            if (seen > rank) return std::min(latencies.bounds()[i], maxMs);
+        }
+        return maxMs;
+    };
+    report.p50Ms = at(n / 2);
+    report.p95Ms = at(std::min(n - 1, n * 95 / 100));
+    report.p99Ms = at(std::min(n - 1, n * 99 / 100));
+    report.maxMs = maxMs;
+}
+
+void printSoakReport(const SoakReport& r, std::ostream& out) {
+    char line[320];
+    std::snprintf(line, sizeof(line), "%7.1f s  %6.1f fps  drop %5.1f%% (capture %llu, queue %llu, deadline %llu)  latency p50 %6.1f p95 %6.1f p99 %6.1f max %6.1f ms  eye cache hits %5.1f%%  RSS %ld kB",
+        r.elapsedSeconds, r.throughputFps, 100.0 * r.dropRate,
+        static_cast<unsigned long long>(r.captureMissed), static_cast<unsigned long long>(r.queueDropped),
+        static_cast<unsigned long long>(r.deadlineDropped), r.p50Ms, r.p95Ms, r.p99Ms, r.maxMs, 100.0 * r.eyeCacheHitRate, r.rssKb);
+    out << line << std::endl;
+}
+
+SoakReport runSoak(const SoakConfig& config, std::ostream& progress) {
+    SyntheticScene scene(config.width, config.height);
+    FrameQueueCallback callback;
+    FrameProcessor processor;
+    processor.setDebugDisplay(false);
+    SequentialSleepDetect detector;
+
+    {
+        std::lock_guard<std::mutex> lock(frame_mutex);
+        frame_queue = std::queue<TimedFrame>();
+        processed = true;
+    }
+    status_channel.clear();
+
+    std::atomic<bool> generating{true};
+    std::atomic<uint64_t> generated{0};
+    std::atomic<uint64_t> captureMissed{0};
+    auto period = duration_cast<steady_clock::duration>(duration<double>(1.0 / config.fps));
+    auto start = steady_clock::now();
+    auto end = start + duration_cast<steady_clock::duration>(duration<double>(config.seconds));
+
+    processor.start();
+
+    // 🚀 Camera stand-in: one frame per period, slots that are already over when the pipeline lets go are skipped
+    std::thread generator([&] {
+        uint64_t slot = 0;
+        for (auto next = start; next < end; next += period, slot++) {
+            auto now = steady_clock::now();
+            if (now > next + period) {
+                captureMissed++;
+                continue;
+            }
+            std::this_thread::sleep_until(next);
+            callback.nextScene(scene.render(slot, config.fps));
+            generated++;
+        }
+        generating = false;
+    });
+
+    // 🚀 Decision side, as in main: drain status_channel into the decision engine and time every sample.
+    // Only the current interval keeps its samples; the whole run goes into fixed buckets, so the harness's own
+    // memory stays flat however long the soak runs
+    Histogram all(Metrics::latencyBucketsMs());
+    uint64_t allCount = 0;
+    double allMaxMs = 0;
+    std::vector<double> interval;
+    auto reportEvery = duration_cast<steady_clock::duration>(duration<double>(config.reportSeconds));
+    auto nextReport = start + reportEvery;
+    auto intervalStart = start;
+    uint64_t lastGenerated = 0, lastMissed = 0, lastQueueDropped = 0, lastDeadlineDropped = 0;
+    uint64_t lastHits = 0, lastMisses = 0;
+    auto hitRate = [](uint64_t hits, uint64_t misses) { return hits + misses > 0 ? static_cast<double>(hits) / (hits + misses) : 0.0; };
+
+    std::vector<EyeSample> batch;
+    auto drain = [&] {
+        status_channel.waitAndDrain(batch, milliseconds(100));
+        auto now = steady_clock::now();
+        for (const EyeSample& sample : batch) {
+            double latencyMs = duration<double, std::milli>(now - sample.timestamp).count();
+            interval.push_back(latencyMs);
+            all.observe(latencyMs);
+            allCount++;
+            allMaxMs = std::max(allMaxMs, latencyMs);
+            detector.update(sample);
+        }
+    };
+
+    while (generating) {
+        drain();
+        auto now = steady_clock::now();
+        if (now >= nextReport) {
+            SoakReport report = summarise(interval.size(), duration<double>(now - intervalStart).count(),
+                generated - lastGenerated, captureMissed - lastMissed,
+                callback.dropped() - lastQueueDropped, processor.droppedFrames() - lastDeadlineDropped);
+            percentiles(interval, report);
+            report.elapsedSeconds = duration<double>(now - start).count();
+            const EyeCache& cache = processor.eyeResultCache();
+            uint64_t hits = cache.hits(), misses = cache.misses();
+            report.eyeCacheHitRate = hitRate(hits - lastHits, misses - lastMisses);
+            printSoakReport(report, progress);
+
+            interval.clear();
+            intervalStart = now;
+            nextReport += reportEvery;
+            lastGenerated = generated;
+            lastMissed = captureMissed;
+            lastQueueDropped = callback.dropped();
+            lastDeadlineDropped = processor.droppedFrames();
+            lastHits = hits;
+            lastMisses = misses;
+        }
+    }
+    generator.join();
+
+    // Let the last frames through before stopping
+    auto drainUntil = steady_clock::now() + milliseconds(500);
+    while (steady_clock::now() < drainUntil) {
+        drain();
+    }
+    processor.stop();
+
+    double seconds = duration<double>(steady_clock::now() - start).count();
+    SoakReport total = summarise(allCount, seconds, generated, captureMissed, callback.dropped(), processor.droppedFrames());
+    percentiles(all, allCount, allMaxMs, total);
+    total.eyeCacheHitRate = processor.eyeResultCache().hitRate();
+    return total;
+}
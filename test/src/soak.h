@@ -0,0 +1,84 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <iostream>
+#include "../../src/modules/parameterSweep.h"
+
+/// @brief Input of one soak run
+struct SoakConfig {
+    /// Rate at which synthetic frames are generated
+    int fps = 30;
+    int width = 640;
+    int height = 480;
+    /// Length of the run
+    double seconds = 60;
+    /// Interval between progress lines (throughput, drops, latency, RSS)
+    double reportSeconds = 10;
+};
+
+/// @brief Outcome of one soak run (or of one report interval)
+struct SoakReport {
+    double elapsedSeconds = 0;
+    /// Frames the generator produced on schedule
+    uint64_t generated = 0;
+    /// Frame slots skipped because the generator fell behind its schedule
+    uint64_t captureMissed = 0;
+    /// Frames dropped by the camera callback because `frame_queue` was full
+    uint64_t queueDropped = 0;
+    /// Frames dropped by the processing thread because they missed a deadline
+    uint64_t deadlineDropped = 0;
+    /// Frames that reached the decision engine
+    uint64_t processed = 0;
+    /// Processed frames per second
+    double throughputFps = 0;
+    /// Share of frame slots that never reached the decision engine
+    double dropRate = 0;
+    /// Capture to decision latency (for the whole run: upper bound of the latency bucket, @see Metrics::latencyBucketsMs)
+    double p50Ms = 0;
+    double p95Ms = 0;
+    double p99Ms = 0;
+    double maxMs = 0;
+    /// Share of eye crops whose result the motion gate reused (@see EyeCache)
+    double eyeCacheHitRate = 0;
+    /// Resident set size at the end of the run (-1 where it can't be read)
+    long rssKb = -1;
+};
+
+/**
+ * @brief Generates camera-like frames: a face from test/images pasted onto a noisy background, drifting
+ * around the frame and blinking every 3 s, with a 2 s eye closure every 30 s.
+ */
+class SyntheticScene
+{
+public:
+    SyntheticScene(int width, int height);
+
+    /// @brief Renders a new frame (never shared with earlier frames, like a camera frame).
+    cv::Mat render(uint64_t frameIndex, int fps) const;
+
+    /// @brief Renders a frame showing the given label instead of the built-in blink pattern (no face: background only).
+    cv::Mat render(uint64_t frameIndex, int fps, LabelledInterval::Label label) const;
+
+    /// @brief True if the eyes are open in the given frame.
+    static bool eyesOpen(uint64_t frameIndex, int fps);
+
+private:
+    cv::Mat background;
+    cv::Mat faceOpen;
+    cv::Mat faceClosed;
+};
+
+/**
+ * @brief Feeds synthetic frames at a fixed rate through FrameQueueCallback::nextScene, the FrameProcessor thread
+ * and SequentialSleepDetect, exactly like the live pipeline, and measures how it copes.
+ * @param config Rate, resolution and length of the run.
+ * @param progress Receives one line per report interval.
+ * @return Totals of the whole run.
+ */
+SoakReport runSoak(const SoakConfig& config, std::ostream& progress);
+
+/// @brief Prints a report as one line
+void printSoakReport(const SoakReport& report, std::ostream& out);
+
+/// @brief Resident set size of this process in kB, -1 where it can't be read
+long currentRssKb();
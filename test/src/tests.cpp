@@ -1,73 +1,265 @@
-#include "tests.h"
-
-void cameraTest() {
-    cv::Mat img;
-    cv::VideoCapture cap;
-    cap.open(0);
-
-    if (!cap.isOpened()) {
-        std::cerr << "ERROR: Camera opening failed!" << std::endl;
-    }
-
-    assertm(cap.isOpened(), "Camera opening failed");
-    cap.read(img);
-
-    if (img.empty()) {
-        std::cerr << "ERROR: Captured image is empty!" << std::endl;
-    }
-
-    assertm(!img.empty(), "Image is empty");
-    return;
-}
-
-void eyeStatusTest() {
-    cv::Mat closed = cv::imread("../../../test/images/eyeClosed.jpg");
-    cv::Mat open = cv::imread("../../../test/images/eyeOpen.jpg");
-
-    if (closed.empty()) {
-        std::cerr << "ERROR: Unable to load eyeClosed.jpg. Check path!" << std::endl;
-    }
-    if (open.empty()) {
-        std::cerr << "ERROR: Unable to load eyeOpen.jpg. Check path!" << std::endl;
-    }
-
-    assertm(!closed.empty(), "Image of a closed eye is empty");
-    assertm(!open.empty(), "Image of an open eye is empty");
-
-    EyeStatus blinkDetector;
-
-    bool statusClosed = blinkDetector.detect(closed);
-    bool statusOpen = blinkDetector.detect(open);
-
-    assertm(!statusClosed, "Closed eye image falsely detected as open eye");
-    assertm(statusOpen, "Open eye image falsely detected as closed eye");
-    return;
-}
-
-void frameProcessorTest() {
-    cv::Mat noface = cv::imread("../../../test/images/noface.jpg");
-    cv::Mat face_closedeyes = cv::imread("../../../test/images/face_closedeyes.jpg");
-    cv::Mat face_openeyes = cv::imread("../../../test/images/face_openeyes.jpg");
-
-    if (noface.empty()) {
-        std::cerr << "ERROR: Unable to load noface.jpg. Check path!" << std::endl;
-    }
-    if (face_closedeyes.empty()) {
-        std::cerr << "ERROR: Unable to load face_closedeyes.jpg. Check path!" << std::endl;
-    }
-    if (face_openeyes.empty()) {
-        std::cerr << "ERROR: Unable to load face_openeyes.jpg. Check path!" << std::endl;
-    }
-
-    FrameProcessor processor;  // Fixed variable name
-
-    int statusNoFace = processor.processFrame(noface);
-    int statusClosedEyes = processor.processFrame(face_closedeyes);
-    int statusOpenEyes = processor.processFrame(face_openeyes);
-
-    assertm(FACE_NOT_FOUND == statusNoFace, "Incorrect detection for picture noface.jpg");
-    assertm(EYES_CLOSED == statusClosedEyes, "Incorrect detection for picture face_closedeyes.jpg");
-    assertm(EYES_OPEN == statusOpenEyes, "Incorrect detection for picture face_openeyes.jpg");
-
-    return;
-}
+#include "tests.h"
+#include "../../src/modules/blackBoxRecorder.h"
+#include "../../src/modules/frameExport.h"
+#include "../../src/modules/frameExportReader.h"
+#include <cstdio>
+#include <algorithm>
+
+#ifndef _WIN32
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+void cameraTest() {
+    cv::Mat img;
+    cv::VideoCapture cap;
+    cap.open(0);
+
+    if (!cap.isOpened()) {
+        std::cerr << "ERROR: Camera opening failed!" << std::endl;
+    }
+
+    assertm(cap.isOpened(), "Camera opening failed");
+    cap.read(img);
+
+    if (img.empty()) {
+        std::cerr << "ERROR: Captured image is empty!" << std::endl;
+    }
+
+    assertm(!img.empty(), "Image is empty");
+    return;
+}
+
+void eyeStatusTest() {
+    cv::Mat closed = cv::imread("../../../test/images/eyeClosed.jpg");
+    cv::Mat open = cv::imread("../../../test/images/eyeOpen.jpg");
+
+    if (closed.empty()) {
+        std::cerr << "ERROR: Unable to load eyeClosed.jpg. Check path!" << std::endl;
+    }
+    if (open.empty()) {
+        std::cerr << "ERROR: Unable to load eyeOpen.jpg. Check path!" << std::endl;
+    }
+
+    assertm(!closed.empty(), "Image of a closed eye is empty");
+    assertm(!open.empty(), "Image of an open eye is empty");
+
+    EyeStatus blinkDetector;
+
+    bool statusClosed = blinkDetector.detect(closed);
+    bool statusOpen = blinkDetector.detect(open);
+
+    assertm(!statusClosed, "Closed eye image falsely detected as open eye");
+    assertm(statusOpen, "Open eye image falsely detected as closed eye");
+    return;
+}
+
+void frameProcessorTest() {
+    cv::Mat noface = cv::imread("../../../test/images/noface.jpg");
+    cv::Mat face_closedeyes = cv::imread("../../../test/images/face_closedeyes.jpg");
+    cv::Mat face_openeyes = cv::imread("../../../test/images/face_openeyes.jpg");
+
+    if (noface.empty()) {
+        std::cerr << "ERROR: Unable to load noface.jpg. Check path!" << std::endl;
+    }
+    if (face_closedeyes.empty()) {
+        std::cerr << "ERROR: Unable to load face_closedeyes.jpg. Check path!" << std::endl;
+    }
+    if (face_openeyes.empty()) {
+        std::cerr << "ERROR: Unable to load face_openeyes.jpg. Check path!" << std::endl;
+    }
+
+    FrameProcessor processor;  // Fixed variable name
+
+    int statusNoFace = processor.processFrame(noface);
+    int statusClosedEyes = processor.processFrame(face_closedeyes);
+    int statusOpenEyes = processor.processFrame(face_openeyes);
+
+    assertm(FACE_NOT_FOUND == statusNoFace, "Incorrect detection for picture noface.jpg");
+    assertm(EYES_CLOSED == statusClosedEyes, "Incorrect detection for picture face_closedeyes.jpg");
+    assertm(EYES_OPEN == statusOpenEyes, "Incorrect detection for picture face_openeyes.jpg");
+
+    return;
+}
+
+void blackBoxRecorderTest() {
+    BlackBoxRecorder::Config config;
+    config.path = "test_blackbox.ring";
+    config.seconds = 1;
+    config.fps = 5;
+
+    BlackBoxRecorder recorder;
+    bool opened = recorder.open(config);
+    assertm(opened, "Black-box ring file could not be created");
+
+    // Eight frames into a five slot ring, each frame a different shade of grey
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 8; i++) {
+        cv::Mat frame(480, 640, CV_8UC3, cv::Scalar(i * 10, i * 10, i * 10));
+        recorder.record(frame, start + std::chrono::milliseconds(i * 200));
+    }
+
+    recorder.freeze();
+    cv::Mat ignored(480, 640, CV_8UC3, cv::Scalar(255, 255, 255));
+    recorder.record(ignored, start);
+    assertm(recorder.framesRecorded() == 8, "Black-box recorder recorded a frame while frozen");
+    bool written = recorder.snapshot("test_blackbox_snapshot.ring");
+    assertm(written, "Black-box snapshot could not be written");
+
+    std::vector<cv::Mat> frames;
+    std::vector<int64_t> timestamps;
+    bool read = BlackBoxRecorder::readFrames("test_blackbox_snapshot.ring", frames, timestamps);
+    assertm(read, "Black-box snapshot could not be read");
+    assertm(frames.size() == 5, "Black-box snapshot does not hold the last window");
+    assertm(frames[0].cols == 320 && frames[0].rows == 240, "Black-box frames were not downscaled");
+    assertm(frames.front().at<uchar>(0, 0) == 30 && frames.back().at<uchar>(0, 0) == 70, "Black-box frames are not the newest, in order");
+    assertm(std::is_sorted(timestamps.begin(), timestamps.end()), "Black-box timestamps are not in capture order");
+
+    recorder.close();
+    std::remove("test_blackbox.ring");
+    std::remove("test_blackbox_snapshot.ring");
+    return;
+}
+
+void frameExportTest() {
+    #ifndef _WIN32
+    FrameExporter::Config config;
+    config.name = "/wake-o-matic-test-frames";
+    config.slots = 4;
+    config.maxWidth = 320;
+    config.maxHeight = 240;
+
+    FrameExporter exporter;
+    bool opened = exporter.open(config);
+    assertm(opened, "Shared-memory frame export could not be created");
+
+    // Stand-in reader process: a slow consumer that checks every frame it manages to use is intact
+    pid_t reader = fork();
+    if (0 == reader) {
+        FrameExportReader ring;
+        if (!ring.open(config.name)) _exit(3);
+
+        int used = 0;
+        auto giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (used < 20 && std::chrono::steady_clock::now() < giveUp) {
+            FrameExportReader::Frame frame;
+            if (!ring.next(frame)) {
+                usleep(1000);
+                continue;
+            }
+            int expected = static_cast<int>(frame.number % 251);
+            int first = frame.image.at<cv::Vec3b>(0, 0)[0];
+            int last = frame.image.at<cv::Vec3b>(frame.image.rows - 1, frame.image.cols - 1)[2];
+            if (!ring.stillValid(frame)) continue;  // Lapped while in use, the data can't be trusted
+            if (first != expected || last != expected || frame.image.cols != 320) _exit(2);
+            used++;
+            usleep(20000);  // Much slower than the writer, frames in between are skipped
+        }
+
+        // A frame held for longer than the ring lasts must be reported as overwritten
+        FrameExportReader::Frame held;
+        bool lapDetected = ring.latest(held);
+        usleep(50000);
+        lapDetected = lapDetected && !ring.stillValid(held);
+
+        FrameExportReader::Result result;
+        bool gotResult = ring.result(0, result) && result.number > 0 && result.rawStatus == static_cast<int>(result.number % 2);
+        _exit(used == 20 && ring.framesMissed() > 0 && lapDetected && gotResult ? 0 : 1);
+    }
+    assertm(reader > 0, "Reader process could not be started");
+
+    // The writer never waits for the reader: 400 frames at 500 fps into a four slot ring
+    for (int i = 1; i <= 400; i++) {
+        cv::Mat frame(480, 640, CV_8UC3, cv::Scalar::all(i % 251));
+        auto now = std::chrono::steady_clock::now();
+        uint64_t number = exporter.publish(frame, now);
+
+        EyeSample sample;
+        sample.status = i % 2;
+        sample.timestamp = now;
+        exporter.publishResult(number, sample, TelemetryRecord());
+        usleep(2000);
+    }
+    assertm(exporter.framesPublished() == 400, "Frame export lost frames on the writer side");
+
+    int status = 0;
+    waitpid(reader, &status, 0);
+    assertm(WIFEXITED(status) && 0 == WEXITSTATUS(status), "Reader process did not get intact frames from shared memory");
+    exporter.close();
+    #endif
+    return;
+}
+
+void frameExportDropTest() {
+    #ifndef _WIN32
+    FrameExporter::Config config;
+    config.name = "/wake-o-matic-test-drops";
+    config.slots = 8;
+    config.maxWidth = 64;
+    config.maxHeight = 48;
+    config.results = 8;
+
+    FrameExporter exporter;
+    bool opened = exporter.open(config);
+    assertm(opened, "Shared-memory frame export could not be created");
+
+    // Exporter in front of the processing queue, as in main
+    FrameQueueCallback queue;
+    exporter.chain(&queue);
+    {
+        std::lock_guard<std::mutex> lock(frame_mutex);
+        frame_queue = std::queue<TimedFrame>();
+    }
+
+    // Six frames while the processing thread is busy: the queue only keeps the newest three
+    for (int i = 1; i <= 6; i++) {
+        exporter.nextScene(cv::Mat(48, 64, CV_8UC1, cv::Scalar(i)));
+        usleep(1000);
+    }
+    assertm(queue.dropped() == 3, "Frame queue did not drop the oldest frames");
+
+    // Stand-in for the processing thread, which also drops frame 5 (past its deadline)
+    std::vector<TimedFrame> queued;
+    {
+        std::lock_guard<std::mutex> lock(frame_mutex);
+        while (!frame_queue.empty()) {
+            queued.push_back(frame_queue.front());
+            frame_queue.pop();
+        }
+    }
+    assertm(queued.size() == 3 && queued[0].exportNumber == 4 && queued[2].exportNumber == 6, "Queued frames lost their export numbers");
+    for (const TimedFrame& next : queued) {
+        if (5 == next.exportNumber) continue;
+        EyeSample sample;
+        sample.status = EYES_OPEN;
+        sample.timestamp = next.captured;
+        exporter.publishResult(next.exportNumber, sample, TelemetryRecord());
+    }
+
+    // Every frame a reader gets must match its own result, or have none if it was dropped
+    FrameExportReader ring;
+    bool readerOpened = ring.open(config.name);
+    assertm(readerOpened, "Frame export could not be mapped by a reader");
+    FrameExportReader::Frame frame;
+    int frames = 0;
+    int matched = 0;
+    while (ring.next(frame)) {
+        frames++;
+        FrameExportReader::Result result;
+        bool hasResult = ring.result(frame.number, result);
+        assertm(frame.image.at<uint8_t>(0, 0) == frame.number, "Frame export numbered the frames out of order");
+        assertm(hasResult == (4 == frame.number || 6 == frame.number), "A dropped frame has a result, or a processed one has none");
+        if (hasResult) {
+            assertm(result.number == frame.number && result.timestampNs == frame.timestampNs, "Result does not match the frame it belongs to");
+            matched++;
+        }
+    }
+    FrameExportReader::Result newest;
+    bool hasNewest = ring.result(0, newest);
+    assertm(frames == 6 && matched == 2, "Reader did not see every exported frame");
+    assertm(hasNewest && newest.number == 6, "Newest result is not the one of the newest processed frame");
+    ring.close();
+    exporter.close();
+    #endif
+    return;
+}